@@ -0,0 +1,34 @@
+/**
+ * @file compile_host_table.cpp
+ *
+ * Compile a hosts-style text file into the binary table used by
+ * StaticHostTable (see set_static_host_table and DUNEDAQ_STATIC_HOST_TABLE)
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/StaticHostTable.hpp"
+
+#include <iostream>
+
+int
+main(int argc, char* argv[])
+{
+  if (argc != 3) {
+    std::cout << "Invalid number of arguments:\ncompile_host_table hosts_file table_file\n";
+    exit(1);
+  }
+
+  try {
+    dunedaq::utilities::StaticHostTable::compile(argv[1], argv[2]);
+    dunedaq::utilities::StaticHostTable table(argv[2]);
+    std::cout << "Wrote " << table.size() << " host(s) to " << argv[2] << "\n";
+  } catch (dunedaq::utilities::StaticHostTableError const& e) {
+    std::cout << e.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
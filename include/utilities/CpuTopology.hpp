@@ -0,0 +1,159 @@
+/**
+ *
+ * @file CpuTopology.hpp CPU, cache and NUMA topology read from sysfs, and thread placement helpers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_CPUTOPOLOGY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_CPUTOPOLOGY_HPP_
+
+#include "utilities/Issues.hpp"
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+struct CpuInfo
+{
+  int cpu;
+  int core_id;    ///< Core within the package; hyperthreads share it
+  int package_id; ///< Socket
+  int numa_node;  ///< -1 if unknown
+  int l3_id;      ///< Lowest-numbered CPU sharing this CPU's L3 cache; -1 if unknown
+};
+
+/**
+ * @brief CpuTopology describes the online CPUs of the machine: which
+ * hyperthreads share a core, which cores share an L3 cache and which CPUs
+ * belong to each NUMA node. It also finds the NUMA node and local CPUs of
+ * PCI devices (NICs, FELIX cards).
+ *
+ * Everything is read from sysfs under a configurable root, so that tests
+ * can point it at a fake tree.
+ */
+class CpuTopology
+{
+public:
+  /**
+   * @brief Read the topology from sysfs_root/devices/system/{cpu,node}
+   * @throws CpuTopologyError if the list of CPUs cannot be read
+   */
+  static CpuTopology discover(const std::string& sysfs_root = "/sys");
+
+  /**
+   * @brief The topology of this machine, read once on first use
+   * @throws CpuTopologyError if it cannot be read
+   */
+  static const CpuTopology& system();
+
+  const std::vector<CpuInfo>& get_cpus() const { return m_cpus; }
+
+  // Information about one CPU; nullptr if it is not online
+  const CpuInfo* get_cpu(int cpu) const;
+
+  std::vector<int> get_numa_nodes() const;
+  std::vector<int> get_cpus_in_numa_node(int node) const;
+
+  // Each group lists the CPUs sharing one L3 cache
+  std::vector<std::vector<int>> get_l3_groups() const;
+  std::vector<int> get_cpus_sharing_l3(int cpu) const;
+
+  // Hyperthreads of the core that cpu belongs to, including cpu
+  std::vector<int> get_core_siblings(int cpu) const;
+
+  /**
+   * @brief NUMA node of a PCI device, given as domain:bus:device.function (e.g. 0000:3b:00.0)
+   * @return -1 if the device does not exist or reports no node
+   */
+  int get_pci_numa_node(const std::string& pci_address) const;
+
+  /**
+   * @brief Online CPUs close to a PCI device: its local_cpulist, or else the
+   * CPUs of its NUMA node. Empty if the device is unknown.
+   */
+  std::vector<int> get_pci_local_cpus(const std::string& pci_address) const;
+
+  // Parse a kernel CPU list such as "0-3,8,10-11"
+  static std::vector<int> parse_cpu_list(const std::string& list);
+
+private:
+  std::string m_sysfs_root;
+  std::vector<CpuInfo> m_cpus; // Ordered by CPU number
+  std::map<int, std::vector<int>> m_numa_nodes;
+};
+
+enum class MemoryPolicy
+{
+  kNone,      ///< Leave the memory policy alone
+  kDefault,   ///< Reset to the system default (allocate on the node of the running CPU)
+  kPreferred, ///< Allocate on the given node when possible
+  kBind       ///< Only allocate on the given node
+};
+
+/**
+ * @brief Where a thread should run and where its memory should come from
+ */
+struct ThreadPlacement
+{
+  std::vector<int> cpus; ///< CPUs the thread may run on; empty to leave the affinity alone
+  int memory_node = -1;
+  MemoryPolicy memory_policy = MemoryPolicy::kNone;
+};
+
+// Run on any CPU of the NUMA node, optionally taking memory from it as well
+ThreadPlacement
+placement_for_numa_node(int node,
+                        MemoryPolicy memory_policy = MemoryPolicy::kNone,
+                        const CpuTopology& topology = CpuTopology::system());
+
+// Run on the CPUs close to a PCI device, optionally taking memory from its NUMA node
+ThreadPlacement
+placement_for_pci_device(const std::string& pci_address,
+                         MemoryPolicy memory_policy = MemoryPolicy::kNone,
+                         const CpuTopology& topology = CpuTopology::system());
+
+// Run on the CPUs sharing an L3 cache with cpu
+ThreadPlacement
+placement_for_l3_group(int cpu, const CpuTopology& topology = CpuTopology::system());
+
+/**
+ * @brief Restrict a thread to a set of CPUs
+ * @return Whether the affinity was set; failures are reported as ThreadingIssue warnings
+ */
+bool
+set_thread_affinity(pthread_t handle, const std::vector<int>& cpus);
+
+/**
+ * @brief Set the memory policy of the calling thread (set_mempolicy(2))
+ * @return Whether the policy was set; failures are reported as ThreadingIssue warnings
+ */
+bool
+set_memory_policy(MemoryPolicy policy, int node);
+
+/**
+ * @brief Set the memory policy of an address range (mbind(2)), e.g. for a buffer
+ * allocated before the thread using it was placed
+ * @return Whether the policy was set; failures are reported as ThreadingIssue warnings
+ */
+bool
+bind_memory(void* address, size_t length, MemoryPolicy policy, int node);
+
+/**
+ * @brief Apply a placement to the calling thread
+ */
+bool
+apply_placement_to_current_thread(const ThreadPlacement& placement);
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_CPUTOPOLOGY_HPP_
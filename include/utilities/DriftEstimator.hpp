@@ -0,0 +1,89 @@
+/**
+ * @file DriftEstimator.hpp Fit of DAQ time against system time over recent TimeSyncs
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_DRIFTESTIMATOR_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_DRIFTESTIMATOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief DriftEstimator fits the effective frequency and offset of the DAQ clock
+ *
+ * It keeps the last window (daq_time, system_time) pairs and fits daq_time
+ * against system_time by least squares, so that extrapolating between
+ * TimeSyncs follows the real oscillator rather than the nominal frequency.
+ * With a window of one it extrapolates from the latest pair at the nominal
+ * frequency. The fitted frequency is kept within s_max_drift of the nominal
+ * one, and a pair further than s_max_residual_seconds from the fit (e.g. after
+ * the timing system was re-synchronised) restarts the window.
+ *
+ * It reads no clocks, so it can be driven with synthetic streams.
+ */
+class DriftEstimator
+{
+public:
+  static constexpr double s_max_drift = 1e-3;
+  static constexpr double s_max_residual_seconds = 0.01;
+
+  DriftEstimator(uint64_t nominal_frequency_hz, size_t window); // NOLINT(build/unsigned)
+
+  /**
+   * @brief Add a pair; system_time_us is in microseconds
+   * @return false if it was ignored for not being newer than the latest pair
+   */
+  bool add(uint64_t daq_time, uint64_t system_time_us); // NOLINT(build/unsigned)
+
+  // Forget all pairs; the window size may change
+  void reset(size_t window);
+
+  // DAQ time at the given system time; only valid once a pair has been added
+  uint64_t predict(uint64_t system_time_us) const; // NOLINT(build/unsigned)
+
+  // The fitted frequency, or the nominal one before there are two pairs
+  double get_frequency_hz() const { return m_ticks_per_us * 1e6; }
+
+  // RMS distance in ticks of the pairs from the fit; 0 with fewer than three pairs
+  double get_residual_rms_ticks() const { return m_residual_rms_ticks; }
+
+  // Mean spacing in microseconds of the pairs in the window; 0 before there are two
+  double get_interval_us() const { return m_interval_us; }
+
+  size_t size() const { return m_count; }
+  size_t get_window() const { return m_samples.size(); }
+
+private:
+  struct Sample
+  {
+    uint64_t daq_time;       // NOLINT(build/unsigned)
+    uint64_t system_time_us; // NOLINT(build/unsigned)
+  };
+
+  void fit();
+
+  double m_nominal_ticks_per_us;
+  std::vector<Sample> m_samples;
+  size_t m_next{ 0 };
+  size_t m_count{ 0 };
+
+  // The fit is DAQ time = m_reference.daq_time + m_offset + m_ticks_per_us * (system time - m_reference.system_time_us)
+  Sample m_reference{ 0, 0 }; // The latest pair
+  double m_offset{ 0. };
+  double m_ticks_per_us;
+  double m_residual_rms_ticks{ 0. };
+  double m_interval_us{ 0. };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_DRIFTESTIMATOR_HPP_
@@ -0,0 +1,177 @@
+/**
+ * @file IdleStrategy.hpp How a polling work loop waits when it finds nothing to do
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_IDLESTRATEGY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_IDLESTRATEGY_HPP_
+
+#include "utilities/StopToken.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief The ways an IdleStrategy can wait, from lowest wake latency to lowest CPU use
+ */
+enum class IdleMode
+{
+  kSpin,    ///< Poll continuously, with a CPU pause between polls
+  kBackoff, ///< Pause 1, 2, 4... times between polls, then sleep 1, 2, 4... us up to the sleep option
+  kLadder,  ///< Pause between polls, then yield between polls, then sleep between polls
+  kPark     ///< Pause between polls, then sleep in the kernel until wake() is called
+};
+
+/**
+ * @brief The phases of a wait, which IdleStats accounts for separately
+ */
+enum class IdlePhase
+{
+  kSpin,
+  kYield,
+  kSleep,
+  kPark
+};
+
+std::string
+to_string(IdleMode mode);
+
+std::string
+to_string(IdlePhase phase);
+
+struct IdleOptions
+{
+  IdleMode mode = IdleMode::kLadder;
+  uint32_t spin_polls = 64;   // NOLINT(build/unsigned), kLadder and kPark: polls with a pause before the next phase
+  uint32_t yield_polls = 960; // NOLINT(build/unsigned), kLadder: polls with a yield before sleeping
+  uint32_t max_pauses = 1024; // NOLINT(build/unsigned), kBackoff: most pauses between two polls before sleeping
+
+  // kLadder: the sleep between polls; kBackoff: the longest sleep between polls
+  std::chrono::nanoseconds sleep{ std::chrono::microseconds(100) };
+};
+
+/**
+ * @brief Time an IdleStrategy spent in each phase, written by its thread only
+ */
+class IdleStats
+{
+public:
+  static constexpr size_t s_phases = 4;
+
+  void record_wait() { bump(m_waits, 1); }
+  void record_phase(IdlePhase phase, int64_t ns)
+  {
+    auto index = static_cast<size_t>(phase);
+    bump(m_entries[index], 1);
+    m_time_ns[index].store(m_time_ns[index].load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+  }
+
+  // Waits which did not find the loop ready straight away
+  uint64_t get_waits() const { return m_waits.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+
+  // How many waits reached the phase, and the total time they spent in it
+  uint64_t get_entries(IdlePhase phase) const // NOLINT(build/unsigned)
+  {
+    return m_entries[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+  }
+  int64_t get_time_ns(IdlePhase phase) const
+  {
+    return m_time_ns[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+  }
+
+  // The wait count, and the entries and time of each phase keyed by phase name
+  nlohmann::json to_json() const;
+
+private:
+  static void bump(std::atomic<uint64_t>& counter, uint64_t amount) // NOLINT(build/unsigned)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> m_waits{ 0 };                      // NOLINT(build/unsigned)
+  std::array<std::atomic<uint64_t>, s_phases> m_entries{}; // NOLINT(build/unsigned)
+  std::array<std::atomic<int64_t>, s_phases> m_time_ns{};
+};
+
+/**
+ * @brief IdleStrategy waits until a polled condition holds, a stop is requested or, when parked, wake() is called
+ *
+ * It replaces the hand-written busy spin, yield or sleep_for(1ms) of a
+ * polling work loop:
+ *
+ * @code
+ * IdleStrategy idle(options);
+ * void do_work(const StopToken& stop){
+ *   while(!stop.stop_requested()){
+ *     if(!queue.try_pop(item)){
+ *       idle.wait(stop, [&]() { return !queue.empty(); });
+ *       continue;
+ *     }
+ *     // handle item ...
+ *   }
+ * }
+ * // in the producer, after queue.push(item):
+ * idle.wake();
+ * @endcode
+ *
+ * The condition is a template parameter, so polling it is inlined. Only one
+ * thread may wait on a strategy; wake() may be called from any thread, and is
+ * a fence and a load unless the waiter is parked. Producers only need to call
+ * wake() for IdleMode::kPark, which otherwise sleeps until the stop.
+ */
+class IdleStrategy
+{
+public:
+  explicit IdleStrategy(const IdleOptions& options = IdleOptions())
+    : m_options(options)
+  {}
+
+  IdleStrategy(const IdleStrategy&) = delete;            ///< IdleStrategy is not copy-constructible
+  IdleStrategy& operator=(const IdleStrategy&) = delete; ///< IdleStrategy is not copy-assignable
+  IdleStrategy(IdleStrategy&&) = delete;                 ///< IdleStrategy is not move-constructible
+  IdleStrategy& operator=(IdleStrategy&&) = delete;      ///< IdleStrategy is not move-assignable
+
+  /**
+   * @brief Idle until ready() holds or a stop is requested
+   * @return ready() at the time of return
+   */
+  template<typename Ready>
+  bool wait(const StopToken& stop, Ready ready);
+
+  // Wake the waiter if it is parked. Call after making ready() hold.
+  void wake()
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_parked.load(std::memory_order_relaxed)) {
+      unpark();
+    }
+  }
+
+  const IdleOptions& get_options() const { return m_options; }
+  const IdleStats& get_stats() const { return m_stats; }
+
+private:
+  void unpark();
+
+  IdleOptions m_options;
+  IdleStats m_stats;
+  std::atomic<bool> m_parked{ false };
+  std::atomic<uint32_t> m_wake_counter{ 0 }; // NOLINT(build/unsigned), futex word
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/IdleStrategy.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_IDLESTRATEGY_HPP_
@@ -0,0 +1,150 @@
+/**
+ * @file InlineFunction.hpp Move-only callable with fixed inline storage
+ * A replacement for std::function on hot paths: the callable is always stored
+ * inside the object, so constructing and assigning never touch the heap.
+ * Callables which do not fit are rejected at compile time.
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_INLINEFUNCTION_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_INLINEFUNCTION_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename Signature, size_t Capacity = 128>
+class InlineFunction;
+
+template<typename R, typename... Args, size_t Capacity>
+class InlineFunction<R(Args...), Capacity>
+{
+public:
+  static constexpr size_t s_capacity = Capacity;
+
+  InlineFunction() noexcept = default;
+  InlineFunction(std::nullptr_t) noexcept {} // NOLINT(runtime/explicit)
+
+  template<typename F,
+           typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction> &&
+                                       std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+  InlineFunction(F&& f) // NOLINT(runtime/explicit)
+  {
+    emplace(std::forward<F>(f));
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept { move_from(other); }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept
+  {
+    if (this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+
+  InlineFunction& operator=(std::nullptr_t) noexcept
+  {
+    reset();
+    return *this;
+  }
+
+  template<typename F,
+           typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction> &&
+                                       std::is_invocable_r_v<R, std::decay_t<F>&, Args...>>>
+  InlineFunction& operator=(F&& f)
+  {
+    reset();
+    emplace(std::forward<F>(f));
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;            ///< InlineFunction is not copy-constructible
+  InlineFunction& operator=(const InlineFunction&) = delete; ///< InlineFunction is not copy-assignable
+
+  ~InlineFunction() { reset(); }
+
+  explicit operator bool() const noexcept { return m_ops != nullptr; }
+
+  R operator()(Args... args)
+  {
+    if (m_ops == nullptr) {
+      throw std::bad_function_call();
+    }
+    return m_ops->invoke(&m_storage, std::forward<Args>(args)...);
+  }
+
+  void reset() noexcept
+  {
+    if (m_ops != nullptr) {
+      m_ops->destroy(&m_storage);
+      m_ops = nullptr;
+    }
+  }
+
+private:
+  struct Operations
+  {
+    R (*invoke)(void*, Args&&...);
+    void (*move)(void* from, void* to) noexcept;
+    void (*destroy)(void*) noexcept;
+  };
+
+  template<typename F>
+  static const Operations* operations_for()
+  {
+    static constexpr Operations s_operations{
+      [](void* storage, Args&&... args) -> R {
+        return std::invoke(*static_cast<F*>(storage), std::forward<Args>(args)...);
+      },
+      [](void* from, void* to) noexcept {
+        new (to) F(std::move(*static_cast<F*>(from)));
+        static_cast<F*>(from)->~F();
+      },
+      [](void* storage) noexcept { static_cast<F*>(storage)->~F(); }
+    };
+    return &s_operations;
+  }
+
+  template<typename F>
+  void emplace(F&& f)
+  {
+    using Stored = std::decay_t<F>;
+    static_assert(sizeof(Stored) <= Capacity, "Callable is too large for this InlineFunction, increase its Capacity");
+    static_assert(alignof(Stored) <= alignof(std::max_align_t), "Callable is over-aligned for InlineFunction");
+    static_assert(std::is_nothrow_move_constructible_v<Stored>, "InlineFunction requires nothrow-movable callables");
+
+    if constexpr (std::is_pointer_v<Stored> || std::is_member_pointer_v<Stored>) {
+      if (f == nullptr) {
+        return;
+      }
+    }
+    new (&m_storage) Stored(std::forward<F>(f));
+    m_ops = operations_for<Stored>();
+  }
+
+  void move_from(InlineFunction& other) noexcept
+  {
+    if (other.m_ops != nullptr) {
+      other.m_ops->move(&other.m_storage, &m_storage);
+      m_ops = other.m_ops;
+      other.m_ops = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char m_storage[Capacity];
+  const Operations* m_ops = nullptr;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_INLINEFUNCTION_HPP_
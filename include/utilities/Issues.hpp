@@ -30,6 +30,26 @@ ERS_DECLARE_ISSUE(utilities,
                   "The hostname " << name << " could not be resolved: " << error,
                   ((std::string)name)((std::string)error))
 ERS_DECLARE_ISSUE(utilities, InvalidUri, "The URI string " << uri << " is not valid", ((std::string)uri))
+ERS_DECLARE_ISSUE(utilities,
+                  EndpointRefreshFailed,
+                  "Could not refresh endpoint " << uri << ", keeping the last known addresses: " << error,
+                  ((std::string)uri)((std::string)error))
+ERS_DECLARE_ISSUE(utilities,
+                  EndpointCallbackFailed,
+                  "A subscriber callback for endpoint " << uri << " threw: " << error,
+                  ((std::string)uri)((std::string)error))
+ERS_DECLARE_ISSUE(utilities,
+                  StaticHostTableError,
+                  "Static host table " << path << " could not be used: " << reason,
+                  ((std::string)path)((std::string)reason))
+ERS_DECLARE_ISSUE(utilities,
+                  CpuTopologyError,
+                  "CPU topology could not be read from " << path << ": " << reason,
+                  ((std::string)path)((std::string)reason))
+ERS_DECLARE_ISSUE(utilities,
+                  WorkerStalled,
+                  "Worker " << name << " has not made progress for " << stalled_ms << " ms" << stack_trace,
+                  ((std::string)name)((int64_t)stalled_ms)((std::string)stack_trace))
 // Reenable coverage collection LCOV_EXCL_STOP
 
 ERS_DECLARE_ISSUE(utilities, InvalidTimeSync, "An invalid TimeSync message was received", ERS_EMPTY)
@@ -0,0 +1,117 @@
+/**
+ * @file MpscRing.hpp Bounded lock-free multi-producer, single-consumer ring buffer
+ * Based on Dmitry Vyukov's bounded MPMC queue: every cell carries a sequence
+ * number which tells producers and the consumer whether it is free or full,
+ * so producers only contend on the tail index and never on each other's cells.
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_MPSCRING_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_MPSCRING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+class MpscRing
+{
+public:
+  // The capacity is rounded up to a power of two, and to at least two: with a
+  // single cell the sequence numbers of "full" and "free again" would coincide
+  explicit MpscRing(size_t capacity)
+  {
+    m_capacity = 2;
+    while (m_capacity < capacity) {
+      m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_cells.reset(new Cell[m_capacity]);
+    for (size_t ii = 0; ii < m_capacity; ++ii) {
+      m_cells[ii].sequence.store(ii, std::memory_order_relaxed);
+    }
+  }
+
+  MpscRing(const MpscRing&) = delete;            ///< MpscRing is not copy-constructible
+  MpscRing& operator=(const MpscRing&) = delete; ///< MpscRing is not copy-assignable
+  MpscRing(MpscRing&&) = delete;                 ///< MpscRing is not move-constructible
+  MpscRing& operator=(MpscRing&&) = delete;      ///< MpscRing is not move-assignable
+
+  size_t capacity() const { return m_capacity; }
+
+  // Any thread. Returns false if the ring is full.
+  bool try_push(T&& value)
+  {
+    return try_push_with([&value]() -> T&& { return std::move(value); });
+  }
+
+  // Any thread. make() is only called once a cell has been claimed, so nothing
+  // is constructed (or moved from) when the ring is full.
+  template<typename Make>
+  bool try_push_with(Make&& make)
+  {
+    auto position = m_tail.load(std::memory_order_relaxed);
+    while (true) {
+      auto& cell = m_cells[position & m_mask];
+      auto sequence = cell.sequence.load(std::memory_order_acquire);
+      auto difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+      if (difference == 0) {
+        if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          cell.value = make();
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        position = m_tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Consumer thread only. Returns false if the ring is empty.
+  bool try_pop(T& value) { return try_pop_batch(&value, 1) == 1; }
+
+  // Consumer thread only. Moves up to max_count values into out, returns how many.
+  size_t try_pop_batch(T* out, size_t max_count)
+  {
+    size_t count = 0;
+    while (count < max_count) {
+      auto& cell = m_cells[m_head & m_mask];
+      if (cell.sequence.load(std::memory_order_acquire) != m_head + 1) {
+        break;
+      }
+      out[count++] = std::move(cell.value);
+      cell.sequence.store(m_head + m_capacity, std::memory_order_release);
+      ++m_head;
+    }
+    return count;
+  }
+
+  // Consumer thread only
+  bool empty() const { return m_cells[m_head & m_mask].sequence.load(std::memory_order_acquire) != m_head + 1; }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  size_t m_capacity;
+  size_t m_mask;
+  alignas(64) std::atomic<size_t> m_tail{ 0 };
+  alignas(64) size_t m_head{ 0 };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_MPSCRING_HPP_
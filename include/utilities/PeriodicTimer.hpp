@@ -0,0 +1,136 @@
+/**
+ * @file PeriodicTimer.hpp Fixed-rate ticks on absolute deadlines for WorkerThread loops
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_PERIODICTIMER_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_PERIODICTIMER_HPP_
+
+#include "utilities/StopToken.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief What to do with ticks whose deadline passed while the previous one was running
+ */
+enum class MissedTickPolicy
+{
+  kSkip,     ///< Drop them and wait for the next deadline in the future
+  kCatchUp,  ///< Run each of them, back to back, until back on schedule
+  kCoalesce  ///< Run one tick straight away in place of all of them, then continue on schedule
+};
+
+struct PeriodicOptions
+{
+  std::chrono::nanoseconds period{ std::chrono::milliseconds(1) };
+
+  /**
+   * Sleep until this long before each deadline, then spin until it. Trades a
+   * core for wake-up jitter of well under 50 us; zero to only sleep.
+   */
+  std::chrono::nanoseconds spin_window{ 0 };
+
+  MissedTickPolicy missed_tick_policy = MissedTickPolicy::kSkip;
+
+  // Deadline of the first tick; left at the epoch for one period after the start
+  std::chrono::steady_clock::time_point first_deadline{};
+
+  // Set the thread's timer slack to 1 ns, instead of the default 50 us
+  bool minimize_timer_slack = true;
+};
+
+/**
+ * @brief One tick of a PeriodicTimer
+ */
+struct PeriodicTick
+{
+  uint64_t index{ 0 };                            // NOLINT(build/unsigned), deadline number since the first
+  std::chrono::steady_clock::time_point deadline; ///< When the tick was due
+  uint64_t missed{ 0 };                           // NOLINT(build/unsigned), ticks skipped or coalesced into this one
+};
+
+/**
+ * @brief Statistics of a PeriodicTimer, written by its thread only
+ */
+class PeriodicStats
+{
+public:
+  void record_tick(int64_t lateness_ns)
+  {
+    bump(m_ticks, 1);
+    m_lateness.record(lateness_ns);
+  }
+  void record_missed(uint64_t count) { bump(m_missed, count); } // NOLINT(build/unsigned)
+
+  uint64_t get_ticks() const { return m_ticks.load(std::memory_order_relaxed); }   // NOLINT(build/unsigned)
+  uint64_t get_missed() const { return m_missed.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+
+  // Tick and missed counts, and the histogram of how late each tick started
+  nlohmann::json to_json() const;
+
+private:
+  static void bump(std::atomic<uint64_t>& counter, uint64_t amount) // NOLINT(build/unsigned)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> m_ticks{ 0 };  // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_missed{ 0 }; // NOLINT(build/unsigned)
+  DurationHistogram m_lateness;
+};
+
+/**
+ * @brief PeriodicTimer wakes a work loop on a fixed grid of absolute deadlines
+ *
+ * Deadlines are first_deadline + n * period, so neither the work nor sleep
+ * overshoot make the loop drift. The sleep is an absolute CLOCK_MONOTONIC
+ * futex wait on the StopToken, which like clock_nanosleep(TIMER_ABSTIME) is
+ * driven by a high-resolution timer, but also ends as soon as a stop is
+ * requested.
+ *
+ * @code
+ * void do_work(const StopToken& stop){
+ *   PeriodicTimer timer(options);
+ *   PeriodicTick tick;
+ *   while(timer.wait_next(stop, tick)){
+ *    // do something ...
+ *   }
+ * }
+ * @endcode
+ *
+ * Construct the timer in the thread which waits on it.
+ */
+class PeriodicTimer
+{
+public:
+  explicit PeriodicTimer(const PeriodicOptions& options, PeriodicStats* stats = nullptr);
+
+  /**
+   * @brief Wait for the next tick, applying the missed-tick policy first
+   * @return false if a stop was requested instead
+   */
+  bool wait_next(const StopToken& stop, PeriodicTick& tick);
+
+  std::chrono::steady_clock::time_point get_next_deadline() const { return m_next_deadline; }
+
+private:
+  PeriodicOptions m_options;
+  PeriodicStats* m_stats;
+  std::chrono::steady_clock::time_point m_next_deadline;
+  uint64_t m_next_index{ 0 }; // NOLINT(build/unsigned)
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_PERIODICTIMER_HPP_
@@ -0,0 +1,222 @@
+/**
+ * @file Pipeline.hpp Chain of WorkerThread stages connected by bounded rings
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_PIPELINE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_PIPELINE_HPP_
+
+#include "utilities/IdleStrategy.hpp"
+#include "utilities/SpscRing.hpp"
+#include "utilities/ThreadAttributes.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief What the producer does when a stage's input ring is full
+ */
+enum class BackPressure
+{
+  kBlock,      ///< Wait for the stage to make room
+  kDropOldest, ///< Discard the oldest queued item to make room
+  kDropNewest  ///< Discard the item being pushed
+};
+
+/**
+ * @brief What happens to queued items when a Pipeline is stopped
+ */
+enum class StopMode
+{
+  kDrain,  ///< Every queued item goes through the remaining stages, in order
+  kAbandon ///< Stages stop after their current batch; queued items are discarded in order
+};
+
+struct StageConfig
+{
+  size_t capacity = 1024;                         ///< Size of the stage's input ring, rounded up to a power of two
+  size_t batch_size = 64;                         ///< Most items taken from the input ring at once
+  BackPressure back_pressure = BackPressure::kBlock;
+  ThreadAttributes attributes;                    ///< For the stage's WorkerThread
+  std::chrono::milliseconds stall_threshold{ 0 }; ///< See WorkerThread::set_stall_threshold
+  IdleOptions idle{};                             ///< How the stage waits for input; kPark is woken by the feeder
+};
+
+/**
+ * @brief Counters of one pipeline stage
+ *
+ * Each counter has a single writer at a time (the stage, or whoever pushes
+ * into it), so they are updated without locked instructions.
+ */
+class StageStats
+{
+public:
+  void record_batch(uint64_t items_in, uint64_t items_out) // NOLINT(build/unsigned)
+  {
+    bump(m_batches, 1);
+    bump(m_items_in, items_in);
+    bump(m_items_out, items_out);
+  }
+  void record_dropped(uint64_t count) { bump(m_dropped, count); }     // NOLINT(build/unsigned)
+  void record_abandoned(uint64_t count) { bump(m_abandoned, count); } // NOLINT(build/unsigned)
+  void record_blocked(int64_t ns)
+  {
+    m_blocked_ns.store(m_blocked_ns.load(std::memory_order_relaxed) + ns, std::memory_order_relaxed);
+  }
+  void record_occupancy(uint64_t occupancy) // NOLINT(build/unsigned)
+  {
+    if (occupancy > m_peak_occupancy.load(std::memory_order_relaxed)) {
+      m_peak_occupancy.store(occupancy, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t get_items_in() const { return m_items_in.load(std::memory_order_relaxed); }   // NOLINT(build/unsigned)
+  uint64_t get_items_out() const { return m_items_out.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+  uint64_t get_dropped() const { return m_dropped.load(std::memory_order_relaxed); }     // NOLINT(build/unsigned)
+  uint64_t get_abandoned() const { return m_abandoned.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+  uint64_t get_peak_occupancy() const { return m_peak_occupancy.load(std::memory_order_relaxed); } // NOLINT
+
+  // elapsed is the time the stage has been running, for the rates
+  nlohmann::json to_json(std::chrono::nanoseconds elapsed) const;
+
+private:
+  static void bump(std::atomic<uint64_t>& counter, uint64_t amount) // NOLINT(build/unsigned)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  std::atomic<uint64_t> m_batches{ 0 };        // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_items_in{ 0 };       // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_items_out{ 0 };      // NOLINT(build/unsigned), passed on (or kept, for the last stage)
+  std::atomic<uint64_t> m_dropped{ 0 };        // NOLINT(build/unsigned), by back-pressure at the input
+  std::atomic<uint64_t> m_abandoned{ 0 };      // NOLINT(build/unsigned), at the input by an abandoning stop
+  std::atomic<uint64_t> m_peak_occupancy{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<int64_t> m_blocked_ns{ 0 };      // Time the producer waited for room at the input
+};
+
+/**
+ * @brief Pipeline runs items of type T through a chain of stages
+ *
+ * Each stage runs in its own WorkerThread, named after the stage, and reads
+ * its input from a bounded SpscRing filled by the previous stage (or, for the
+ * first stage, by push()). A stage function takes an item by reference, may
+ * modify it, and returns whether it should be passed on; the last stage is the
+ * sink. T must be default-constructible and movable.
+ *
+ * @code
+ * Pipeline<Record> pipeline("readout");
+ * pipeline.add_stage("unpack", [](Record& r) { unpack(r); return true; });
+ * pipeline.add_stage("store", [](Record& r) { store(r); return true; }, { 4096, 64, BackPressure::kDropOldest });
+ * pipeline.start();
+ * pipeline.push(std::move(record)); // from a single producer thread
+ * pipeline.stop(StopMode::kDrain);
+ * @endcode
+ */
+template<typename T>
+class Pipeline
+{
+public:
+  using StageFunction = std::function<bool(T&)>;
+
+  explicit Pipeline(const std::string& name);
+
+  // A running pipeline is stopped with StopMode::kAbandon
+  ~Pipeline();
+
+  Pipeline(const Pipeline&) = delete;            ///< Pipeline is not copy-constructible
+  Pipeline& operator=(const Pipeline&) = delete; ///< Pipeline is not copy-assignable
+  Pipeline(Pipeline&&) = delete;                 ///< Pipeline is not move-constructible
+  Pipeline& operator=(Pipeline&&) = delete;      ///< Pipeline is not move-assignable
+
+  /**
+   * @brief Append a stage
+   * @throws ThreadingIssue if the pipeline is running
+   */
+  void add_stage(const std::string& name, StageFunction function, const StageConfig& config = StageConfig());
+
+  /**
+   * @brief Start the stages, last first
+   * @throws ThreadingIssue if the pipeline is running or has no stages
+   */
+  void start();
+
+  /**
+   * @brief Stop the stages, first first, so that each stage stops after the one feeding it
+   *
+   * Must not be called while push() is in progress.
+   * @throws ThreadingIssue if the pipeline is not running
+   */
+  void stop(StopMode mode = StopMode::kDrain);
+
+  bool is_running() const { return m_running; }
+
+  /**
+   * @brief Hand an item to the first stage, applying its back-pressure policy
+   *
+   * Only one thread may push.
+   * @return Whether the item entered the pipeline
+   */
+  bool push(T&& item) { return push_batch(&item, 1) == 1; }
+
+  /**
+   * @brief Hand count items to the first stage, moving from items
+   * @return How many entered the pipeline
+   */
+  size_t push_batch(T* items, size_t count);
+
+  size_t get_stage_count() const { return m_stages.size(); }
+  const StageStats& get_stage_stats(size_t stage) const { return m_stages.at(stage)->stats; }
+  const IdleStats& get_stage_idle_stats(size_t stage) const { return m_stages.at(stage)->idle.get_stats(); }
+
+  // Current number of items in the stage's input ring
+  size_t get_stage_occupancy(size_t stage) const { return m_stages.at(stage)->input.size(); }
+
+  // Counters, occupancy, rates and idle time of every stage, in order
+  nlohmann::json get_stats() const;
+
+private:
+  struct Stage
+  {
+    Stage(const std::string& stage_name, StageFunction stage_function, const StageConfig& stage_config);
+
+    // Called by whoever feeds this stage; returns how many items entered the ring
+    size_t accept(T* items, size_t count);
+    void do_work(const StopToken& stop);
+
+    std::string name;
+    StageFunction function;
+    StageConfig config;
+    SpscRing<T> input;
+    Stage* next{ nullptr };
+    std::atomic<bool> abandon{ false };
+    StageStats stats;
+    IdleStrategy idle;
+    WorkerThread thread;
+  };
+
+  std::string m_name;
+  std::vector<std::unique_ptr<Stage>> m_stages;
+  bool m_running{ false };
+  std::chrono::steady_clock::time_point m_start_time;
+  std::chrono::steady_clock::time_point m_stop_time;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#include "detail/Pipeline.hxx"
+
+#endif // UTILITIES_INCLUDE_UTILITIES_PIPELINE_HPP_
@@ -20,32 +20,194 @@
 #include <sys/types.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace dunedaq {
 
 namespace utilities {
 
+/**
+ * @brief Result of a single, uncached hostname lookup
+ */
+struct HostLookupResult
+{
+  std::vector<std::string> addresses; ///< Numeric IPv4 addresses, duplicates removed
+  int error{ 0 };                     ///< getaddrinfo error code, 0 on success
+  std::string error_string{ "" };     ///< Human-readable form of error
+  uint32_t ttl_seconds{ 0 };          ///< Smallest TTL of the DNS answer, if ttl_known
+  bool ttl_known{ false };            ///< Whether ttl_seconds came from a DNS answer
+};
+
+/**
+ * @brief Resolve a hostname with getaddrinfo, bypassing the ResolverCache
+ * @param hostname Name (or numeric address) to resolve
+ * @param query_ttl Whether to also query DNS for the record TTL
+ *
+ * Does not report errors; callers decide how to surface result.error
+ */
+HostLookupResult
+lookup_hostname(const std::string& hostname, bool query_ttl = false);
+
+/**
+ * @brief Get the IPv4 addresses for a hostname
+ *
+ * Lookups go through the process-wide ResolverCache (see ResolverCache.hpp).
+ * A NameNotFound error is reported if the name cannot be resolved.
+ */
 std::vector<std::string>
 get_ips_from_hostname(std::string hostname);
 
 std::vector<std::string>
 resolve_uri_hostname(std::string connection_string);
 
+/**
+ * @brief Outcome of resolving one entry of a batch
+ */
+struct UriResolution
+{
+  std::vector<std::string> uris; ///< Resolved connection strings, as resolve_uri_hostname would return
+  std::string error{ "" };       ///< Description of the failure, empty on success
+  bool ok() const { return error.empty(); }
+};
+
+/**
+ * @brief Resolve many connection strings at once
+ * @param connection_strings Connection strings to resolve, duplicates allowed
+ * @param max_concurrency Upper bound on the number of concurrent hostname lookups
+ * @return One UriResolution per input, in input order
+ *
+ * Each distinct hostname is looked up once, and distinct hostnames are looked
+ * up in parallel, so the cost scales with the number of unique hosts rather
+ * than the number of endpoints. Failures are returned in the corresponding
+ * UriResolution instead of being thrown or reported through ERS.
+ */
+std::vector<UriResolution>
+resolve_uri_hostnames(const std::vector<std::string>& connection_strings, size_t max_concurrency = 16);
+
 struct ZmqUri {
   std::string scheme{""};
   std::string host{""};
   std::string port{""};
-  std::string to_string()
+  std::string to_string() const
   {
-    auto tmp = scheme + "://" + host;
+    // IPv6 literals need brackets to keep the port separator unambiguous
+    bool bracket = host.find(':') != std::string::npos && scheme != "ipc" && scheme != "inproc";
+    std::string output;
+    output.reserve(scheme.size() + host.size() + port.size() + 6);
+    output.append(scheme).append("://");
+    if (bracket)
+      output.append("[").append(host).append("]");
+    else
+      output.append(host);
     if (port != "")
-      return tmp + ":" + port;
-  return tmp;
+      output.append(":").append(port);
+    return output;
   }
 };
+
+/**
+ * @brief Non-owning view of the parts of a connection string
+ *
+ * The views point into the buffer given to try_parse_connection_string,
+ * which must outlive this object.
+ */
+struct ZmqUriView
+{
+  std::string_view scheme;
+  std::string_view host; ///< Without brackets, for IPv6 literals
+  std::string_view port;
+
+  ZmqUri to_uri() const { return ZmqUri{ std::string(scheme), std::string(host), std::string(port) }; }
+};
+
+/**
+ * @brief Split a connection string into scheme, host and port without allocating
+ * @return false if connection_string is not a valid URI
+ *
+ * Accepts {scheme}://{host}[:{port}], where host may be a bracketed IPv6 literal
+ * (tcp://[::1]:5555) or the * wildcard. For ipc:// and inproc:// everything after
+ * the scheme is the host (an endpoint name or path), and port is empty.
+ */
+bool
+try_parse_connection_string(std::string_view connection_string, ZmqUriView& output) noexcept;
+
+/**
+ * @brief Parse a connection string into an owning ZmqUri
+ * @throws InvalidUri if connection_string is not a valid URI
+ */
 ZmqUri
-parse_connection_string(std::string connection_string);
+parse_connection_string(const std::string& connection_string);
+
+/**
+ * @brief Use the given nameservers ("address" or "address:port", IPv4) for
+ * direct DNS queries (SRV lookups and record TTLs) instead of those in
+ * /etc/resolv.conf. An empty list restores the system configuration.
+ * @throws InvalidUri if an entry is not a numeric IPv4 address
+ */
+void
+set_nameservers(const std::vector<std::string>& servers);
+
+/**
+ * @brief One SRV record, as defined in RFC 2782
+ */
+struct ServiceRecord
+{
+  std::string host{ "" };
+  uint16_t port{ 0 };     // NOLINT(build/unsigned)
+  uint16_t priority{ 0 }; // NOLINT(build/unsigned)
+  uint16_t weight{ 0 };   // NOLINT(build/unsigned)
+  uint32_t ttl{ 0 };      // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief Result of a single, uncached SRV lookup
+ */
+struct ServiceLookupResult
+{
+  std::vector<ServiceRecord> records; ///< Sorted by priority
+  int error{ 0 };                     ///< h_errno-style error code, 0 on success
+  std::string error_string{ "" };     ///< Human-readable form of error
+  uint32_t ttl_seconds{ 0 };          ///< Smallest TTL of the records, if ttl_known
+  bool ttl_known{ false };
+};
+
+/**
+ * @brief Query DNS for the SRV records of service (e.g. "_daq._tcp.example.org"),
+ * bypassing the ResolverCache. Does not report errors.
+ */
+ServiceLookupResult
+lookup_service(const std::string& service);
+
+/**
+ * @brief Extract the SRV records from a raw DNS answer, sorted by priority
+ * @param min_ttl Set to the smallest TTL of the returned records
+ */
+std::vector<ServiceRecord>
+parse_service_records(const unsigned char* answer, int answer_length, uint32_t& min_ttl);
+
+/**
+ * @brief Order records for connection attempts as described in RFC 2782:
+ * ascending priority, then a weighted random order within each priority
+ */
+void
+order_service_records(std::vector<ServiceRecord>& records);
+
+/**
+ * @brief Get the SRV records of service, in RFC 2782 connection order
+ *
+ * Lookups go through the ResolverCache. A ServiceNotFound error is reported
+ * if the service has no records.
+ */
+std::vector<ServiceRecord>
+get_service_records(const std::string& service);
+
+/**
+ * @brief Expand the SRV records of service into URIs, e.g. tcp://{target}:{port},
+ * in RFC 2782 connection order. The URIs can be passed to resolve_uri_hostname.
+ */
+std::vector<ZmqUri>
+get_service_uris(const std::string& service, const std::string& scheme = "tcp");
 
 } // namespace utilities
 } // namespace dunedaq
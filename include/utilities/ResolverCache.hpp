@@ -0,0 +1,153 @@
+/**
+ *
+ * @file ResolverCache.hpp Process-wide, TTL-aware cache of hostname lookups
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
+
+#include "utilities/Resolver.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Tunable parameters of the ResolverCache
+ */
+struct ResolverCacheConfig
+{
+  bool enabled{ true };                         ///< When false, every lookup goes to getaddrinfo
+  size_t max_entries{ 1024 };                   ///< Per record type; least-recently-used entries are evicted beyond this
+  std::chrono::seconds min_ttl{ 5 };            ///< Floor applied to record TTLs
+  std::chrono::seconds max_ttl{ 300 };          ///< Ceiling applied to record TTLs
+  std::chrono::seconds default_ttl{ 60 };       ///< Used when the TTL is unknown (e.g. /etc/hosts entries)
+  std::chrono::seconds negative_ttl{ 2 };       ///< How long a failed lookup is remembered
+  bool query_record_ttl{ true };                ///< Query DNS for the A record TTL on a miss (names with a dot only)
+};
+
+/**
+ * @brief Counters describing ResolverCache activity
+ */
+struct ResolverCacheStats
+{
+  uint64_t static_hits{ 0 };   ///< Lookups answered from the StaticHostTable
+  uint64_t hits{ 0 };          ///< Lookups answered from a positive entry
+  uint64_t negative_hits{ 0 }; ///< Lookups answered from a cached failure
+  uint64_t misses{ 0 };        ///< Lookups which went to getaddrinfo
+  uint64_t coalesced{ 0 };     ///< Lookups which waited on another thread's in-flight miss
+  uint64_t expirations{ 0 };   ///< Entries dropped because their TTL elapsed
+  uint64_t evictions{ 0 };     ///< Entries dropped to respect max_entries
+  size_t entries{ 0 };         ///< Current number of cached names
+};
+
+/**
+ * @brief ResolverCache remembers the result of hostname lookups for the
+ * lifetime of their DNS records
+ *
+ * Positive results are kept for the record TTL, clamped to
+ * [min_ttl, max_ttl]. By default the TTL is learnt with one extra,
+ * single-attempt A query per miss on a name containing a dot; unqualified
+ * names (localhost, search-list names), and every name when
+ * query_record_ttl is off, are kept for default_ttl. Failures are kept for
+ * negative_ttl so that a missing host is not re-queried in a tight loop.
+ * Concurrent misses on the same name
+ * are coalesced into a single getaddrinfo call. Hostnames and SRV services
+ * are cached in separate tables. All methods are thread-safe.
+ */
+class ResolverCache
+{
+public:
+  explicit ResolverCache(ResolverCacheConfig config = ResolverCacheConfig());
+
+  ResolverCache(const ResolverCache&) = delete;            ///< ResolverCache is not copy-constructible
+  ResolverCache& operator=(const ResolverCache&) = delete; ///< ResolverCache is not copy-assignable
+  ResolverCache(ResolverCache&&) = delete;                 ///< ResolverCache is not move-constructible
+  ResolverCache& operator=(ResolverCache&&) = delete;      ///< ResolverCache is not move-assignable
+
+  /**
+   * @brief The process-wide cache used by get_ips_from_hostname
+   */
+  static ResolverCache& instance();
+
+  /**
+   * @brief Replace the configuration. Existing entries keep their expiry,
+   * but are trimmed to the new max_entries.
+   */
+  void configure(const ResolverCacheConfig& config);
+  ResolverCacheConfig get_config() const;
+
+  /**
+   * @brief Look up hostname, consulting the static host table (if installed)
+   * and then the cache before going to getaddrinfo
+   */
+  HostLookupResult resolve(const std::string& hostname);
+
+  /**
+   * @brief Look up the SRV records of service, consulting the cache first
+   */
+  ServiceLookupResult resolve_service(const std::string& service);
+
+  // Drop a single hostname or service from the cache
+  void invalidate(const std::string& name);
+
+  // Drop every cached name
+  void clear();
+
+  ResolverCacheStats get_stats() const;
+  void reset_stats();
+
+private:
+  template<class Result>
+  struct Table
+  {
+    struct Entry
+    {
+      Result result;
+      std::chrono::steady_clock::time_point expiry;
+      std::list<std::string>::iterator lru_position;
+    };
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> lru; // Most recently used at the front
+    std::unordered_map<std::string, std::shared_future<Result>> pending;
+  };
+
+  template<class Result, class Lookup>
+  Result resolve_with(Table<Result>& table, const std::string& name, Lookup lookup);
+
+  template<class Result>
+  void insert(Table<Result>& table, const std::string& name, const Result& result);
+
+  template<class Result>
+  void erase(Table<Result>& table, const std::string& name);
+
+  template<class Result>
+  void trim(Table<Result>& table);
+
+  template<class Result>
+  std::chrono::seconds ttl_for(const Result& result) const;
+
+  mutable std::mutex m_mutex;
+  ResolverCacheConfig m_config;
+  ResolverCacheStats m_stats;
+  std::atomic<uint64_t> m_static_hits{ 0 }; // Counted outside m_mutex
+  Table<HostLookupResult> m_hosts;
+  Table<ServiceLookupResult> m_services;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RESOLVERCACHE_HPP_
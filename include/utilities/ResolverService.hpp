@@ -0,0 +1,145 @@
+/**
+ *
+ * @file ResolverService.hpp Background re-resolution of registered connection strings
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_RESOLVERSERVICE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_RESOLVERSERVICE_HPP_
+
+#include "utilities/Resolver.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief ResolverService keeps the resolved form of registered connection
+ * strings up to date from a WorkerThread
+ *
+ * Callers subscribe to a connection string with a callback. The service
+ * resolves it in the background, re-resolves every refresh period, and calls
+ * the callback (from the service thread) with the resolved connection strings
+ * once they are known and again whenever the set of addresses changes.
+ * Lookups go through the ResolverCache, so a record is only re-queried once
+ * its TTL has elapsed. get_endpoints() returns the last known result without
+ * ever blocking on DNS.
+ */
+class ResolverService
+{
+public:
+  using Callback = std::function<void(const std::string& connection_string, const std::vector<std::string>& resolved)>;
+  using BatchResolver = std::function<std::vector<UriResolution>(const std::vector<std::string>&)>;
+
+  /**
+   * @brief ResolverService Constructor
+   * @param refresh_period Time between re-resolutions of all registered connection strings
+   * @param resolver Function used to resolve connection strings, resolve_uri_hostnames by default
+   */
+  explicit ResolverService(std::chrono::milliseconds refresh_period = std::chrono::seconds(30),
+                           BatchResolver resolver = BatchResolver());
+
+  ~ResolverService();
+
+  ResolverService(const ResolverService&) = delete;            ///< ResolverService is not copy-constructible
+  ResolverService& operator=(const ResolverService&) = delete; ///< ResolverService is not copy-assignable
+  ResolverService(ResolverService&&) = delete;                 ///< ResolverService is not move-constructible
+  ResolverService& operator=(ResolverService&&) = delete;      ///< ResolverService is not move-assignable
+
+  /**
+   * @brief Start the refresh thread
+   * @throws ThreadingIssue if the service is already running
+   */
+  void start(const std::string& name = "resolver-svc");
+
+  /**
+   * @brief Stop the refresh thread, without waiting for the current period to elapse
+   * @throws ThreadingIssue if the service is not running
+   */
+  void stop();
+
+  bool is_running() const { return m_thread.thread_running(); }
+
+  /**
+   * @brief Register interest in connection_string
+   * @return Subscription id, to be passed to unsubscribe
+   *
+   * The new connection string is resolved on the service thread as soon as possible.
+   */
+  uint64_t subscribe(const std::string& connection_string, Callback callback); // NOLINT(build/unsigned)
+
+  /**
+   * @brief Remove a subscription
+   *
+   * Once this returns the callback will not be called again, and any call of it already in
+   * progress on the service thread has finished, so the subscriber may release its state.
+   * A callback may unsubscribe itself, in which case there is nothing to wait for.
+   */
+  void unsubscribe(uint64_t subscription_id); // NOLINT(build/unsigned)
+
+  /**
+   * @brief Last known resolution of connection_string; empty if not yet resolved
+   */
+  std::vector<std::string> get_endpoints(const std::string& connection_string) const;
+
+  /**
+   * @brief Re-resolve all registered connection strings without waiting for the refresh period
+   */
+  void refresh_now();
+
+  /**
+   * @brief Change the refresh period; the current wait is re-timed from the last refresh
+   */
+  void set_refresh_period(std::chrono::milliseconds refresh_period);
+
+private:
+  struct Subscriber
+  {
+    Callback callback;
+    bool notified{ false };
+  };
+
+  struct Endpoint
+  {
+    std::vector<std::string> resolved;
+    bool known{ false };
+    std::map<uint64_t, Subscriber> subscribers; // NOLINT(build/unsigned)
+  };
+
+  void do_work(std::atomic<bool>& running_flag);
+  void refresh();
+
+  BatchResolver m_resolver;
+  std::chrono::milliseconds m_refresh_period;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::condition_variable m_notify_cv;
+  bool m_wake{ false };
+  bool m_period_changed{ false };
+  bool m_stop_requested{ false };
+  uint64_t m_next_subscription_id{ 1 }; // NOLINT(build/unsigned)
+  uint64_t m_notifying_id{ 0 };          // NOLINT(build/unsigned) Subscription whose callback is running
+  std::thread::id m_notifying_thread;
+  std::map<std::string, Endpoint> m_endpoints;
+  std::map<uint64_t, std::string> m_subscriptions; // NOLINT(build/unsigned)
+  WorkerThread m_thread;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_RESOLVERSERVICE_HPP_
@@ -11,13 +11,23 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_REUSABLETHREAD_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_REUSABLETHREAD_HPP_
 
+#include "utilities/CpuTopology.hpp"
+#include "utilities/InlineFunction.hpp"
+#include "utilities/MpscRing.hpp"
+#include "utilities/TaskCompletion.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+#include "utilities/detail/Futex.hpp"
+
 #include <atomic>
 #include <chrono>
-#include <condition_variable>
+#include <cstdint>
 #include <functional>
-#include <mutex>
+#include <memory>
 #include <string>
 #include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 namespace dunedaq {
 namespace utilities {
@@ -25,7 +35,45 @@ namespace utilities {
 class ReusableThread
 {
 public:
-  explicit ReusableThread(int threadid = 0);
+  /**
+   * @brief How the worker waits for the next task
+   *
+   * kBlock parks the worker in the kernel straight away (lowest CPU use, the
+   * original behaviour). kSpin busy-polls forever (lowest latency, burns a
+   * core). kSpinYield polls for the spin budget and then yields the CPU in a
+   * loop. kSpinPark polls for the spin budget and then parks in the kernel.
+   */
+  enum class WaitStrategy
+  {
+    kBlock,
+    kSpin,
+    kSpinYield,
+    kSpinPark
+  };
+
+  static constexpr uint32_t s_default_spin_budget = 10000; // NOLINT(build/unsigned)
+
+  // Tasks are stored inline, so set_work never allocates. A task whose
+  // function and arguments do not fit in this many bytes fails to compile.
+  static constexpr size_t s_task_capacity = 128;
+  using Task = InlineFunction<void(), s_task_capacity>;
+
+  enum class SubmitResult
+  {
+    kAccepted,
+    kFull ///< No room for the task; it was not queued and its arguments were not consumed
+  };
+
+  // Maximum number of queued tasks the worker takes off the queue at once
+  static constexpr size_t s_drain_batch = 32;
+
+  /**
+   * @brief ReusableThread Constructor
+   * @param threadid Thread ID
+   * @param queue_capacity If non-zero, the thread also has a queue of this many
+   * pending tasks (rounded up to a power of two, at least two), fed by try_submit
+   */
+  explicit ReusableThread(int threadid = 0, size_t queue_capacity = 0);
 
   ~ReusableThread();
 
@@ -46,20 +94,96 @@ public:
   // Pin thread to CPU
   void set_pin(int cpuid);
 
+  // Pin thread to a set of CPUs
+  void set_pin(const std::vector<int>& cpus);
+
+  // Apply a placement (see CpuTopology.hpp). The affinity is set at once; the
+  // memory policy is applied by the thread itself before it runs its next task.
+  void set_placement(const ThreadPlacement& placement);
+
+  // Select how the worker waits for tasks; spin_budget is the number of polls before yielding or parking
+  void set_wait_strategy(WaitStrategy strategy, uint32_t spin_budget = s_default_spin_budget); // NOLINT
+
+  WaitStrategy get_wait_strategy() const { return m_wait_strategy.load(std::memory_order_relaxed); }
+
   // Check for completed task execution
   bool get_readiness() const { return m_task_executed; }
 
-  // Set task to be executed
+  // Block until the current task, if any, and all queued tasks have completed
+  void wait_until_ready();
+
+  size_t get_queue_capacity() const { return m_queue ? m_queue->capacity() : 0; }
+
+  // Tasks accepted by try_submit and not yet completed
+  size_t get_queued_tasks() const { return m_queued.load(std::memory_order_relaxed); }
+
+  // Set task to be executed. The function and arguments are moved (or copied) into the thread and,
+  // as with std::bind, the function is called with the stored arguments as lvalues, so it may take
+  // them by non-const reference. Move-only arguments are accepted and can be taken by reference.
   template<typename Function, typename... Args>
   bool set_work(Function&& f, Args&&... args)
   {
-    if (!m_task_assigned && m_task_executed.exchange(false)) {
-      m_task = std::bind(f, args...);
-      m_task_assigned = true;
-      m_cv.notify_all();
-      return true;
+    return assign_work(nullptr, std::forward<Function>(f), std::forward<Args>(args)...);
+  }
+
+  // As set_work, additionally signalling completion once the task has run. The
+  // completion is reset here if the task is accepted, and must outlive the task.
+  template<typename Function, typename... Args>
+  bool set_work_tracked(TaskCompletion& completion, Function&& f, Args&&... args)
+  {
+    return assign_work(&completion, std::forward<Function>(f), std::forward<Args>(args)...);
+  }
+
+  // Queue a task. Tasks run in submission order, from any number of producers.
+  // Without a queue this is set_work, reporting kFull while a task is assigned.
+  template<typename Function, typename... Args>
+  SubmitResult try_submit(Function&& f, Args&&... args)
+  {
+    if (!m_queue) {
+      return set_work(std::forward<Function>(f), std::forward<Args>(args)...) ? SubmitResult::kAccepted
+                                                                              : SubmitResult::kFull;
     }
-    return false;
+
+    m_queued.fetch_add(1);
+    bool pushed = m_queue->try_push_with([&]() {
+      Task task([f = std::forward<Function>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(f, args);
+      });
+      return QueuedTask{ std::move(task), submission_time() };
+    });
+    if (!pushed) {
+      m_queued.fetch_sub(1);
+      return SubmitResult::kFull;
+    }
+    wake_worker();
+    return SubmitResult::kAccepted;
+  }
+
+  // Queue the callables in [first, last), moving from them, until the queue is
+  // full. Wakes the worker once. Returns the number of tasks accepted.
+  template<typename Iterator>
+  size_t try_submit_batch(Iterator first, Iterator last)
+  {
+    size_t accepted = 0;
+    if (!m_queue) {
+      if (first != last && assign_task(*first)) {
+        accepted = 1;
+      }
+      return accepted;
+    }
+
+    for (; first != last; ++first) {
+      m_queued.fetch_add(1);
+      if (!m_queue->try_push_with([&]() { return QueuedTask{ Task(std::move(*first)), submission_time() }; })) {
+        m_queued.fetch_sub(1);
+        break;
+      }
+      ++accepted;
+    }
+    if (accepted > 0) {
+      wake_worker();
+    }
+    return accepted;
   }
 
 private:
@@ -68,15 +192,115 @@ private:
   std::atomic<bool> m_task_executed;
   std::atomic<bool> m_task_assigned;
   std::atomic<bool> m_thread_quit;
-  std::atomic<bool> m_worker_done;
   std::atomic<bool> m_named;
-  std::function<void()> m_task;
+  Task m_task;
+  TaskCompletion* m_completion;
+
+  // Telemetry, only present if enabled when the thread was named
+  std::shared_ptr<ThreadStats> m_stats_owner;
+  std::atomic<ThreadStats*> m_stats;
+  std::atomic<pid_t> m_tid;
+  int64_t m_assigned_ns; ///< 0 unless telemetry is enabled
+
+  // Memory policy for the worker to apply to itself
+  std::atomic<MemoryPolicy> m_memory_policy;
+  std::atomic<int> m_memory_node;
+  std::atomic<bool> m_memory_policy_pending;
+
+  // Optional queue of pending tasks
+  struct QueuedTask
+  {
+    Task task;
+    int64_t submitted_ns; ///< 0 unless telemetry is enabled
+  };
+  std::unique_ptr<MpscRing<QueuedTask>> m_queue;
+  std::atomic<size_t> m_queued;
+
+  // Completion notification for wait_until_ready
+  std::atomic<uint32_t> m_completed_counter; // NOLINT(build/unsigned), futex word
+  std::atomic<int> m_ready_waiters;
+
+  // Wait strategy
+  std::atomic<WaitStrategy> m_wait_strategy;
+  std::atomic<uint32_t> m_spin_budget;  // NOLINT(build/unsigned)
+  std::atomic<uint32_t> m_wake_counter; // NOLINT(build/unsigned), futex word
+  std::atomic<bool> m_worker_parked;
 
-  // Locks
-  std::mutex m_mtx;
-  std::condition_variable m_cv;
   std::thread m_thread;
 
+  template<typename Function, typename... Args>
+  bool assign_work(TaskCompletion* completion, Function&& f, Args&&... args)
+  {
+    // Claiming m_task_executed gives this caller exclusive use of the task slot
+    if (!m_task_assigned.load(std::memory_order_acquire) && m_task_executed.exchange(false)) {
+      m_task = [f = std::forward<Function>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+        std::apply(f, args);
+      };
+      m_completion = completion;
+      m_assigned_ns = submission_time();
+      if (completion != nullptr) {
+        completion->reset();
+      }
+      m_task_assigned.store(true);
+      wake_worker();
+      return true;
+    }
+    return false;
+  }
+
+  // Moves from callable only if the task is accepted
+  template<typename Callable>
+  bool assign_task(Callable& callable)
+  {
+    if (!m_task_assigned.load(std::memory_order_acquire) && m_task_executed.exchange(false)) {
+      m_task = Task(std::move(callable));
+      m_completion = nullptr;
+      m_assigned_ns = submission_time();
+      m_task_assigned.store(true);
+      wake_worker();
+      return true;
+    }
+    return false;
+  }
+
+  int64_t submission_time() const
+  {
+    return m_stats.load(std::memory_order_relaxed) != nullptr ? ThreadTelemetry::now_ns() : 0;
+  }
+
+  // Run a task, recording its statistics if telemetry is on
+  void run_task(Task& task, int64_t submitted_ns);
+
+  // Bump the futex word and, if the worker is parked on it, wake it up
+  void wake_worker()
+  {
+    m_wake_counter.fetch_add(1);
+    if (m_worker_parked.load()) {
+      detail::futex_wake(m_wake_counter);
+    }
+  }
+
+  bool has_work() const
+  {
+    return m_task_assigned.load(std::memory_order_acquire) || m_thread_quit.load(std::memory_order_acquire) ||
+           m_queued.load(std::memory_order_acquire) > 0;
+  }
+
+  bool is_idle() const { return m_task_executed.load() && m_queued.load() == 0; }
+
+  // Called on the worker before running tasks
+  void apply_memory_policy();
+
+  // Run a batch of queued tasks; returns false if there were none
+  bool run_queued_tasks();
+
+  // Let wait_until_ready() callers re-check
+  void notify_completion();
+
+  // Wait, according to the wait strategy, until there may be something to do
+  void wait_for_work();
+  void wait_for_work_untimed();
+
   // Actual worker thread
   void thread_worker();
 };
@@ -0,0 +1,113 @@
+/**
+ *
+ * @file ReusableThreadPool.hpp Pool of ReusableThreads sharing work through per-thread queues
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_REUSABLETHREADPOOL_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_REUSABLETHREADPOOL_HPP_
+
+#include "utilities/ReusableThread.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief ReusableThreadPool runs submitted tasks on a fixed set of named ReusableThreads
+ *
+ * Each thread owns a task queue. Tasks submitted from outside the pool are
+ * spread over the queues round-robin; tasks submitted from a pool thread go
+ * to that thread's own queue. A thread takes tasks from the front of its own
+ * queue and, when that is empty, steals from the back of the others', so one
+ * slow task does not hold up the tasks queued behind it. Threads with
+ * nothing to do park in the kernel and are woken by the next submission.
+ *
+ * submit() never fails and never waits for a free thread. Tasks still queued
+ * when the pool is destroyed are run before the threads exit.
+ */
+class ReusableThreadPool
+{
+public:
+  using Task = ReusableThread::Task;
+
+  /**
+   * @brief ReusableThreadPool Constructor
+   * @param n_threads Number of threads, at least one
+   * @param name Threads are named name-0, name-1, ...
+   */
+  explicit ReusableThreadPool(size_t n_threads, const std::string& name = "rtpool");
+
+  ~ReusableThreadPool();
+
+  ReusableThreadPool(const ReusableThreadPool&) = delete;            ///< ReusableThreadPool is not copy-constructible
+  ReusableThreadPool& operator=(const ReusableThreadPool&) = delete; ///< ReusableThreadPool is not copy-assignable
+  ReusableThreadPool(ReusableThreadPool&&) = delete;                 ///< ReusableThreadPool is not move-constructible
+  ReusableThreadPool& operator=(ReusableThreadPool&&) = delete;      ///< ReusableThreadPool is not move-assignable
+
+  // Queue a task; the function and arguments are stored as by ReusableThread::set_work
+  template<typename Function, typename... Args>
+  void submit(Function&& f, Args&&... args)
+  {
+    submit_task([f = std::forward<Function>(f), args = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+      std::apply(f, args);
+    });
+  }
+
+  void submit_task(Task&& task);
+
+  // Pin one of the pool's threads to a CPU
+  void set_pin(size_t thread_index, int cpuid);
+
+  size_t get_thread_count() const { return m_threads.size(); }
+
+  // Tasks submitted but not yet started
+  size_t get_queued_tasks() const { return m_queued.load(std::memory_order_relaxed); }
+
+  uint64_t get_tasks_executed() const { return m_tasks_executed.load(std::memory_order_relaxed); } // NOLINT
+  uint64_t get_tasks_stolen() const { return m_tasks_stolen.load(std::memory_order_relaxed); }     // NOLINT
+
+  // Number of idle polls a thread makes before parking
+  static constexpr int s_idle_spins = 200;
+
+private:
+  struct alignas(64) Queue
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void worker_loop(size_t index);
+  bool try_pop(size_t index, Task& task);
+  bool try_steal(size_t index, Task& task);
+  void wait_for_tasks();
+
+  std::unique_ptr<Queue[]> m_queues;
+  std::vector<std::unique_ptr<ReusableThread>> m_threads;
+
+  std::atomic<size_t> m_queued{ 0 };
+  std::atomic<size_t> m_next_queue{ 0 };
+  std::atomic<int> m_idle_threads{ 0 };
+  std::atomic<uint32_t> m_wake_counter{ 0 }; // NOLINT(build/unsigned), futex word
+  std::atomic<bool> m_quit{ false };
+
+  std::atomic<uint64_t> m_tasks_executed{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_tasks_stolen{ 0 };   // NOLINT(build/unsigned)
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_REUSABLETHREADPOOL_HPP_
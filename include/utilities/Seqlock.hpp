@@ -0,0 +1,97 @@
+/**
+ * @file Seqlock.hpp Value published by one writer and read without locks
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_SEQLOCK_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_SEQLOCK_HPP_
+
+#include "utilities/detail/Futex.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Seqlock publishes a small trivially-copyable value to any number of readers
+ *
+ * The value is kept in 64-bit atomic words next to a sequence number which
+ * is odd while a store is in progress. Readers copy the words and retry if
+ * the sequence number changed meanwhile, so they never write shared memory
+ * and never contend with each other. Stores must not overlap: only one
+ * thread at a time may call store().
+ *
+ * Unlike std::atomic<T> for a T wider than the platform's largest
+ * lock-free atomic, it never falls back to a lock inside libatomic.
+ */
+template<typename T>
+class Seqlock
+{
+  static_assert(std::is_trivially_copyable<T>::value, "Seqlock values are copied word by word");
+
+public:
+  // True when the words and the sequence number are lock-free atomics
+  static constexpr bool is_lock_free = std::atomic<uint64_t>::is_always_lock_free; // NOLINT(build/unsigned)
+
+  explicit Seqlock(const T& value = T()) { store(value); }
+
+  Seqlock(const Seqlock&) = delete;            ///< Seqlock is not copy-constructible
+  Seqlock& operator=(const Seqlock&) = delete; ///< Seqlock is not copy-assignable
+  Seqlock(Seqlock&&) = delete;                 ///< Seqlock is not move-constructible
+  Seqlock& operator=(Seqlock&&) = delete;      ///< Seqlock is not move-assignable
+
+  T load() const
+  {
+    std::array<uint64_t, s_words> words; // NOLINT(build/unsigned)
+    while (true) {
+      auto sequence = m_sequence.load(std::memory_order_acquire);
+      if ((sequence & 1) != 0) {
+        detail::cpu_relax();
+        continue;
+      }
+      for (size_t ii = 0; ii < s_words; ++ii) {
+        words[ii] = m_words[ii].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+        break;
+      }
+    }
+    T value;
+    std::memcpy(static_cast<void*>(&value), words.data(), sizeof(T));
+    return value;
+  }
+
+  void store(const T& value)
+  {
+    std::array<uint64_t, s_words> words{}; // NOLINT(build/unsigned)
+    std::memcpy(words.data(), &value, sizeof(T));
+
+    auto sequence = m_sequence.load(std::memory_order_relaxed);
+    m_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t ii = 0; ii < s_words; ++ii) {
+      m_words[ii].store(words[ii], std::memory_order_relaxed);
+    }
+    m_sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+private:
+  static constexpr size_t s_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t); // NOLINT(build/unsigned)
+
+  alignas(64) std::atomic<uint64_t> m_sequence{ 0 };   // NOLINT(build/unsigned)
+  std::array<std::atomic<uint64_t>, s_words> m_words{}; // NOLINT(build/unsigned)
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_SEQLOCK_HPP_
@@ -0,0 +1,132 @@
+/**
+ * @file SpscRing.hpp Bounded lock-free single-producer, single-consumer ring buffer
+ * Like MpscRing every cell carries a sequence number which tells whether it is
+ * free or full. With a single producer the tail needs no atomic update, and the
+ * consumer claims whole batches with one compare-and-swap on the head. The head
+ * is claimed rather than simply advanced so that the producer may also evict the
+ * oldest value when it would rather drop it than wait.
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_SPSCRING_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_SPSCRING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+class SpscRing
+{
+public:
+  // The capacity is rounded up to a power of two, and to at least two
+  explicit SpscRing(size_t capacity)
+  {
+    m_capacity = 2;
+    while (m_capacity < capacity) {
+      m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_cells.reset(new Cell[m_capacity]);
+    for (size_t ii = 0; ii < m_capacity; ++ii) {
+      m_cells[ii].sequence.store(ii, std::memory_order_relaxed);
+    }
+  }
+
+  SpscRing(const SpscRing&) = delete;            ///< SpscRing is not copy-constructible
+  SpscRing& operator=(const SpscRing&) = delete; ///< SpscRing is not copy-assignable
+  SpscRing(SpscRing&&) = delete;                 ///< SpscRing is not move-constructible
+  SpscRing& operator=(SpscRing&&) = delete;      ///< SpscRing is not move-assignable
+
+  size_t capacity() const { return m_capacity; }
+
+  // Any thread; exact only when neither side is active
+  size_t size() const
+  {
+    auto head = m_head.load(std::memory_order_acquire);
+    auto tail = m_tail.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  // Producer thread only. Returns false if the ring is full.
+  bool try_push(T&& value) { return try_push_batch(&value, 1) == 1; }
+
+  // Producer thread only. Moves the first values of in into the ring, returns how many.
+  size_t try_push_batch(T* in, size_t count)
+  {
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    size_t pushed = 0;
+    while (pushed < count) {
+      auto& cell = m_cells[tail & m_mask];
+      if (cell.sequence.load(std::memory_order_acquire) != tail) {
+        break;
+      }
+      cell.value = std::move(in[pushed++]);
+      cell.sequence.store(tail + 1, std::memory_order_release);
+      ++tail;
+    }
+    m_tail.store(tail, std::memory_order_release);
+    return pushed;
+  }
+
+  // Consumer thread only. Returns false if the ring is empty.
+  bool try_pop(T& value) { return try_pop_batch(&value, 1) == 1; }
+
+  // Consumer thread only. Moves up to max_count values into out, returns how many.
+  size_t try_pop_batch(T* out, size_t max_count) { return claim(out, max_count); }
+
+  // Producer thread only. Discards the oldest value, returns false if there was none.
+  bool try_evict_oldest()
+  {
+    T discarded;
+    return claim(&discarded, 1) == 1;
+  }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  // Claim up to max_count full cells at the head, then move their values out
+  size_t claim(T* out, size_t max_count)
+  {
+    auto head = m_head.load(std::memory_order_relaxed);
+    while (true) {
+      size_t available = 0;
+      while (available < max_count &&
+             m_cells[(head + available) & m_mask].sequence.load(std::memory_order_acquire) == head + available + 1) {
+        ++available;
+      }
+      if (available == 0) {
+        return 0;
+      }
+      if (m_head.compare_exchange_weak(head, head + available, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+        for (size_t ii = 0; ii < available; ++ii) {
+          auto& cell = m_cells[(head + ii) & m_mask];
+          out[ii] = std::move(cell.value);
+          cell.sequence.store(head + ii + m_capacity, std::memory_order_release);
+        }
+        return available;
+      }
+    }
+  }
+
+  std::unique_ptr<Cell[]> m_cells;
+  size_t m_capacity;
+  size_t m_mask;
+  alignas(64) std::atomic<size_t> m_tail{ 0 };
+  alignas(64) std::atomic<size_t> m_head{ 0 };
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_SPSCRING_HPP_
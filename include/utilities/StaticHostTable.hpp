@@ -0,0 +1,112 @@
+/**
+ *
+ * @file StaticHostTable.hpp Memory-mapped, precompiled hostname to address table
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_STATICHOSTTABLE_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_STATICHOSTTABLE_HPP_
+
+#include "utilities/Issues.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief StaticHostTable answers hostname lookups from a binary file
+ * compiled from a hosts-style text file
+ *
+ * The file is memory-mapped read-only and holds an open-addressing hash
+ * table, so a lookup is a hash, usually a single probe and a string compare,
+ * without any system call. Names are matched case-insensitively, like DNS
+ * and /etc/hosts. Only IPv4 addresses are stored, matching
+ * get_ips_from_hostname. Use compile() (or the compile_host_table
+ * application) to produce the binary file.
+ */
+class StaticHostTable
+{
+public:
+  /**
+   * @brief Map a compiled table
+   * @throws StaticHostTableError if the file cannot be mapped or is not a valid table
+   */
+  explicit StaticHostTable(const std::string& path);
+
+  ~StaticHostTable();
+
+  StaticHostTable(const StaticHostTable&) = delete;            ///< StaticHostTable is not copy-constructible
+  StaticHostTable& operator=(const StaticHostTable&) = delete; ///< StaticHostTable is not copy-assignable
+  StaticHostTable(StaticHostTable&&) = delete;                 ///< StaticHostTable is not move-constructible
+  StaticHostTable& operator=(StaticHostTable&&) = delete;      ///< StaticHostTable is not move-assignable
+
+  /**
+   * @brief Find the addresses of hostname
+   * @param addresses Receives pointers to the IPv4 addresses (network byte order) inside the mapping
+   * @param count Receives the number of addresses
+   * @return Whether hostname is in the table
+   */
+  bool find(std::string_view hostname, const uint32_t*& addresses, size_t& count) const noexcept; // NOLINT
+
+  /**
+   * @brief Find the addresses of hostname, as dotted-quad strings
+   * @return Whether hostname is in the table
+   */
+  bool lookup(std::string_view hostname, std::vector<std::string>& addresses) const;
+
+  size_t size() const { return m_entry_count; }
+  const std::string& get_path() const { return m_path; }
+
+  /**
+   * @brief Compile a hosts-style text file ("address name [alias...]" per line,
+   * '#' comments) into the binary format. IPv6 addresses are skipped.
+   * @throws StaticHostTableError if either file cannot be accessed
+   */
+  static void compile(const std::string& hosts_path, const std::string& table_path);
+
+  // Case-insensitive, so that names differing only in case share a bucket
+  static uint64_t hash(std::string_view hostname) noexcept; // NOLINT(build/unsigned)
+
+private:
+  struct Bucket;
+
+  std::string m_path;
+  void* m_mapping{ nullptr };
+  size_t m_mapping_size{ 0 };
+  const Bucket* m_buckets{ nullptr };
+  const uint32_t* m_addresses{ nullptr }; // NOLINT(build/unsigned)
+  const char* m_strings{ nullptr };
+  uint32_t m_bucket_mask{ 0 }; // NOLINT(build/unsigned)
+  uint32_t m_entry_count{ 0 }; // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief Install the table consulted by get_ips_from_hostname before DNS
+ * @param path Compiled table; an empty path removes the table
+ * @throws StaticHostTableError if the table cannot be loaded
+ *
+ * If this is never called, the table named by the DUNEDAQ_STATIC_HOST_TABLE
+ * environment variable (if any) is loaded on first use.
+ */
+void
+set_static_host_table(const std::string& path);
+
+/**
+ * @brief The installed static host table, or nullptr
+ */
+std::shared_ptr<const StaticHostTable>
+get_static_host_table();
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_STATICHOSTTABLE_HPP_
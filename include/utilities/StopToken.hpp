@@ -0,0 +1,240 @@
+/**
+ * @file StopToken.hpp Stop request shared between a WorkerThread and its work function
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_STOPTOKEN_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_STOPTOKEN_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief StopState holds one stop request and wakes everything waiting on it
+ *
+ * Sleeps block on a futex on the stop word. Condition-variable waits register
+ * their mutex and condition variable, and parks their futex word, for the
+ * duration of the wait so that request_stop() can wake them. It can be re-armed with reset() once nothing
+ * waits on it any more.
+ */
+class StopState
+{
+public:
+  StopState() = default;
+
+  StopState(const StopState&) = delete;            ///< StopState is not copy-constructible
+  StopState& operator=(const StopState&) = delete; ///< StopState is not copy-assignable
+  StopState(StopState&&) = delete;                 ///< StopState is not move-constructible
+  StopState& operator=(StopState&&) = delete;      ///< StopState is not move-assignable
+
+  bool stop_requested() const { return m_stop.load(std::memory_order_acquire) != 0; }
+
+  // Set the stop request and wake all waiters. Idempotent.
+  void request_stop();
+
+  // Clear the stop request; must not be called while anyone is waiting
+  void reset() { m_stop.store(0, std::memory_order_release); }
+
+private:
+  friend class StopToken;
+
+  struct CvWaiter
+  {
+    std::mutex* mutex;
+    std::condition_variable* cv;
+    bool notified;
+  };
+
+  // Block until a stop is requested or the timeout has elapsed
+  void sleep_for(std::chrono::nanoseconds timeout);
+
+  // Block until a stop is requested or the steady_clock deadline has passed
+  void sleep_until(std::chrono::steady_clock::time_point deadline);
+
+  void add_waiter(CvWaiter* waiter);
+  void remove_waiter(CvWaiter* waiter);
+
+  // Block on word while it holds expected, unless a stop is requested or the steady_clock deadline has passed
+  void park(std::atomic<uint32_t>& word,                    // NOLINT(build/unsigned)
+            uint32_t expected,                              // NOLINT(build/unsigned)
+            std::chrono::steady_clock::time_point deadline);
+
+  std::atomic<uint32_t> m_stop{ 0 }; // NOLINT(build/unsigned), futex word
+  std::mutex m_waiters_mutex;
+  std::vector<CvWaiter*> m_waiters;
+  std::vector<std::atomic<uint32_t>*> m_parked_words; // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief StopToken gives a work function interruptible waits
+ *
+ * Every wait returns as soon as a stop is requested, so a work loop of the form
+ *
+ * @code
+ * void do_work(const StopToken& stop){
+ *   while(stop.wait_for(std::chrono::milliseconds(100))){
+ *    // poll something ...
+ *   }
+ * }
+ * @endcode
+ *
+ * exits at once when its WorkerThread is stopped rather than after its next
+ * sleep. A token is only valid while the thread that handed it out exists.
+ */
+class StopToken
+{
+public:
+  explicit StopToken(StopState& state)
+    : m_state(&state)
+  {}
+
+  bool stop_requested() const { return m_state->stop_requested(); }
+
+  /**
+   * @brief Sleep for the given time unless a stop is requested
+   * @return true if the full time elapsed, false if a stop was requested
+   */
+  template<class Rep, class Period>
+  bool wait_for(const std::chrono::duration<Rep, Period>& timeout) const
+  {
+    return wait_until(std::chrono::steady_clock::now() + timeout);
+  }
+
+  /**
+   * @brief Sleep until the given time unless a stop is requested
+   * @return true if the deadline was reached, false if a stop was requested
+   */
+  template<class Clock, class Duration>
+  bool wait_until(const std::chrono::time_point<Clock, Duration>& deadline) const
+  {
+    while (!stop_requested()) {
+      auto remaining = deadline - Clock::now();
+      if (remaining <= Clock::duration::zero()) {
+        return true;
+      }
+      // steady_clock deadlines are handed to the kernel as they are
+      if constexpr (std::is_same<Clock, std::chrono::steady_clock>::value) {
+        m_state->sleep_until(std::chrono::time_point_cast<std::chrono::steady_clock::duration>(deadline));
+      } else {
+        m_state->sleep_for(std::chrono::duration_cast<std::chrono::nanoseconds>(remaining));
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Sleep on a futex word while it holds expected, until it is woken or a stop is requested
+   *
+   * Whoever changes the word must futex-wake it. A stop request increments
+   * the word before waking it. May return spuriously; callers re-check their
+   * condition.
+   * @return false if a stop was requested
+   */
+  bool park(std::atomic<uint32_t>& word, uint32_t expected) const // NOLINT(build/unsigned)
+  {
+    return park_until(word, expected, std::chrono::steady_clock::time_point::max());
+  }
+
+  /**
+   * @brief As park, but also returns once the deadline has passed
+   * @return false if a stop was requested
+   */
+  bool park_until(std::atomic<uint32_t>& word,                           // NOLINT(build/unsigned)
+                  uint32_t expected,                                     // NOLINT(build/unsigned)
+                  std::chrono::steady_clock::time_point deadline) const
+  {
+    m_state->park(word, expected, deadline);
+    return !stop_requested();
+  }
+
+  /**
+   * @brief Wait on cv until pred() holds or a stop is requested
+   * @return pred() at the time of return
+   */
+  template<class Predicate>
+  bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, Predicate pred) const
+  {
+    Registration registration(*m_state, lock, cv);
+    while (!pred()) {
+      if (stop_requested()) {
+        return false;
+      }
+      cv.wait(lock);
+    }
+    return true;
+  }
+
+  /**
+   * @brief Wait on cv until pred() holds, a stop is requested or the timeout has elapsed
+   * @return pred() at the time of return
+   */
+  template<class Rep, class Period, class Predicate>
+  bool wait_for(std::unique_lock<std::mutex>& lock,
+                std::condition_variable& cv,
+                const std::chrono::duration<Rep, Period>& timeout,
+                Predicate pred) const
+  {
+    return wait_until(lock, cv, std::chrono::steady_clock::now() + timeout, pred);
+  }
+
+  /**
+   * @brief Wait on cv until pred() holds, a stop is requested or the deadline has passed
+   * @return pred() at the time of return
+   */
+  template<class Clock, class Duration, class Predicate>
+  bool wait_until(std::unique_lock<std::mutex>& lock,
+                  std::condition_variable& cv,
+                  const std::chrono::time_point<Clock, Duration>& deadline,
+                  Predicate pred) const
+  {
+    Registration registration(*m_state, lock, cv);
+    while (!pred()) {
+      if (stop_requested()) {
+        return false;
+      }
+      if (cv.wait_until(lock, deadline) == std::cv_status::timeout) {
+        return pred();
+      }
+    }
+    return true;
+  }
+
+private:
+  // Keeps a condition-variable wait known to the StopState. The caller holds
+  // lock throughout, which is what lets request_stop() avoid a lost wake-up.
+  class Registration
+  {
+  public:
+    Registration(StopState& state, std::unique_lock<std::mutex>& lock, std::condition_variable& cv)
+      : m_state(state)
+      , m_waiter{ lock.mutex(), &cv, false }
+    {
+      m_state.add_waiter(&m_waiter);
+    }
+    ~Registration() { m_state.remove_waiter(&m_waiter); }
+
+    Registration(const Registration&) = delete;
+    Registration& operator=(const Registration&) = delete;
+
+  private:
+    StopState& m_state;
+    StopState::CvWaiter m_waiter;
+  };
+
+  StopState* m_state;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_STOPTOKEN_HPP_
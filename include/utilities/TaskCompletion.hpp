@@ -0,0 +1,63 @@
+/**
+ * @file TaskCompletion.hpp One-shot, resettable completion signal for tasks run on ReusableThread
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_TASKCOMPLETION_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_TASKCOMPLETION_HPP_
+
+#include "utilities/detail/Futex.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief TaskCompletion is signalled by the worker when a tracked task has run
+ *
+ * It is owned by the caller, which passes it to ReusableThread::set_work_tracked
+ * and may then wait on it. Unlike a std::future it never allocates and can be
+ * reused for the next task. Waiting blocks on a futex; signalling only enters
+ * the kernel if someone is waiting.
+ */
+class TaskCompletion
+{
+public:
+  TaskCompletion() = default;
+
+  TaskCompletion(const TaskCompletion&) = delete;            ///< TaskCompletion is not copy-constructible
+  TaskCompletion& operator=(const TaskCompletion&) = delete; ///< TaskCompletion is not copy-assignable
+  TaskCompletion(TaskCompletion&&) = delete;                 ///< TaskCompletion is not move-constructible
+  TaskCompletion& operator=(TaskCompletion&&) = delete;      ///< TaskCompletion is not move-assignable
+
+  bool ready() const { return m_state.load(std::memory_order_acquire) == s_ready; }
+
+  // Block until signalled
+  void wait();
+
+  // Block until signalled or the timeout has elapsed; returns ready()
+  bool wait_for(std::chrono::nanoseconds timeout);
+
+  // Mark as complete and wake any waiters
+  void signal();
+
+  // Make the completion pending again
+  void reset() { m_state.store(s_pending, std::memory_order_relaxed); }
+
+private:
+  static constexpr uint32_t s_pending = 0;     // NOLINT(build/unsigned)
+  static constexpr uint32_t s_ready = 1;       // NOLINT(build/unsigned)
+  static constexpr uint32_t s_pending_wait = 2; // NOLINT(build/unsigned), pending with a waiter
+
+  std::atomic<uint32_t> m_state{ s_ready }; // NOLINT(build/unsigned), futex word
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_TASKCOMPLETION_HPP_
@@ -0,0 +1,84 @@
+/**
+ * @file ThreadAttributes.hpp Scheduling, affinity and stack options for new threads
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_THREADATTRIBUTES_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_THREADATTRIBUTES_HPP_
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+enum class SchedulingPolicy
+{
+  kInherit,   ///< Use the policy and priority of the thread which starts it
+  kOther,     ///< SCHED_OTHER, the default time-sharing policy
+  kFifo,      ///< SCHED_FIFO real-time policy
+  kRoundRobin ///< SCHED_RR real-time policy
+};
+
+/**
+ * @brief How a thread should be created and scheduled
+ *
+ * The defaults leave everything as std::thread would. Real-time policies need
+ * CAP_SYS_NICE (or a suitable RLIMIT_RTPRIO); when the thread cannot be created
+ * with them it is created with the inherited policy instead, with a warning.
+ */
+struct ThreadAttributes
+{
+  SchedulingPolicy policy = SchedulingPolicy::kInherit;
+  int priority = 0;                 ///< Real-time priority (1-99) for kFifo and kRoundRobin, else 0
+  std::optional<int> nice;          ///< Nice value (-20 to 19), set by the thread itself when it starts
+  std::vector<int> cpus;            ///< CPUs the thread may run on; empty to inherit the affinity
+  size_t stack_size = 0;            ///< Stack size in bytes; 0 for the default
+  std::optional<size_t> guard_size; ///< Stack guard size in bytes; unset for the default
+
+  // Whether everything is left at its default
+  bool is_default() const
+  {
+    return policy == SchedulingPolicy::kInherit && !nice && cpus.empty() && stack_size == 0 && !guard_size;
+  }
+};
+
+// Name of a policy as used in messages, e.g. "SCHED_FIFO"
+std::string
+to_string(SchedulingPolicy policy);
+
+/**
+ * @brief Initialise attr from attributes
+ *
+ * Settings which cannot be applied are reported as ThreadingIssue warnings and
+ * left at their defaults. attr must be destroyed with pthread_attr_destroy.
+ * @param with_scheduling Whether to apply the scheduling policy and priority
+ * @return Whether every setting was applied
+ */
+bool
+build_pthread_attr(const ThreadAttributes& attributes, pthread_attr_t& attr, bool with_scheduling = true);
+
+/**
+ * @brief Set the nice value of the calling thread
+ * @return Whether the nice value was set; failures are reported as ThreadingIssue warnings
+ */
+bool
+set_current_thread_nice(int nice);
+
+/**
+ * @brief Read the scheduling policy and priority of a running thread
+ * @return Whether they could be read
+ */
+bool
+get_thread_scheduling(pthread_t handle, SchedulingPolicy& policy, int& priority);
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_THREADATTRIBUTES_HPP_
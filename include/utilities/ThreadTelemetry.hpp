@@ -0,0 +1,165 @@
+/**
+ *
+ * @file ThreadTelemetry.hpp Opt-in execution statistics for ReusableThread and WorkerThread
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_THREADTELEMETRY_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_THREADTELEMETRY_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <sys/types.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief Power-of-two histogram of durations in nanoseconds
+ *
+ * Bucket i counts durations in [2^(i-1), 2^i) ns; bucket 0 counts zero. Only
+ * one thread may record, any thread may read.
+ */
+class DurationHistogram
+{
+public:
+  static constexpr size_t s_buckets = 48;
+
+  void record(int64_t ns)
+  {
+    auto value = static_cast<uint64_t>(ns > 0 ? ns : 0); // NOLINT(build/unsigned)
+    size_t bucket = value == 0 ? 0 : 64 - static_cast<size_t>(__builtin_clzll(value));
+    if (bucket >= s_buckets) {
+      bucket = s_buckets - 1;
+    }
+    bump(m_counts[bucket], 1);
+    bump(m_count, 1);
+    bump(m_sum_ns, value);
+    if (value > m_max_ns.load(std::memory_order_relaxed)) {
+      m_max_ns.store(value, std::memory_order_relaxed);
+    }
+  }
+
+  nlohmann::json to_json() const;
+
+private:
+  // Single writer, so a plain load and store is enough and avoids a locked instruction
+  static void bump(std::atomic<uint64_t>& counter, uint64_t amount) // NOLINT(build/unsigned)
+  {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+  }
+
+  std::array<std::atomic<uint64_t>, s_buckets> m_counts{}; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_count{ 0 };                       // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_sum_ns{ 0 };                      // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_max_ns{ 0 };                      // NOLINT(build/unsigned)
+};
+
+/**
+ * @brief Statistics of one thread, written by that thread only
+ */
+class ThreadStats
+{
+public:
+  ThreadStats(const std::string& name, const std::string& type)
+    : m_name(name)
+    , m_type(type)
+  {}
+
+  // handoff_ns is the time from submission to start, negative if unknown
+  void record_task(int64_t handoff_ns, int64_t run_ns)
+  {
+    m_tasks_executed.store(m_tasks_executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    m_busy_ns.store(m_busy_ns.load(std::memory_order_relaxed) + run_ns, std::memory_order_relaxed);
+    m_run_time.record(run_ns);
+    if (handoff_ns >= 0) {
+      m_handoff.record(handoff_ns);
+    }
+  }
+
+  void record_idle(int64_t idle_ns)
+  {
+    m_idle_ns.store(m_idle_ns.load(std::memory_order_relaxed) + idle_ns, std::memory_order_relaxed);
+  }
+
+  // Called by the thread itself when it starts running
+  void set_started(pid_t tid);
+
+  const std::string& get_name() const { return m_name; }
+  pid_t get_tid() const { return m_tid.load(); }
+
+  /**
+   * @brief Current statistics. Context switches and CPU time are read from
+   * /proc/self/task/<tid> at this point.
+   */
+  nlohmann::json to_json() const;
+
+private:
+  std::string m_name;
+  std::string m_type;
+  std::atomic<pid_t> m_tid{ 0 };
+  std::atomic<int64_t> m_started_ns{ 0 };
+  std::atomic<uint64_t> m_tasks_executed{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<int64_t> m_busy_ns{ 0 };
+  std::atomic<int64_t> m_idle_ns{ 0 };
+  DurationHistogram m_run_time;
+  DurationHistogram m_handoff;
+};
+
+/**
+ * @brief ThreadTelemetry collects the ThreadStats of named threads
+ *
+ * Telemetry is off by default. When it is enabled, threads named afterwards
+ * (ReusableThread::set_name, WorkerThread::start_working_thread) register
+ * their statistics under that name. Threads without statistics pay a single
+ * pointer test per task. Statistics disappear with the thread object.
+ */
+class ThreadTelemetry
+{
+public:
+  static ThreadTelemetry& instance();
+
+  void set_enabled(bool enabled) { m_enabled.store(enabled); }
+  bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Create statistics for a thread; the name gets a "#<n>" suffix if it is already in use
+   * @return nullptr if telemetry is disabled
+   */
+  std::shared_ptr<ThreadStats> register_thread(const std::string& name, const std::string& type);
+
+  // Statistics of all live threads, keyed by thread name
+  nlohmann::json snapshot();
+
+  static int64_t now_ns()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+  }
+
+  static pid_t current_tid();
+
+private:
+  ThreadTelemetry() = default;
+
+  std::atomic<bool> m_enabled{ false };
+  std::mutex m_mutex;
+  std::map<std::string, std::weak_ptr<ThreadStats>> m_threads;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_THREADTELEMETRY_HPP_
@@ -9,12 +9,15 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATOR_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATOR_HPP_
 
-#include "utilities/TimestampEstimatorBase.hpp"
+#include "utilities/DriftEstimator.hpp"
 #include "utilities/Issues.hpp"
+#include "utilities/MpscRing.hpp"
+#include "utilities/Seqlock.hpp"
+#include "utilities/TimestampEstimatorBase.hpp"
+#include "utilities/TscClock.hpp"
 
 #include <atomic>
 #include <memory>
-#include <mutex>
 
 namespace dunedaq {
 namespace utilities {
@@ -23,6 +26,12 @@ namespace utilities {
  * @brief TimestampEstimator is an implementation of
  * TimestampEstimatorBase that uses TimeSync messages from an input
  * queue to estimate the current timestamp
+ *
+ * Neither reading the estimate nor adding TimeSyncs takes a lock. The
+ * estimate is published through a Seqlock. TimeSyncs are queued on an
+ * MpscRing and ingested by whichever thread finds no other thread doing so
+ * (see add_timestamp_datapoint), so the drift fit still sees them one at a
+ * time without sources ever waiting for each other.
  **/
 class TimestampEstimator : public TimestampEstimatorBase
 {
@@ -35,28 +44,136 @@ public:
 
   uint64_t get_timestamp_estimate() const override;
 
+  /**
+   * Any thread. The TimeSync is ingested before returning unless another
+   * thread is already ingesting, in which case that thread ingests it too.
+   */
   void add_timestamp_datapoint(uint64_t daq_time, uint64_t system_time);
 
+  /**
+   * Extrapolate with a clock frequency fitted over the last window
+   * TimeSyncs (see DriftEstimator) rather than with the nominal one. A
+   * window of 1, the default, uses the latest TimeSync only. When a new fit
+   * is behind the estimate by more than its noise, the estimate slows down
+   * to meet it over about one TimeSync interval rather than going back.
+   * Forgets the TimeSyncs received so far. Waits for any TimeSyncs being
+   * ingested.
+   */
+  void set_drift_window(size_t window);
+
+  /**
+   * Extrapolate with the CPU time-stamp counter (see TscClock) rather than
+   * steady_clock: get_timestamp_estimate then costs a few nanoseconds and
+   * keeps sub-microsecond resolution. Calibrating the TSC on first use takes
+   * TscClock::s_calibration_ms. Returns whether the TSC is used; it is not
+   * where it is not invariant.
+   */
+  bool set_use_tsc(bool use);
+
+  // The frequency the current estimate is extrapolated with
+  double get_estimated_frequency_hz() const { return m_current_timestamp_estimate.load().frequency_hz; }
+
+  // Whether reading the estimate and adding TimeSyncs are free of locks on this platform
+  static constexpr bool is_lock_free()
+  {
+    return Seqlock<TimeSyncPoint>::is_lock_free && std::atomic<bool>::is_always_lock_free &&
+           std::atomic<uint64_t>::is_always_lock_free && std::atomic<size_t>::is_always_lock_free;
+  }
+
+  // TimeSyncs dropped because too many were waiting to be ingested
+  uint64_t get_dropped_timesync_count() const { return m_dropped_timesync_count.load(); } // NOLINT(build/unsigned)
+
   template <class T>
   void timesync_callback(const T& tsync);
 
+  /**
+   * As timesync_callback for count messages at once, e.g. a backlog drained
+   * after a hiccup. Only the newest valid TimeSync of this run from another
+   * process is added, so the estimate is recomputed once; the older ones
+   * do not reach the drift fit either. TimeSyncs still carrying the invalid
+   * daq_time marker are discarded.
+   */
+  template <class T>
+  void timesync_batch_callback(const T* tsyncs, size_t count);
+
   uint64_t get_received_timesync_count() const { return m_received_timesync_count.load(); }
+
+  // TimeSyncs from another run or from this process, or in a batch without a valid daq_time
+  uint64_t get_discarded_timesync_count() const { return m_discarded_timesync_count.load(); } // NOLINT(build/unsigned)
+
+protected:
+  uint64_t get_clock_frequency_hz() const override { return m_clock_frequency_hz; } // NOLINT(build/unsigned)
+
 private:
 
   struct TimeSyncPoint {
     uint64_t daq_time;
     std::chrono::time_point<std::chrono::steady_clock> system_time;
+    double frequency_hz;
+    uint64_t tsc;       // NOLINT(build/unsigned)
+    TscScale tsc_scale; // A zero multiplier extrapolates from system_time instead
+    // Ticks taken off the extrapolation in proportion to the time elapsed, in
+    // microseconds or TSC ticks, up to slew_span, and in full after it
+    uint64_t slew_ticks; // NOLINT(build/unsigned)
+    double slew_span;
+  };
+
+  struct TimeSyncSample {
+    uint64_t daq_time;    // NOLINT(build/unsigned)
+    uint64_t system_time; // NOLINT(build/unsigned)
   };
-  
-  std::atomic<TimeSyncPoint> m_current_timestamp_estimate;
 
+  // TimeSyncs waiting to be ingested; more than this many are superseded anyway
+  static constexpr size_t s_pending_capacity = 64;
+
+  // An estimate ahead of the drift fit by more than this many RMS residuals
+  // of the fit (plus the microsecond rounding of the clocks) is slewed back
+  // onto it, over a TimeSync interval but never below this fraction of the
+  // fitted frequency, so that time does not go back
+  static constexpr double s_slew_threshold_rms = 3.;
+  static constexpr double s_min_slew_rate = 0.5;
+
+  // Only the clock the estimate is extrapolated with needs to be read
+  static uint64_t extrapolate(const TimeSyncPoint& estimate,
+                              std::chrono::steady_clock::time_point now,
+                              uint64_t tsc_now); // NOLINT(build/unsigned)
+
+  TimeSyncPoint make_estimate(uint64_t daq_time, // NOLINT(build/unsigned)
+                              double frequency_hz,
+                              std::chrono::steady_clock::time_point now,
+                              uint64_t tsc_now,           // NOLINT(build/unsigned)
+                              uint64_t slew_ticks = 0,    // NOLINT(build/unsigned)
+                              double slew_span_us = 0.) const;
+
+  // Wait to become the ingesting thread, for reconfiguration; finish with ingest_pending(true)
+  void claim_ingestion();
+
+  // Ingest queued TimeSyncs unless another thread is doing so. claimed is
+  // whether the caller already holds m_ingesting; it is released on return.
+  void ingest_pending(bool claimed);
+  void ingest(const TimeSyncSample& sample);
+
+  Seqlock<TimeSyncPoint> m_current_timestamp_estimate;
 
   uint64_t m_clock_frequency_hz; // NOLINT(build/unsigned)
+
+  // TimeSyncs are counted once queued. The thread which sets m_ingesting
+  // ingests, and checks the count against m_ingested_count after clearing it.
+  MpscRing<TimeSyncSample> m_pending;
+  std::atomic<uint64_t> m_queued_count{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<bool> m_ingesting{ false };
+
+  // Only touched by the ingesting thread
+  uint64_t m_ingested_count{ 0 }; // NOLINT(build/unsigned)
   uint64_t m_most_recent_daq_time;
   uint64_t m_most_recent_system_time;
-  std::mutex m_datapoint_mutex;
+  DriftEstimator m_drift;
+  double m_tsc_frequency_hz{ 0. }; // Unless set_use_tsc
+
   uint32_t m_run_number {0};
   std::atomic<uint64_t> m_received_timesync_count; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_dropped_timesync_count{ 0 }; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> m_discarded_timesync_count{ 0 }; // NOLINT(build/unsigned)
   uint32_t m_current_process_id;
 };
 
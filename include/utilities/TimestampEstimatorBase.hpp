@@ -9,7 +9,10 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATORBASE_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_TIMESTAMPESTIMATORBASE_HPP_
 
+#include "utilities/StopToken.hpp"
+
 #include <atomic>
+#include <cstdint>
 
 namespace dunedaq {
 namespace utilities {
@@ -47,6 +50,40 @@ public:
      Returns kFinished if the timestamp became valid, or kInterrupted if continue_flag became false first
   */
   WaitStatus wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag);
+
+  /**
+     As wait_for_valid_timestamp(continue_flag), but returns kInterrupted
+     as soon as a stop is requested through stop, with no polling.
+  */
+  WaitStatus wait_for_valid_timestamp(const StopToken& stop);
+
+  /**
+     As wait_for_timestamp(ts, continue_flag), but returns kInterrupted
+     as soon as a stop is requested through stop, with no polling.
+  */
+  WaitStatus wait_for_timestamp(uint64_t ts, const StopToken& stop);
+
+protected:
+  /**
+     Ticks per second of the estimate, from which the waits predict when a
+     timestamp is due and sleep until then. 0 if unknown, in which case
+     they poll.
+  */
+  virtual uint64_t get_clock_frequency_hz() const { return 0; } // NOLINT(build/unsigned)
+
+  /**
+     Wake the waits to re-check the estimate. Implementations call this
+     whenever they publish an estimate which does not follow from the
+     previous one and the clock frequency.
+  */
+  void notify_waiters();
+
+private:
+  // Either continue_flag or stop is null
+  WaitStatus wait_for(uint64_t ts, std::atomic<bool>* continue_flag, const StopToken* stop);
+
+  std::atomic<uint32_t> m_estimate_generation{ 0 }; // NOLINT(build/unsigned), futex word
+  std::atomic<uint32_t> m_waiters{ 0 };             // NOLINT(build/unsigned)
 };
 
 } // namespace utilities
@@ -26,6 +26,9 @@ public:
 
   uint64_t get_timestamp_estimate() const override;
 
+protected:
+  uint64_t get_clock_frequency_hz() const override { return m_clock_frequency_hz; } // NOLINT(build/unsigned)
+
 private:
   uint64_t m_clock_frequency_hz; // NOLINT(build/unsigned)
 };
@@ -0,0 +1,82 @@
+/**
+ * @file TscClock.hpp CPU time-stamp counter, calibrated against CLOCK_MONOTONIC
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_TSCCLOCK_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_TSCCLOCK_HPP_
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <cstdint>
+
+namespace dunedaq {
+namespace utilities {
+
+/**
+ * @brief TscClock reads the CPU time-stamp counter, which costs a few
+ * nanoseconds where a clock_gettime costs tens
+ *
+ * It is only usable where the TSC is invariant, i.e. ticks at a constant
+ * rate in every power state and on every core, as reported by CPUID.
+ * Elsewhere is_invariant() is false and get_frequency_hz() is 0.
+ */
+class TscClock
+{
+public:
+  static bool is_invariant();
+
+  // The counter; 0 on CPUs without one
+  static uint64_t now() // NOLINT(build/unsigned)
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+  /**
+   * TSC ticks per second, measured against CLOCK_MONOTONIC over
+   * s_calibration_ms on first use (so call it outside hot paths once);
+   * 0 if the TSC is not invariant
+   */
+  static double get_frequency_hz();
+
+  static constexpr int s_calibration_ms = 50;
+};
+
+/**
+ * @brief TscScale converts TSC tick differences to the ticks of a clock of
+ * another frequency as (delta * multiplier) >> shift
+ *
+ * The product is taken in 128 bits, so there is no division and no overflow
+ * for any delta.
+ */
+struct TscScale
+{
+  uint64_t multiplier{ 0 }; // NOLINT(build/unsigned)
+  uint32_t shift{ 0 };      // NOLINT(build/unsigned)
+
+  // The largest shift which keeps the multiplier below 2^63, for the best precision
+  static TscScale for_frequency(double frequency_hz, double tsc_frequency_hz);
+
+  uint64_t convert(uint64_t tsc_delta) const // NOLINT(build/unsigned)
+  {
+    return static_cast<uint64_t>((static_cast<uint128_t>(tsc_delta) * multiplier) >> shift);
+  }
+
+private:
+  // __extension__ keeps -pedantic quiet about the GCC/Clang 128-bit type in every includer
+  __extension__ typedef unsigned __int128 uint128_t; // NOLINT
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_TSCCLOCK_HPP_
@@ -0,0 +1,157 @@
+/**
+ *
+ * @file Watchdog.hpp Heartbeats for work loops and a watchdog which reports stalled ones
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#ifndef UTILITIES_INCLUDE_UTILITIES_WATCHDOG_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_WATCHDOG_HPP_
+
+#include "nlohmann/json.hpp"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dunedaq {
+namespace utilities {
+
+class WorkerThread;
+
+/**
+ * @brief Heartbeat counts the iterations of one work loop
+ *
+ * The loop calls beat() once per iteration. Only that thread may beat, so the
+ * count is bumped with a relaxed load and store rather than a locked
+ * instruction, and lives on its own cache line.
+ */
+class Heartbeat
+{
+public:
+  explicit Heartbeat(const std::string& name)
+    : m_name(name)
+  {}
+
+  Heartbeat(const Heartbeat&) = delete;            ///< Heartbeat is not copy-constructible
+  Heartbeat& operator=(const Heartbeat&) = delete; ///< Heartbeat is not copy-assignable
+  Heartbeat(Heartbeat&&) = delete;                 ///< Heartbeat is not move-constructible
+  Heartbeat& operator=(Heartbeat&&) = delete;      ///< Heartbeat is not move-assignable
+
+  void beat() { m_count.store(m_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+  uint64_t get_count() const { return m_count.load(std::memory_order_relaxed); } // NOLINT(build/unsigned)
+
+  const std::string& get_name() const { return m_name; }
+
+  // Record the calling thread as the one beating, for stack traces
+  void attach_current_thread();
+
+  // A worker which does not beat for longer than this is reported; zero disables the check
+  void set_stall_threshold(std::chrono::milliseconds threshold) { m_stall_threshold_ms.store(threshold.count()); }
+  std::chrono::milliseconds get_stall_threshold() const
+  {
+    return std::chrono::milliseconds(m_stall_threshold_ms.load(std::memory_order_relaxed));
+  }
+
+  // Inactive heartbeats (e.g. of a stopped thread) are never reported
+  void set_active(bool active) { m_active.store(active); }
+  bool is_active() const { return m_active.load(std::memory_order_relaxed); }
+
+private:
+  friend class Watchdog;
+
+  alignas(64) std::atomic<uint64_t> m_count{ 0 }; // NOLINT(build/unsigned)
+  alignas(64) std::string m_name;
+  std::atomic<int64_t> m_stall_threshold_ms{ 0 };
+  std::atomic<bool> m_active{ false };
+  std::atomic<pid_t> m_tid{ 0 };
+};
+
+/**
+ * @brief Watchdog samples heartbeats from a single thread
+ *
+ * Each sample updates the iteration rate of every watched heartbeat. A worker
+ * whose count has not changed for longer than its stall threshold is reported
+ * once with a WorkerStalled ERS warning, which includes a stack trace of the
+ * stalled thread when stack traces are enabled (they are off by default). The watchdog thread starts
+ * with the first watched heartbeat.
+ *
+ * Stack traces are taken by signalling the stalled thread, whose handler calls
+ * backtrace(3). The signal handler is only installed if the signal has none
+ * yet. Link with -rdynamic to get function names rather than addresses.
+ * Being signalled makes a timed blocking call in the stalled thread (poll,
+ * epoll_wait, nanosleep, recv with a timeout, ...) fail with EINTR even though
+ * the handler uses SA_RESTART, which code that does not retry on EINTR may
+ * not expect; enable stack traces only for threads known to tolerate it.
+ */
+class Watchdog
+{
+public:
+  // The process-wide watchdog used by WorkerThread
+  static Watchdog& instance();
+
+  explicit Watchdog(std::chrono::milliseconds sample_period = std::chrono::milliseconds(100));
+  ~Watchdog();
+
+  Watchdog(const Watchdog&) = delete;            ///< Watchdog is not copy-constructible
+  Watchdog& operator=(const Watchdog&) = delete; ///< Watchdog is not copy-assignable
+  Watchdog(Watchdog&&) = delete;                 ///< Watchdog is not move-constructible
+  Watchdog& operator=(Watchdog&&) = delete;      ///< Watchdog is not move-assignable
+
+  // Watch a heartbeat until it is destroyed; watching it again has no effect
+  void watch(const std::shared_ptr<Heartbeat>& heartbeat);
+
+  void set_sample_period(std::chrono::milliseconds sample_period) { m_sample_period_ms.store(sample_period.count()); }
+
+  // Whether stall reports include a stack trace of the stalled thread (default off, see above)
+  void set_capture_stack_traces(bool capture) { m_capture_stack_traces.store(capture); }
+
+  // Number of stalls reported so far
+  uint64_t get_stall_count() const { return m_stall_count.load(); } // NOLINT(build/unsigned)
+
+  /**
+   * @brief Iteration counts and rates of the watched heartbeats, keyed by name
+   */
+  nlohmann::json snapshot();
+
+  /**
+   * @brief Take a stack trace of a thread of this process
+   * @return One frame per line, or an empty string if it could not be taken
+   */
+  static std::string capture_stack_trace(pid_t tid);
+
+private:
+  struct Watched
+  {
+    std::weak_ptr<Heartbeat> heartbeat;
+    uint64_t last_count{ 0 }; // NOLINT(build/unsigned)
+    std::chrono::steady_clock::time_point last_change;
+    std::chrono::steady_clock::time_point last_sample;
+    double rate_hz{ 0. };
+    bool was_active{ false };
+    bool stalled{ false };
+  };
+
+  void sample();
+
+  std::mutex m_mutex;
+  std::vector<Watched> m_watched;
+  std::atomic<int64_t> m_sample_period_ms;
+  std::atomic<bool> m_capture_stack_traces{ false };
+  std::atomic<uint64_t> m_stall_count{ 0 }; // NOLINT(build/unsigned)
+  std::unique_ptr<WorkerThread> m_thread;
+};
+
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_WATCHDOG_HPP_
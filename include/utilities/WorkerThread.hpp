@@ -1,12 +1,12 @@
 /**
  * @file WorkerThread.hpp WorkerThread class declarations
  *
- * WorkerThread defines a std::thread which runs the do_work()
+ * WorkerThread defines a thread which runs the do_work()
  * function as well as methods to start and stop that thread.
  * This file is intended to help reduce code duplication for the common
- * task of starting and stopping threads. As in artdaq, std::thread may
- * be replaced by boost::thread to allow setting the stack size at a
- * later date if that functionality is found to be necessary.
+ * task of starting and stopping threads. The thread is created with
+ * pthread_create so that its scheduling policy, priority, affinity and
+ * stack can be chosen with ThreadAttributes.
  *
  * This is part of the DUNE DAQ Application Framework, copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -16,9 +16,18 @@
 #ifndef UTILITIES_INCLUDE_UTILITIES_WORKERTHREAD_HPP_
 #define UTILITIES_INCLUDE_UTILITIES_WORKERTHREAD_HPP_
 
+#include "utilities/CpuTopology.hpp"
+#include "utilities/PeriodicTimer.hpp"
+#include "utilities/StopToken.hpp"
+#include "utilities/ThreadAttributes.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+#include "utilities/Watchdog.hpp"
+
 #include "ers/ers.hpp"
 #include "logging/Logging.hpp" // NOTE: if ISSUES ARE DECLARED BEFORE include logging/Logging.hpp, TLOG_DEBUG<<issue wont work.
 
+#include <pthread.h>
+
 #include <functional>
 #include <future>
 #include <list>
@@ -42,7 +51,7 @@ namespace utilities {
  * @brief WorkerThread contains a thread which runs the do_work()
  * function
  *
- * WorkerThread runs a given function in a std::thread and allows that
+ * WorkerThread runs a given function in a thread and allows that
  * work function to be started and stopped via the
  * start_working_thread() and stop_working_thread() methods,
  * respectively. The work function takes a std::atomic<bool>&  which
@@ -71,6 +80,24 @@ namespace utilities {
  *   WorkerThread helper_;
  * };
  * @endcode
+ *
+ * A work function which sleeps or waits between iterations should do so
+ * through a StopToken, so that stop_working_thread() does not have to wait for
+ * the sleep to end. Such a function can take the token directly:
+ *
+ * @code
+ * void do_work(const StopToken& stop){
+ *   while(stop.wait_for(std::chrono::milliseconds(100))){
+ *    // do something ...
+ *   }
+ * }
+ * @endcode
+ *
+ * or an existing std::atomic<bool>& work function can use get_stop_token() on
+ * the WorkerThread which runs it.
+ *
+ * A work loop which calls get_heartbeat().beat() once per iteration can be
+ * watched for stalls by the process-wide Watchdog, see set_stall_threshold().
  */
 class WorkerThread
 {
@@ -83,13 +110,45 @@ public:
    */
   explicit WorkerThread(std::function<void(std::atomic<bool>&)> do_work);
 
+  /**
+   * @brief WorkerThread Constructor for a work function using a StopToken
+   * @param do_work Function to be executed in the thread
+   */
+  explicit WorkerThread(std::function<void(const StopToken&)> do_work);
+
+  /**
+   * @brief WorkerThread Constructor for a function run at a fixed rate
+   * @param options Period, spinning and missed-tick policy (see PeriodicTimer.hpp)
+   * @param do_tick Function to be executed at each tick
+   *
+   * The thread beats its heartbeat at each tick, and keeps the lateness of the
+   * ticks in get_periodic_stats().
+   */
+  WorkerThread(const PeriodicOptions& options, std::function<void(const PeriodicTick&)> do_tick);
+
+  /**
+   * @brief WorkerThread Destructor
+   *
+   * Like std::thread, terminates the program if the thread was started but not stopped
+   */
+  ~WorkerThread();
+
   /**
    * @brief Start the working thread (which executes the do_work() function)
+   * @param name Name of the thread (at most 15 characters)
+   * @param attributes Scheduling, affinity and stack options. Options which
+   * cannot be applied are reported as ThreadingIssue warnings and left at
+   * their defaults.
    * @throws ThreadingIssue if the thread is already running
+   * @throws ThreadingIssue if the thread cannot be created
    */
-  void start_working_thread(const std::string& name = "noname");
+  void start_working_thread(const std::string& name = "noname",
+                            const ThreadAttributes& attributes = ThreadAttributes());
   /**
    * @brief Stop the working thread
+   *
+   * Waits through the thread's StopToken return at once. The caller must not
+   * hold a mutex which the work function passes to StopToken::wait.
    * @throws ThreadingIssue If the thread has not yet been started
    * @throws ThreadingIssue If the thread is not in the joinable state
    * @throws ThreadingIssue If an exception occurs during thread join
@@ -102,6 +161,46 @@ public:
    */
   bool thread_running() const { return m_thread_running.load(); }
 
+  /**
+   * @brief Get the token which is signalled by stop_working_thread()
+   *
+   * It is re-armed by each start_working_thread(), and remains valid as long as
+   * the WorkerThread exists.
+   */
+  StopToken get_stop_token() { return StopToken(m_stop_state); }
+
+  /**
+   * @brief Set where the working thread runs and allocates memory (see CpuTopology.hpp)
+   *
+   * The placement is applied by the thread itself each time it is started. If
+   * the thread is already running its affinity is changed at once; its memory
+   * policy only changes at the next start.
+   */
+  void set_placement(const ThreadPlacement& placement);
+
+  const ThreadPlacement& get_placement() const { return m_placement; }
+
+  /**
+   * @brief The heartbeat the work function should beat once per iteration
+   *
+   * It is named after the thread, and replaced when the thread is restarted
+   * under another name, so fetch it again at the start of each run.
+   */
+  Heartbeat& get_heartbeat() { return *m_heartbeat; }
+
+  /**
+   * @brief Have the Watchdog report the thread if it does not beat for this long
+   *
+   * Takes effect at the next start; zero (the default) disables the check.
+   */
+  void set_stall_threshold(std::chrono::milliseconds threshold);
+
+  /**
+   * @brief Tick statistics of a periodic WorkerThread
+   * @return nullptr if the thread is not periodic
+   */
+  const PeriodicStats* get_periodic_stats() const { return m_periodic_stats.get(); }
+
   WorkerThread(const WorkerThread&) = delete;            ///< WorkerThread is not copy-constructible
   WorkerThread& operator=(const WorkerThread&) = delete; ///< WorkerThread is not copy-assginable
   WorkerThread(WorkerThread&&) = delete;                 ///< WorkerThread is not move-constructible
@@ -109,8 +208,15 @@ public:
 
 private:
   std::atomic<bool> m_thread_running;
-  std::unique_ptr<std::thread> m_working_thread;
+  pthread_t m_working_thread{};
+  bool m_joinable{ false };
   std::function<void(std::atomic<bool>&)> m_do_work;
+  StopState m_stop_state;
+  ThreadPlacement m_placement;
+  std::shared_ptr<ThreadStats> m_stats; ///< Only if telemetry was enabled at start
+  std::shared_ptr<Heartbeat> m_heartbeat;
+  std::chrono::milliseconds m_stall_threshold{ 0 };
+  std::unique_ptr<PeriodicStats> m_periodic_stats;
 };
 } // namespace utilities
 
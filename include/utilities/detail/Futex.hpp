@@ -0,0 +1,95 @@
+/**
+ * @file Futex.hpp Thin wrappers around the Linux futex system call and the CPU pause hint
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+#ifndef UTILITIES_INCLUDE_UTILITIES_DETAIL_FUTEX_HPP_
+#define UTILITIES_INCLUDE_UTILITIES_DETAIL_FUTEX_HPP_
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+namespace dunedaq {
+namespace utilities {
+namespace detail {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+/**
+ * Sleep until word is woken, as long as it still holds expected. May return
+ * spuriously; callers re-check their condition. timeout is relative.
+ */
+inline void
+futex_wait(std::atomic<uint32_t>& word, uint32_t expected, const struct timespec* timeout = nullptr) // NOLINT
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0); // NOLINT
+}
+
+/**
+ * As futex_wait, but deadline is an absolute CLOCK_MONOTONIC time (the clock
+ * of std::chrono::steady_clock), so the sleep does not drift with the time
+ * spent computing it.
+ */
+inline void
+futex_wait_until(std::atomic<uint32_t>& word, uint32_t expected, const struct timespec* deadline) // NOLINT
+{
+  syscall(SYS_futex, // NOLINT
+          reinterpret_cast<uint32_t*>(&word),
+          FUTEX_WAIT_BITSET_PRIVATE,
+          expected,
+          deadline,
+          nullptr,
+          FUTEX_BITSET_MATCH_ANY);
+}
+
+/**
+ * As futex_wait_until, with a steady_clock deadline; time_point::max() waits
+ * without a timeout.
+ */
+inline void
+futex_wait_until(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::steady_clock::time_point deadline) // NOLINT
+{
+  if (deadline == std::chrono::steady_clock::time_point::max()) {
+    futex_wait_until(word, expected, nullptr);
+    return;
+  }
+  auto deadline_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+  struct timespec absolute;
+  absolute.tv_sec = static_cast<time_t>(deadline_ns / 1000000000);
+  absolute.tv_nsec = static_cast<long>(deadline_ns % 1000000000); // NOLINT(runtime/int)
+  futex_wait_until(word, expected, &absolute);
+}
+
+inline void
+futex_wake(std::atomic<uint32_t>& word, int count = INT_MAX)
+{
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0); // NOLINT
+}
+
+/**
+ * Tell the CPU we are busy-waiting (reduces power and pipeline flushes on x86)
+ */
+inline void
+cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+} // namespace detail
+} // namespace utilities
+} // namespace dunedaq
+
+#endif // UTILITIES_INCLUDE_UTILITIES_DETAIL_FUTEX_HPP_
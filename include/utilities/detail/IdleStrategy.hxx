@@ -0,0 +1,101 @@
+#include "utilities/detail/Futex.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename Ready>
+bool
+IdleStrategy::wait(const StopToken& stop, Ready ready)
+{
+  if (ready()) {
+    return true;
+  }
+  m_stats.record_wait();
+
+  // The clock is only read when the phase changes
+  auto phase = IdlePhase::kSpin;
+  auto phase_start = std::chrono::steady_clock::now();
+  auto enter = [&](IdlePhase next) {
+    if (next != phase) {
+      auto now = std::chrono::steady_clock::now();
+      m_stats.record_phase(phase, (now - phase_start).count());
+      phase = next;
+      phase_start = now;
+    }
+  };
+
+  bool is_ready = false;
+  switch (m_options.mode) {
+    case IdleMode::kSpin:
+      while (!(is_ready = ready()) && !stop.stop_requested()) {
+        detail::cpu_relax();
+      }
+      break;
+
+    case IdleMode::kBackoff: {
+      uint32_t pauses = 1; // NOLINT(build/unsigned)
+      std::chrono::nanoseconds sleep = std::chrono::microseconds(1);
+      while (!(is_ready = ready()) && !stop.stop_requested()) {
+        if (pauses <= m_options.max_pauses) {
+          for (uint32_t ii = 0; ii < pauses; ++ii) { // NOLINT(build/unsigned)
+            detail::cpu_relax();
+          }
+          pauses *= 2;
+        } else {
+          enter(IdlePhase::kSleep);
+          stop.wait_for(sleep);
+          sleep = std::min(sleep * 2, m_options.sleep);
+        }
+      }
+      break;
+    }
+
+    case IdleMode::kLadder: {
+      uint32_t polls = 0; // NOLINT(build/unsigned)
+      while (!(is_ready = ready()) && !stop.stop_requested()) {
+        ++polls;
+        if (polls < m_options.spin_polls) {
+          detail::cpu_relax();
+        } else if (polls < m_options.spin_polls + m_options.yield_polls) {
+          enter(IdlePhase::kYield);
+          std::this_thread::yield();
+        } else {
+          enter(IdlePhase::kSleep);
+          stop.wait_for(m_options.sleep);
+        }
+      }
+      break;
+    }
+
+    case IdleMode::kPark: {
+      uint32_t polls = 0; // NOLINT(build/unsigned)
+      while (!(is_ready = ready()) && !stop.stop_requested()) {
+        if (++polls < m_options.spin_polls) {
+          detail::cpu_relax();
+          continue;
+        }
+        // Announcing that we are parked before re-checking pairs with wake(),
+        // which fences before checking for a parked waiter: either it sees us
+        // parked and bumps the counter, or we see ready() hold.
+        enter(IdlePhase::kPark);
+        m_parked.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto wake_counter = m_wake_counter.load(std::memory_order_relaxed);
+        if (!ready()) {
+          stop.park(m_wake_counter, wake_counter);
+        }
+      }
+      m_parked.store(false, std::memory_order_relaxed);
+      break;
+    }
+  }
+
+  m_stats.record_phase(phase, (std::chrono::steady_clock::now() - phase_start).count());
+  return is_ready;
+}
+
+} // namespace utilities
+} // namespace dunedaq
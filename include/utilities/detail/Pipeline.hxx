@@ -0,0 +1,214 @@
+#include "utilities/detail/Futex.hpp"
+
+#include <thread>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+template<typename T>
+Pipeline<T>::Pipeline(const std::string& name)
+  : m_name(name)
+{}
+
+template<typename T>
+Pipeline<T>::~Pipeline()
+{
+  if (m_running) {
+    stop(StopMode::kAbandon);
+  }
+}
+
+template<typename T>
+void
+Pipeline<T>::add_stage(const std::string& name, StageFunction function, const StageConfig& config)
+{
+  if (m_running) {
+    throw ThreadingIssue(ERS_HERE, "Attempted to add stage " + name + " to running pipeline " + m_name);
+  }
+  m_stages.emplace_back(std::make_unique<Stage>(name, function, config));
+  if (m_stages.size() > 1) {
+    m_stages[m_stages.size() - 2]->next = m_stages.back().get();
+  }
+}
+
+template<typename T>
+void
+Pipeline<T>::start()
+{
+  if (m_running) {
+    throw ThreadingIssue(ERS_HERE, "Attempted to start pipeline " + m_name + " when it is already running!");
+  }
+  if (m_stages.empty()) {
+    throw ThreadingIssue(ERS_HERE, "Attempted to start pipeline " + m_name + " which has no stages");
+  }
+  m_start_time = std::chrono::steady_clock::now();
+  // Consumers first, so that nothing waits on a stage which is not running yet
+  for (auto stage = m_stages.rbegin(); stage != m_stages.rend(); ++stage) {
+    (*stage)->abandon = false;
+    (*stage)->thread.start_working_thread((*stage)->name, (*stage)->config.attributes);
+  }
+  m_running = true;
+}
+
+template<typename T>
+void
+Pipeline<T>::stop(StopMode mode)
+{
+  if (!m_running) {
+    throw ThreadingIssue(ERS_HERE, "Attempted to stop pipeline " + m_name + " when it is not running!");
+  }
+  // Producers blocked on a full ring give up once its consumer abandons
+  if (mode == StopMode::kAbandon) {
+    for (auto& stage : m_stages) {
+      stage->abandon = true;
+    }
+  }
+  // A draining stage exits once its input is empty, which is final once the
+  // stage feeding it has been joined
+  for (auto& stage : m_stages) {
+    stage->thread.stop_working_thread();
+  }
+  if (mode == StopMode::kAbandon) {
+    T item;
+    for (auto& stage : m_stages) {
+      uint64_t abandoned = 0; // NOLINT(build/unsigned)
+      while (stage->input.try_pop(item)) {
+        ++abandoned;
+      }
+      stage->stats.record_abandoned(abandoned);
+    }
+  }
+  m_stop_time = std::chrono::steady_clock::now();
+  m_running = false;
+}
+
+template<typename T>
+size_t
+Pipeline<T>::push_batch(T* items, size_t count)
+{
+  if (!m_running) {
+    return 0;
+  }
+  return m_stages.front()->accept(items, count);
+}
+
+template<typename T>
+nlohmann::json
+Pipeline<T>::get_stats() const
+{
+  auto elapsed = (m_running ? std::chrono::steady_clock::now() : m_stop_time) - m_start_time;
+  nlohmann::json stats = nlohmann::json::array();
+  for (auto const& stage : m_stages) {
+    auto stage_stats = stage->stats.to_json(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+    stage_stats["name"] = stage->name;
+    stage_stats["occupancy"] = stage->input.size();
+    stage_stats["capacity"] = stage->input.capacity();
+    stage_stats["idle"] = stage->idle.get_stats().to_json();
+    stats.push_back(stage_stats);
+  }
+  return stats;
+}
+
+template<typename T>
+Pipeline<T>::Stage::Stage(const std::string& stage_name, StageFunction stage_function, const StageConfig& stage_config)
+  : name(stage_name)
+  , function(stage_function)
+  , config(stage_config)
+  , input(stage_config.capacity)
+  , idle(stage_config.idle)
+  , thread([this](const StopToken& stop) { do_work(stop); })
+{
+  if (config.batch_size == 0) {
+    config.batch_size = 1;
+  }
+  thread.set_stall_threshold(config.stall_threshold);
+}
+
+template<typename T>
+size_t
+Pipeline<T>::Stage::accept(T* items, size_t count)
+{
+  size_t pushed = input.try_push_batch(items, count);
+  if (pushed < count) {
+    switch (config.back_pressure) {
+      case BackPressure::kDropNewest:
+        stats.record_dropped(count - pushed);
+        break;
+      case BackPressure::kDropOldest: {
+        uint64_t dropped = 0; // NOLINT(build/unsigned)
+        while (pushed < count) {
+          // The consumer may empty the ring first, then there is nothing to evict
+          if (input.try_evict_oldest()) {
+            ++dropped;
+          }
+          pushed += input.try_push_batch(items + pushed, count - pushed);
+        }
+        stats.record_dropped(dropped);
+        break;
+      }
+      case BackPressure::kBlock: {
+        auto start = std::chrono::steady_clock::now();
+        size_t spins = 0;
+        while (pushed < count) {
+          if (abandon.load(std::memory_order_relaxed)) {
+            stats.record_abandoned(count - pushed);
+            break;
+          }
+          if (++spins < 64) {
+            detail::cpu_relax();
+          } else {
+            std::this_thread::yield();
+          }
+          pushed += input.try_push_batch(items + pushed, count - pushed);
+        }
+        stats.record_blocked((std::chrono::steady_clock::now() - start).count());
+        break;
+      }
+    }
+  }
+  if (pushed > 0) {
+    idle.wake();
+  }
+  stats.record_occupancy(input.size());
+  return pushed;
+}
+
+template<typename T>
+void
+Pipeline<T>::Stage::do_work(const StopToken& stop)
+{
+  std::vector<T> batch(config.batch_size);
+  auto& heartbeat = thread.get_heartbeat();
+  while (!(abandon.load(std::memory_order_relaxed) && stop.stop_requested())) {
+    heartbeat.beat();
+    auto count = input.try_pop_batch(batch.data(), batch.size());
+    if (count == 0) {
+      if (stop.stop_requested()) {
+        break; // Drained
+      }
+      // Waiting for input is not a stall, however long it takes
+      heartbeat.set_active(false);
+      idle.wait(stop, [this]() { return input.size() > 0; });
+      heartbeat.set_active(true);
+      continue;
+    }
+
+    size_t kept = 0;
+    for (size_t ii = 0; ii < count; ++ii) {
+      if (function(batch[ii])) {
+        if (kept != ii) {
+          batch[kept] = std::move(batch[ii]);
+        }
+        ++kept;
+      }
+    }
+    if (next != nullptr && kept > 0) {
+      kept = next->accept(batch.data(), kept);
+    }
+    stats.record_batch(count, kept);
+  }
+}
+
+} // namespace utilities
+} // namespace dunedaq
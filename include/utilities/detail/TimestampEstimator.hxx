@@ -1,5 +1,7 @@
 #include "logging/Logging.hpp"
 
+#include <limits>
+
 namespace dunedaq {
 namespace utilities {
 
@@ -13,10 +15,35 @@ void TimestampEstimator::timesync_callback(const T& tsync)
   if (tsync.run_number == m_run_number && tsync.source_pid != m_current_process_id) {
     add_timestamp_datapoint(tsync.daq_time, tsync.system_time);
   } else {
+    ++m_discarded_timesync_count;
     TLOG_DEBUG(0) << "Discarded TimeSync message from run " << tsync.run_number << " during run "
                   << m_run_number << " with pid " << tsync.source_pid << " and timestamp " << tsync.daq_time;
   }
 }
 
+template <class T>
+void TimestampEstimator::timesync_batch_callback(const T* tsyncs, size_t count)
+{
+  const T* newest = nullptr;
+  uint64_t discarded = 0; // NOLINT(build/unsigned)
+  for (size_t ii = 0; ii < count; ++ii) {
+    const T& tsync = tsyncs[ii];
+    if (tsync.run_number != m_run_number || tsync.source_pid == m_current_process_id ||
+        tsync.daq_time == std::numeric_limits<uint64_t>::max()) {
+      ++discarded;
+    } else if (newest == nullptr || tsync.daq_time > newest->daq_time) {
+      newest = &tsync;
+    }
+  }
+  m_received_timesync_count += count;
+  m_discarded_timesync_count += discarded;
+  TLOG_DEBUG(TLVL_TIME_SYNC_PROPERTIES) << "Got " << count << " TimeSyncs, discarded " << discarded
+                                        << " from another run than " << m_run_number
+                                        << ", from this process or without a valid timestamp";
+  if (newest != nullptr) {
+    add_timestamp_datapoint(newest->daq_time, newest->system_time);
+  }
+}
+
 }
 }
@@ -0,0 +1,409 @@
+/**
+ *
+ * @file CpuTopology.cpp CpuTopology implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/CpuTopology.hpp"
+#include "utilities/WorkerThread.hpp" // contains exception definition
+
+#include "logging/Logging.hpp"
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <regex>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+
+// First line of a sysfs file, or empty if it cannot be read
+std::string
+read_line(const std::filesystem::path& path)
+{
+  std::ifstream file(path);
+  std::string line;
+  std::getline(file, line);
+  return line;
+}
+
+int
+read_int(const std::filesystem::path& path, int fallback)
+{
+  auto line = read_line(path);
+  try {
+    return line.empty() ? fallback : std::stoi(line);
+  } catch (std::exception const&) {
+    return fallback;
+  }
+}
+
+// Numbers of the entries of dir named prefix<N>
+std::vector<int>
+numbered_entries(const std::filesystem::path& dir, const std::string& prefix)
+{
+  std::vector<int> numbers;
+  std::error_code ec;
+  const std::regex pattern(prefix + "([0-9]+)");
+  for (auto const& entry : std::filesystem::directory_iterator(dir, ec)) {
+    std::smatch match;
+    auto name = entry.path().filename().string();
+    if (std::regex_match(name, match, pattern)) {
+      numbers.push_back(std::stoi(match[1]));
+    }
+  }
+  std::sort(numbers.begin(), numbers.end());
+  return numbers;
+}
+
+int
+to_mpol_mode(MemoryPolicy policy)
+{
+  switch (policy) {
+    case MemoryPolicy::kPreferred:
+      return MPOL_PREFERRED;
+    case MemoryPolicy::kBind:
+      return MPOL_BIND;
+    default:
+      return MPOL_DEFAULT;
+  }
+}
+
+constexpr size_t kMaxNodes = 1024;
+using NodeMask = unsigned long[kMaxNodes / (8 * sizeof(unsigned long))]; // NOLINT(runtime/int)
+
+} // namespace
+
+std::vector<int>
+CpuTopology::parse_cpu_list(const std::string& list)
+{
+  std::vector<int> cpus;
+  size_t start = 0;
+  while (start < list.size()) {
+    auto end = list.find(',', start);
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    auto range = list.substr(start, end - start);
+    range.erase(0, range.find_first_not_of(" \t\n"));
+    range.erase(range.find_last_not_of(" \t\n") + 1);
+    if (!range.empty()) {
+      try {
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+          cpus.push_back(cpu);
+        }
+      } catch (std::exception const&) {
+        // Ignore malformed ranges
+      }
+    }
+    start = end + 1;
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+CpuTopology
+CpuTopology::discover(const std::string& sysfs_root)
+{
+  CpuTopology topology;
+  topology.m_sysfs_root = sysfs_root;
+  auto cpu_dir = std::filesystem::path(sysfs_root) / "devices" / "system" / "cpu";
+  auto node_dir = std::filesystem::path(sysfs_root) / "devices" / "system" / "node";
+
+  auto online = parse_cpu_list(read_line(cpu_dir / "online"));
+  if (online.empty()) {
+    // Fall back to the cpuN directories, skipping those marked offline
+    for (auto cpu : numbered_entries(cpu_dir, "cpu")) {
+      if (read_int(cpu_dir / ("cpu" + std::to_string(cpu)) / "online", 1) != 0) {
+        online.push_back(cpu);
+      }
+    }
+  }
+  if (online.empty()) {
+    throw CpuTopologyError(ERS_HERE, cpu_dir.string(), "no online CPUs found");
+  }
+
+  std::map<int, int> node_of_cpu;
+  for (auto node : numbered_entries(node_dir, "node")) {
+    auto cpus = parse_cpu_list(read_line(node_dir / ("node" + std::to_string(node)) / "cpulist"));
+    for (auto cpu : cpus) {
+      node_of_cpu[cpu] = node;
+    }
+    topology.m_numa_nodes[node];
+  }
+
+  for (auto cpu : online) {
+    auto dir = cpu_dir / ("cpu" + std::to_string(cpu));
+    CpuInfo info{ cpu, -1, -1, -1, -1 };
+    info.core_id = read_int(dir / "topology" / "core_id", -1);
+    info.package_id = read_int(dir / "topology" / "physical_package_id", -1);
+    auto node = node_of_cpu.find(cpu);
+    if (node != node_of_cpu.end()) {
+      info.numa_node = node->second;
+      topology.m_numa_nodes[node->second].push_back(cpu);
+    }
+    for (auto index : numbered_entries(dir / "cache", "index")) {
+      auto cache_dir = dir / "cache" / ("index" + std::to_string(index));
+      if (read_int(cache_dir / "level", 0) == 3) {
+        auto shared = parse_cpu_list(read_line(cache_dir / "shared_cpu_list"));
+        info.l3_id = shared.empty() ? cpu : shared.front();
+      }
+    }
+    topology.m_cpus.push_back(info);
+  }
+
+  TLOG_DEBUG(16) << "Read topology of " << topology.m_cpus.size() << " CPUs in " << topology.m_numa_nodes.size()
+                 << " NUMA nodes from " << sysfs_root;
+  return topology;
+}
+
+const CpuTopology&
+CpuTopology::system()
+{
+  static const CpuTopology s_topology = discover();
+  return s_topology;
+}
+
+const CpuInfo*
+CpuTopology::get_cpu(int cpu) const
+{
+  auto found = std::lower_bound(
+    m_cpus.begin(), m_cpus.end(), cpu, [](const CpuInfo& info, int value) { return info.cpu < value; });
+  return found != m_cpus.end() && found->cpu == cpu ? &*found : nullptr;
+}
+
+std::vector<int>
+CpuTopology::get_numa_nodes() const
+{
+  std::vector<int> nodes;
+  for (auto const& node : m_numa_nodes) {
+    nodes.push_back(node.first);
+  }
+  return nodes;
+}
+
+std::vector<int>
+CpuTopology::get_cpus_in_numa_node(int node) const
+{
+  auto found = m_numa_nodes.find(node);
+  return found == m_numa_nodes.end() ? std::vector<int>() : found->second;
+}
+
+std::vector<std::vector<int>>
+CpuTopology::get_l3_groups() const
+{
+  std::map<int, std::vector<int>> groups;
+  for (auto const& info : m_cpus) {
+    if (info.l3_id >= 0) {
+      groups[info.l3_id].push_back(info.cpu);
+    }
+  }
+  std::vector<std::vector<int>> result;
+  for (auto& group : groups) {
+    result.push_back(std::move(group.second));
+  }
+  return result;
+}
+
+std::vector<int>
+CpuTopology::get_cpus_sharing_l3(int cpu) const
+{
+  auto info = get_cpu(cpu);
+  if (info == nullptr || info->l3_id < 0) {
+    return {};
+  }
+  std::vector<int> cpus;
+  for (auto const& other : m_cpus) {
+    if (other.l3_id == info->l3_id) {
+      cpus.push_back(other.cpu);
+    }
+  }
+  return cpus;
+}
+
+std::vector<int>
+CpuTopology::get_core_siblings(int cpu) const
+{
+  auto info = get_cpu(cpu);
+  if (info == nullptr) {
+    return {};
+  }
+  std::vector<int> cpus;
+  for (auto const& other : m_cpus) {
+    if (other.package_id == info->package_id && other.core_id == info->core_id) {
+      cpus.push_back(other.cpu);
+    }
+  }
+  return cpus;
+}
+
+int
+CpuTopology::get_pci_numa_node(const std::string& pci_address) const
+{
+  return read_int(std::filesystem::path(m_sysfs_root) / "bus" / "pci" / "devices" / pci_address / "numa_node", -1);
+}
+
+std::vector<int>
+CpuTopology::get_pci_local_cpus(const std::string& pci_address) const
+{
+  auto device_dir = std::filesystem::path(m_sysfs_root) / "bus" / "pci" / "devices" / pci_address;
+  std::error_code ec;
+  if (!std::filesystem::exists(device_dir, ec)) {
+    return {};
+  }
+
+  std::vector<int> cpus;
+  for (auto cpu : parse_cpu_list(read_line(device_dir / "local_cpulist"))) {
+    if (get_cpu(cpu) != nullptr) {
+      cpus.push_back(cpu);
+    }
+  }
+  if (cpus.empty()) {
+    cpus = get_cpus_in_numa_node(get_pci_numa_node(pci_address));
+  }
+  return cpus;
+}
+
+ThreadPlacement
+placement_for_numa_node(int node, MemoryPolicy memory_policy, const CpuTopology& topology)
+{
+  ThreadPlacement placement;
+  placement.cpus = topology.get_cpus_in_numa_node(node);
+  if (placement.cpus.empty()) {
+    ers::warning(ThreadingIssue(ERS_HERE, "NUMA node " + std::to_string(node) + " has no online CPUs"));
+  }
+  placement.memory_node = node;
+  placement.memory_policy = memory_policy;
+  return placement;
+}
+
+ThreadPlacement
+placement_for_pci_device(const std::string& pci_address, MemoryPolicy memory_policy, const CpuTopology& topology)
+{
+  ThreadPlacement placement;
+  placement.cpus = topology.get_pci_local_cpus(pci_address);
+  if (placement.cpus.empty()) {
+    ers::warning(ThreadingIssue(ERS_HERE, "No CPUs found close to PCI device " + pci_address));
+  }
+  placement.memory_node = topology.get_pci_numa_node(pci_address);
+  placement.memory_policy = placement.memory_node >= 0 ? memory_policy : MemoryPolicy::kNone;
+  return placement;
+}
+
+ThreadPlacement
+placement_for_l3_group(int cpu, const CpuTopology& topology)
+{
+  ThreadPlacement placement;
+  placement.cpus = topology.get_cpus_sharing_l3(cpu);
+  if (placement.cpus.empty() && topology.get_cpu(cpu) != nullptr) {
+    placement.cpus = { cpu };
+  }
+  return placement;
+}
+
+bool
+set_thread_affinity(pthread_t handle, const std::vector<int>& cpus)
+{
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (auto cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpuset);
+    }
+  }
+  if (CPU_COUNT(&cpuset) == 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, "Not setting CPU affinity to an empty set of CPUs"));
+    return false;
+  }
+
+  int rc = pthread_setaffinity_np(handle, sizeof(cpu_set_t), &cpuset);
+  if (rc != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, "Error calling pthread_setaffinity_np: " + std::to_string(rc)));
+    return false;
+  }
+  return true;
+}
+
+bool
+set_memory_policy(MemoryPolicy policy, int node)
+{
+  if (policy == MemoryPolicy::kNone) {
+    return true;
+  }
+
+  NodeMask mask = {};
+  bool with_node = policy != MemoryPolicy::kDefault;
+  if (with_node) {
+    if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+      ers::warning(ThreadingIssue(ERS_HERE, "Invalid NUMA node " + std::to_string(node) + " for memory policy"));
+      return false;
+    }
+    mask[node / (8 * sizeof(mask[0]))] |= 1UL << (node % (8 * sizeof(mask[0])));
+  }
+
+  if (syscall(SYS_set_mempolicy, to_mpol_mode(policy), with_node ? mask : nullptr, with_node ? kMaxNodes : 0) != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, std::string("Error calling set_mempolicy: ") + std::strerror(errno)));
+    return false;
+  }
+  return true;
+}
+
+bool
+bind_memory(void* address, size_t length, MemoryPolicy policy, int node)
+{
+  if (policy == MemoryPolicy::kNone) {
+    return true;
+  }
+
+  NodeMask mask = {};
+  bool with_node = policy != MemoryPolicy::kDefault;
+  if (with_node) {
+    if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+      ers::warning(ThreadingIssue(ERS_HERE, "Invalid NUMA node " + std::to_string(node) + " for memory binding"));
+      return false;
+    }
+    mask[node / (8 * sizeof(mask[0]))] |= 1UL << (node % (8 * sizeof(mask[0])));
+  }
+
+  // MPOL_MF_MOVE also migrates pages already touched by the wrong node
+  if (syscall(SYS_mbind,
+              address,
+              length,
+              to_mpol_mode(policy),
+              with_node ? mask : nullptr,
+              with_node ? kMaxNodes : 0,
+              MPOL_MF_MOVE) != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, std::string("Error calling mbind: ") + std::strerror(errno)));
+    return false;
+  }
+  return true;
+}
+
+bool
+apply_placement_to_current_thread(const ThreadPlacement& placement)
+{
+  bool ok = true;
+  if (!placement.cpus.empty()) {
+    ok = set_thread_affinity(pthread_self(), placement.cpus);
+  }
+  return set_memory_policy(placement.memory_policy, placement.memory_node) && ok;
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,118 @@
+/**
+ * @file DriftEstimator.cpp DriftEstimator implementation
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/DriftEstimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace dunedaq {
+namespace utilities {
+
+DriftEstimator::DriftEstimator(uint64_t nominal_frequency_hz, size_t window) // NOLINT(build/unsigned)
+  : m_nominal_ticks_per_us(static_cast<double>(nominal_frequency_hz) / 1e6)
+  , m_ticks_per_us(m_nominal_ticks_per_us)
+{
+  reset(window);
+}
+
+void
+DriftEstimator::reset(size_t window)
+{
+  m_samples.assign(std::max<size_t>(window, 1), Sample{ 0, 0 });
+  m_next = 0;
+  m_count = 0;
+  m_offset = 0.;
+  m_ticks_per_us = m_nominal_ticks_per_us;
+  m_residual_rms_ticks = 0.;
+  m_interval_us = 0.;
+}
+
+bool
+DriftEstimator::add(uint64_t daq_time, uint64_t system_time_us) // NOLINT(build/unsigned)
+{
+  if (m_count > 0) {
+    if (daq_time <= m_reference.daq_time) {
+      return false;
+    }
+    // Differences are taken in signed arithmetic, as the prediction may be either side
+    auto residual = static_cast<double>(static_cast<int64_t>(daq_time - predict(system_time_us)));
+    if (std::fabs(residual) > s_max_residual_seconds * m_nominal_ticks_per_us * 1e6) {
+      reset(m_samples.size());
+    }
+  }
+
+  m_samples[m_next] = Sample{ daq_time, system_time_us };
+  m_next = (m_next + 1) % m_samples.size();
+  m_count = std::min(m_count + 1, m_samples.size());
+  m_reference = Sample{ daq_time, system_time_us };
+  fit();
+  return true;
+}
+
+uint64_t // NOLINT(build/unsigned)
+DriftEstimator::predict(uint64_t system_time_us) const // NOLINT(build/unsigned)
+{
+  auto elapsed_us = static_cast<double>(static_cast<int64_t>(system_time_us - m_reference.system_time_us));
+  return m_reference.daq_time + static_cast<uint64_t>(std::llround(m_offset + m_ticks_per_us * elapsed_us)); // NOLINT
+}
+
+void
+DriftEstimator::fit()
+{
+  if (m_count < 2) {
+    m_offset = 0.;
+    m_ticks_per_us = m_nominal_ticks_per_us;
+    m_residual_rms_ticks = 0.;
+    m_interval_us = 0.;
+    return;
+  }
+
+  // The oldest pair is the next one to be overwritten once the window is full
+  auto const& oldest = m_samples[m_count < m_samples.size() ? 0 : m_next];
+  m_interval_us = static_cast<double>(m_reference.system_time_us - oldest.system_time_us) /
+                  static_cast<double>(m_count - 1);
+
+  // Relative to the latest pair, so that the doubles keep their precision
+  double mean_x = 0.;
+  double mean_y = 0.;
+  for (size_t ii = 0; ii < m_count; ++ii) {
+    mean_x += static_cast<double>(static_cast<int64_t>(m_samples[ii].system_time_us - m_reference.system_time_us));
+    mean_y += static_cast<double>(static_cast<int64_t>(m_samples[ii].daq_time - m_reference.daq_time));
+  }
+  mean_x /= static_cast<double>(m_count);
+  mean_y /= static_cast<double>(m_count);
+
+  double sxx = 0.;
+  double sxy = 0.;
+  for (size_t ii = 0; ii < m_count; ++ii) {
+    auto dx =
+      static_cast<double>(static_cast<int64_t>(m_samples[ii].system_time_us - m_reference.system_time_us)) - mean_x;
+    auto dy = static_cast<double>(static_cast<int64_t>(m_samples[ii].daq_time - m_reference.daq_time)) - mean_y;
+    sxx += dx * dx;
+    sxy += dx * dy;
+  }
+
+  m_ticks_per_us = sxx > 0. ? sxy / sxx : m_nominal_ticks_per_us;
+  m_ticks_per_us = std::clamp(m_ticks_per_us,
+                              m_nominal_ticks_per_us * (1. - s_max_drift),
+                              m_nominal_ticks_per_us * (1. + s_max_drift));
+  m_offset = mean_y - m_ticks_per_us * mean_x;
+
+  double sum_squares = 0.;
+  for (size_t ii = 0; ii < m_count; ++ii) {
+    auto x = static_cast<double>(static_cast<int64_t>(m_samples[ii].system_time_us - m_reference.system_time_us));
+    auto y = static_cast<double>(static_cast<int64_t>(m_samples[ii].daq_time - m_reference.daq_time));
+    auto residual = y - (m_offset + m_ticks_per_us * x);
+    sum_squares += residual * residual;
+  }
+  m_residual_rms_ticks = m_count > 2 ? std::sqrt(sum_squares / static_cast<double>(m_count - 2)) : 0.;
+}
+
+} // namespace utilities
+} // namespace dunedaq
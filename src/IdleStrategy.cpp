@@ -0,0 +1,68 @@
+/**
+ * @file IdleStrategy.cpp IdleStrategy and IdleStats implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/IdleStrategy.hpp"
+
+#include "utilities/detail/Futex.hpp"
+
+namespace dunedaq {
+namespace utilities {
+
+std::string
+to_string(IdleMode mode)
+{
+  switch (mode) {
+    case IdleMode::kSpin:
+      return "spin";
+    case IdleMode::kBackoff:
+      return "backoff";
+    case IdleMode::kLadder:
+      return "ladder";
+    case IdleMode::kPark:
+      return "park";
+  }
+  return "unknown";
+}
+
+std::string
+to_string(IdlePhase phase)
+{
+  switch (phase) {
+    case IdlePhase::kSpin:
+      return "spin";
+    case IdlePhase::kYield:
+      return "yield";
+    case IdlePhase::kSleep:
+      return "sleep";
+    case IdlePhase::kPark:
+      return "park";
+  }
+  return "unknown";
+}
+
+nlohmann::json
+IdleStats::to_json() const
+{
+  nlohmann::json stats;
+  stats["waits"] = get_waits();
+  for (size_t ii = 0; ii < s_phases; ++ii) {
+    auto phase = static_cast<IdlePhase>(ii);
+    stats[to_string(phase)] = { { "entries", get_entries(phase) }, { "time_ns", get_time_ns(phase) } };
+  }
+  return stats;
+}
+
+void
+IdleStrategy::unpark()
+{
+  m_wake_counter.fetch_add(1);
+  detail::futex_wake(m_wake_counter, 1);
+}
+
+} // namespace utilities
+} // namespace dunedaq
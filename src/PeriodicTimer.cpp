@@ -0,0 +1,103 @@
+/**
+ * @file PeriodicTimer.cpp PeriodicTimer implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/PeriodicTimer.hpp"
+#include "utilities/WorkerThread.hpp" // contains exception definition
+#include "utilities/detail/Futex.hpp"
+
+#include <sys/prctl.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+nlohmann::json
+PeriodicStats::to_json() const
+{
+  nlohmann::json stats;
+  stats["ticks"] = get_ticks();
+  stats["missed"] = get_missed();
+  stats["lateness"] = m_lateness.to_json();
+  return stats;
+}
+
+PeriodicTimer::PeriodicTimer(const PeriodicOptions& options, PeriodicStats* stats)
+  : m_options(options)
+  , m_stats(stats)
+{
+  if (m_options.period.count() <= 0) {
+    throw ThreadingIssue(ERS_HERE, "PeriodicTimer period must be positive");
+  }
+  if (m_options.minimize_timer_slack && prctl(PR_SET_TIMERSLACK, 1UL, 0UL, 0UL, 0UL) != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, std::string("Could not set the timer slack: ") + std::strerror(errno)));
+  }
+  m_next_deadline = m_options.first_deadline;
+  if (m_next_deadline == std::chrono::steady_clock::time_point()) {
+    m_next_deadline = std::chrono::steady_clock::now() + m_options.period;
+  }
+}
+
+bool
+PeriodicTimer::wait_next(const StopToken& stop, PeriodicTick& tick)
+{
+  auto period = m_options.period;
+  auto now = std::chrono::steady_clock::now();
+
+  // Number of further deadlines which have passed after the next one
+  uint64_t missed = 0; // NOLINT(build/unsigned)
+  if (now >= m_next_deadline + period) {
+    auto behind = static_cast<uint64_t>((now - m_next_deadline) / period); // NOLINT(build/unsigned)
+    switch (m_options.missed_tick_policy) {
+      case MissedTickPolicy::kSkip:
+        // Including the one which is due now, as it is late too
+        missed = behind + 1;
+        break;
+      case MissedTickPolicy::kCoalesce:
+        missed = behind;
+        break;
+      case MissedTickPolicy::kCatchUp:
+        break;
+    }
+    m_next_deadline += period * missed;
+    m_next_index += missed;
+    if (m_stats && missed > 0) {
+      m_stats->record_missed(missed);
+    }
+  }
+
+  auto deadline = m_next_deadline;
+  if (m_options.spin_window.count() > 0) {
+    if (!stop.wait_until(deadline - m_options.spin_window)) {
+      return false;
+    }
+    while (std::chrono::steady_clock::now() < deadline) {
+      if (stop.stop_requested()) {
+        return false;
+      }
+      detail::cpu_relax();
+    }
+  } else if (!stop.wait_until(deadline)) {
+    return false;
+  }
+
+  if (m_stats) {
+    m_stats->record_tick((std::chrono::steady_clock::now() - deadline).count());
+  }
+  tick.index = m_next_index;
+  tick.deadline = deadline;
+  tick.missed = missed;
+  m_next_deadline += period;
+  ++m_next_index;
+  return true;
+}
+
+} // namespace utilities
+} // namespace dunedaq
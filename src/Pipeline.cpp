@@ -0,0 +1,28 @@
+/**
+ * @file Pipeline.cpp StageStats implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Pipeline.hpp"
+
+nlohmann::json
+dunedaq::utilities::StageStats::to_json(std::chrono::nanoseconds elapsed) const
+{
+  nlohmann::json stats;
+  auto items_in = get_items_in();
+  auto seconds = std::chrono::duration<double>(elapsed).count();
+  stats["batches"] = m_batches.load(std::memory_order_relaxed);
+  stats["items_in"] = items_in;
+  stats["items_out"] = get_items_out();
+  stats["dropped"] = get_dropped();
+  stats["abandoned"] = get_abandoned();
+  stats["peak_occupancy"] = get_peak_occupancy();
+  stats["blocked_ns"] = m_blocked_ns.load(std::memory_order_relaxed);
+  stats["items_per_second"] = seconds > 0 ? static_cast<double>(items_in) / seconds : 0.;
+  auto batches = m_batches.load(std::memory_order_relaxed);
+  stats["mean_batch_size"] = batches > 0 ? static_cast<double>(items_in) / static_cast<double>(batches) : 0.;
+  return stats;
+}
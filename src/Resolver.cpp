@@ -8,11 +8,151 @@
  */
 
 #include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
 
-std::vector<std::string>
-dunedaq::utilities::get_ips_from_hostname(std::string hostname)
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+bool
+is_numeric_address(const std::string& hostname)
+{
+  unsigned char buf[sizeof(struct in6_addr)];
+  return inet_pton(AF_INET, hostname.c_str(), buf) == 1 || inet_pton(AF_INET6, hostname.c_str(), buf) == 1;
+}
+
+std::mutex g_nameserver_mutex;
+std::vector<struct sockaddr_in> g_nameservers;
+std::atomic<uint64_t> g_nameserver_generation{ 1 };
+
+/**
+ * Run a DNS query with a per-thread resolver state, honouring any
+ * nameservers given to set_nameservers. retry is the number of attempts and
+ * retrans the per-attempt timeout in seconds. Returns the answer length, or
+ * -1 with h_error set.
+ */
+int
+dns_query(const std::string& name,
+          int type,
+          unsigned char* answer,
+          int answer_length,
+          int retry,
+          int retrans,
+          int& h_error)
+{
+  struct ResolverState
+  {
+    struct __res_state state;
+    uint64_t generation{ 0 };
+    bool initialized{ false };
+    ~ResolverState()
+    {
+      if (initialized)
+        res_nclose(&state);
+    }
+  };
+  thread_local ResolverState resolver;
+
+  auto generation = g_nameserver_generation.load();
+  if (resolver.generation != generation) {
+    if (resolver.initialized)
+      res_nclose(&resolver.state);
+    memset(&resolver.state, 0, sizeof(resolver.state));
+    resolver.initialized = res_ninit(&resolver.state) == 0;
+    resolver.generation = generation;
+
+    std::lock_guard<std::mutex> lk(g_nameserver_mutex);
+    if (resolver.initialized && !g_nameservers.empty()) {
+      resolver.state.nscount = 0;
+      for (auto const& server : g_nameservers) {
+        if (resolver.state.nscount == MAXNS)
+          break;
+        resolver.state.nsaddr_list[resolver.state.nscount++] = server;
+      }
+    }
+  }
+
+  if (!resolver.initialized) {
+    h_error = NO_RECOVERY;
+    return -1;
+  }
+
+  resolver.state.retry = retry;
+  resolver.state.retrans = retrans;
+  auto len = res_nquery(&resolver.state, name.c_str(), ns_c_in, type, answer, answer_length);
+  if (len < 0)
+    h_error = resolver.state.res_h_errno;
+  return len;
+}
+
+/**
+ * Query DNS directly for the A records of hostname and return the smallest TTL in the answer.
+ * This is advisory only (getaddrinfo remains the source of the addresses), so the query is
+ * made with a single attempt to avoid stalling when the name came from /etc/hosts.
+ */
+bool
+query_record_ttl(const std::string& hostname, uint32_t& ttl)
+{
+  unsigned char answer[4096];
+  int h_error = 0;
+  auto len = dns_query(hostname, ns_t_a, answer, sizeof(answer), 1, 1, h_error);
+  if (len < 0)
+    return false;
+
+  ns_msg msg;
+  if (ns_initparse(answer, len, &msg) < 0)
+    return false;
+
+  bool found = false;
+  uint32_t min_ttl = std::numeric_limits<uint32_t>::max();
+  for (int ii = 0; ii < ns_msg_count(msg, ns_s_an); ++ii) {
+    ns_rr rr;
+    if (ns_parserr(&msg, ns_s_an, ii, &rr) < 0)
+      continue;
+    min_ttl = std::min(min_ttl, static_cast<uint32_t>(ns_rr_ttl(rr)));
+    found = true;
+  }
+  if (found)
+    ttl = min_ttl;
+  return found;
+}
+
+/**
+ * Only tcp endpoints naming a host need a lookup: the * wildcard and
+ * bracketed IPv6 literals are passed through unchanged, like other schemes
+ */
+bool
+needs_lookup(const dunedaq::utilities::ZmqUriView& uri)
+{
+  return uri.scheme == "tcp" && uri.host != "*" && uri.host.find(':') == std::string_view::npos;
+}
+
+std::string
+make_tcp_uri(const std::string& address, std::string_view port)
+{
+  std::string output;
+  output.reserve(address.size() + port.size() + 7);
+  output.append("tcp://").append(address).append(":").append(port);
+  return output;
+}
+
+} // namespace
+
+dunedaq::utilities::HostLookupResult
+dunedaq::utilities::lookup_hostname(const std::string& hostname, bool query_ttl)
 {
-  std::vector<std::string> output;
+  HostLookupResult output;
 
   TLOG_DEBUG(12) << "Name is " << hostname;
 
@@ -20,7 +160,8 @@ dunedaq::utilities::get_ips_from_hostname(std::string hostname)
   auto s = getaddrinfo(hostname.c_str(), nullptr, nullptr, &result);
 
   if (s != 0) {
-    ers::error(NameNotFound(ERS_HERE, hostname, std::string(gai_strerror(s))));
+    output.error = s;
+    output.error_string = std::string(gai_strerror(s));
     return output;
   }
 
@@ -34,7 +175,7 @@ dunedaq::utilities::get_ips_from_hostname(std::string hostname)
     getnameinfo(rp->ai_addr, rp->ai_addrlen, hbuf, sizeof(hbuf), sbuf, sizeof(sbuf), NI_NUMERICHOST | NI_NUMERICSERV);
     auto result = std::string(hbuf);
     bool duplicate = false;
-    for (auto& res : output) {
+    for (auto& res : output.addresses) {
       if (res == result) {
         duplicate = true;
         break;
@@ -42,50 +183,354 @@ dunedaq::utilities::get_ips_from_hostname(std::string hostname)
     }
     if (!duplicate) {
       TLOG_DEBUG(13) << "Found address " << result << " for hostname " << hostname;
-      output.push_back(result);
+      output.addresses.push_back(result);
     }
   }
 
   freeaddrinfo(result);
 
+  if (query_ttl) {
+    if (is_numeric_address(hostname)) {
+      // A numeric address resolves to itself forever
+      output.ttl_known = true;
+      output.ttl_seconds = std::numeric_limits<uint32_t>::max();
+    } else if (hostname.find('.') != std::string::npos) {
+      // Unqualified names (localhost, short names expanded by the search list) are usually
+      // answered from files, and res_nquery would not see the same answer, so leave their TTL unknown
+      output.ttl_known = query_record_ttl(hostname, output.ttl_seconds);
+    }
+  }
+
+  return output;
+}
+
+std::vector<std::string>
+dunedaq::utilities::get_ips_from_hostname(std::string hostname)
+{
+  auto result = ResolverCache::instance().resolve(hostname);
+
+  if (result.error != 0) {
+    ers::error(NameNotFound(ERS_HERE, hostname, result.error_string));
+  }
+
+  return result.addresses;
+}
+
+void
+dunedaq::utilities::set_nameservers(const std::vector<std::string>& servers)
+{
+  std::vector<struct sockaddr_in> addresses;
+  for (auto const& server : servers) {
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(NAMESERVER_PORT);
+
+    auto host = server;
+    auto colon = server.find(':');
+    if (colon != std::string::npos) {
+      host = server.substr(0, colon);
+      unsigned long port = 0;
+      auto first = server.data() + colon + 1;
+      auto last = server.data() + server.size();
+      auto [end, ec] = std::from_chars(first, last, port);
+      if (ec != std::errc() || end != last || port == 0 || port > std::numeric_limits<uint16_t>::max()) {
+        throw InvalidUri(ERS_HERE, server);
+      }
+      address.sin_port = htons(static_cast<uint16_t>(port));
+    }
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+      throw InvalidUri(ERS_HERE, server);
+    }
+    addresses.push_back(address);
+  }
+
+  std::lock_guard<std::mutex> lk(g_nameserver_mutex);
+  g_nameservers = addresses;
+  ++g_nameserver_generation;
+}
+
+dunedaq::utilities::ServiceLookupResult
+dunedaq::utilities::lookup_service(const std::string& service)
+{
+  ServiceLookupResult output;
+
+  TLOG_DEBUG(12) << "Service is " << service;
+
+  unsigned char answer[NS_MAXMSG];
+  int h_error = 0;
+  auto len = dns_query(service, ns_t_srv, answer, sizeof(answer), RES_DFLRETRY, RES_TIMEOUT, h_error);
+  if (len < 0) {
+    output.error = h_error != 0 ? h_error : NO_RECOVERY;
+    output.error_string = std::string(hstrerror(output.error));
+    return output;
+  }
+
+  output.records = parse_service_records(answer, len, output.ttl_seconds);
+  output.ttl_known = !output.records.empty();
+  if (output.records.empty()) {
+    output.error = NO_DATA;
+    output.error_string = std::string(hstrerror(NO_DATA));
+  }
+
+  return output;
+}
+
+std::vector<dunedaq::utilities::ServiceRecord>
+dunedaq::utilities::parse_service_records(const unsigned char* answer, int answer_length, uint32_t& min_ttl)
+{
+  std::vector<ServiceRecord> output;
+  min_ttl = std::numeric_limits<uint32_t>::max();
+
+  ns_msg msg;
+  if (ns_initparse(answer, answer_length, &msg) < 0)
+    return output;
+
+  for (int ii = 0; ii < ns_msg_count(msg, ns_s_an); ++ii) {
+    ns_rr rr;
+    if (ns_parserr(&msg, ns_s_an, ii, &rr) < 0 || ns_rr_type(rr) != ns_t_srv || ns_rr_rdlen(rr) < 7)
+      continue;
+
+    auto rdata = ns_rr_rdata(rr);
+    ServiceRecord record;
+    record.priority = ns_get16(rdata);
+    record.weight = ns_get16(rdata + 2);
+    record.port = ns_get16(rdata + 4);
+    record.ttl = ns_rr_ttl(rr);
+
+    char target[NS_MAXDNAME];
+    if (ns_name_uncompress(ns_msg_base(msg), ns_msg_end(msg), rdata + 6, target, sizeof(target)) < 0)
+      continue;
+    record.host = target;
+
+    // A target of "." means the service is decidedly not available at this domain (RFC 2782)
+    if (record.host.empty() || record.host == ".")
+      continue;
+
+    TLOG_DEBUG(13) << "Found service record " << record.host << ":" << record.port << " priority=" << record.priority
+                   << " weight=" << record.weight;
+    min_ttl = std::min(min_ttl, record.ttl);
+    output.push_back(record);
+  }
+
+  std::stable_sort(output.begin(), output.end(), [](ServiceRecord const& a, ServiceRecord const& b) {
+    return a.priority < b.priority;
+  });
+  return output;
+}
+
+void
+dunedaq::utilities::order_service_records(std::vector<ServiceRecord>& records)
+{
+  thread_local std::mt19937 generator{ std::random_device{}() };
+
+  std::stable_sort(records.begin(), records.end(), [](ServiceRecord const& a, ServiceRecord const& b) {
+    return a.priority < b.priority;
+  });
+
+  // Within each priority, repeatedly pick a record with probability proportional to its
+  // weight, with zero-weight records placed first so that they can still be chosen (RFC 2782)
+  auto group_begin = records.begin();
+  while (group_begin != records.end()) {
+    auto group_end = std::find_if(
+      group_begin, records.end(), [&](ServiceRecord const& r) { return r.priority != group_begin->priority; });
+    std::stable_partition(group_begin, group_end, [](ServiceRecord const& r) { return r.weight == 0; });
+
+    for (auto next = group_begin; next != group_end; ++next) {
+      uint32_t total_weight = 0;
+      for (auto it = next; it != group_end; ++it)
+        total_weight += it->weight;
+
+      auto selection = std::uniform_int_distribution<uint32_t>(0, total_weight)(generator);
+      uint32_t running_sum = 0;
+      auto chosen = next;
+      for (auto it = next; it != group_end; ++it) {
+        running_sum += it->weight;
+        if (running_sum >= selection) {
+          chosen = it;
+          break;
+        }
+      }
+      std::rotate(next, chosen, chosen + 1);
+    }
+    group_begin = group_end;
+  }
+}
+
+std::vector<dunedaq::utilities::ServiceRecord>
+dunedaq::utilities::get_service_records(const std::string& service)
+{
+  auto result = ResolverCache::instance().resolve_service(service);
+
+  if (result.error != 0) {
+    ers::error(ServiceNotFound(ERS_HERE, service));
+  }
+
+  order_service_records(result.records);
+  return result.records;
+}
+
+std::vector<dunedaq::utilities::ZmqUri>
+dunedaq::utilities::get_service_uris(const std::string& service, const std::string& scheme)
+{
+  std::vector<ZmqUri> output;
+  for (auto const& record : get_service_records(service)) {
+    auto host = record.host;
+    if (!host.empty() && host.back() == '.')
+      host.pop_back();
+    output.push_back(ZmqUri{ scheme, host, std::to_string(record.port) });
+  }
   return output;
 }
 
 std::vector<std::string>
 dunedaq::utilities::resolve_uri_hostname(std::string connection_string)
 {
-  auto uri = parse_connection_string(connection_string);
+  ZmqUriView uri;
+  if (!try_parse_connection_string(connection_string, uri)) {
+    throw InvalidUri(ERS_HERE, connection_string);
+  }
 
-  if(uri.scheme == "tcp") {
-  auto output = get_ips_from_hostname(uri.host);
+  if (!needs_lookup(uri)) {
+    return { connection_string };
+  }
 
+  auto output = get_ips_from_hostname(std::string(uri.host));
   for (size_t ii = 0; ii < output.size(); ++ii) {
-    output[ii] = "tcp://" + output[ii] + ":" + uri.port;
+    output[ii] = make_tcp_uri(output[ii], uri.port);
   }
   return output;
+}
+
+std::vector<dunedaq::utilities::UriResolution>
+dunedaq::utilities::resolve_uri_hostnames(const std::vector<std::string>& connection_strings, size_t max_concurrency)
+{
+  std::vector<UriResolution> output(connection_strings.size());
+  std::vector<ZmqUriView> uris(connection_strings.size());
+
+  // Collect the distinct hostnames which need a lookup
+  std::unordered_map<std::string_view, size_t> host_index;
+  std::vector<std::string> hosts;
+  for (size_t ii = 0; ii < connection_strings.size(); ++ii) {
+    if (!try_parse_connection_string(connection_strings[ii], uris[ii])) {
+      output[ii].error = InvalidUri(ERS_HERE, connection_strings[ii]).what();
+      continue;
+    }
+    if (needs_lookup(uris[ii]) && host_index.count(uris[ii].host) == 0) {
+      host_index[uris[ii].host] = hosts.size();
+      hosts.emplace_back(uris[ii].host);
+    }
+  }
+
+  std::vector<HostLookupResult> lookups(hosts.size());
+  std::atomic<size_t> next_host{ 0 };
+  auto lookup_worker = [&]() {
+    for (auto ii = next_host++; ii < hosts.size(); ii = next_host++) {
+      try {
+        lookups[ii] = ResolverCache::instance().resolve(hosts[ii]);
+      } catch (std::exception const& e) {
+        // Report the failure against this name rather than letting it escape the thread
+        lookups[ii] = HostLookupResult();
+        lookups[ii].error = EAI_FAIL;
+        lookups[ii].error_string = e.what();
+      }
+    }
+  };
+
+  auto n_threads = std::min(std::max<size_t>(max_concurrency, 1), hosts.size());
+  if (n_threads <= 1) {
+    lookup_worker();
   } else {
-  return { connection_string }; 
+    std::vector<std::thread> threads;
+    threads.reserve(n_threads);
+    try {
+      for (size_t ii = 0; ii < n_threads; ++ii) {
+        threads.emplace_back(lookup_worker);
+      }
+    } catch (...) {
+      // The started threads reference this frame, so they must finish before it unwinds
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      throw;
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
   }
+
+  for (size_t ii = 0; ii < connection_strings.size(); ++ii) {
+    if (!output[ii].ok()) {
+      continue;
+    }
+    if (!needs_lookup(uris[ii])) {
+      output[ii].uris.push_back(connection_strings[ii]);
+      continue;
+    }
+
+    auto const& lookup = lookups[host_index[uris[ii].host]];
+    if (lookup.error != 0) {
+      output[ii].error = NameNotFound(ERS_HERE, std::string(uris[ii].host), lookup.error_string).what();
+      continue;
+    }
+    for (auto const& address : lookup.addresses) {
+      output[ii].uris.push_back(make_tcp_uri(address, uris[ii].port));
+    }
+  }
+
+  return output;
 }
 
-dunedaq::utilities::ZmqUri
-dunedaq::utilities::parse_connection_string(std::string connection_string)
+bool
+dunedaq::utilities::try_parse_connection_string(std::string_view connection_string, ZmqUriView& output) noexcept
 {
   // ZMQ URIs are formatted as follows: tcp://{host}:{port}
-  ZmqUri output;
+  auto separator = connection_string.find("://");
+  if (separator == std::string_view::npos) {
+    return false;
+  }
 
-  if (connection_string.find("://") == std::string::npos) {
-    throw InvalidUri(ERS_HERE, connection_string);
+  output.scheme = connection_string.substr(0, separator);
+  auto rest = connection_string.substr(separator + 3);
+  output.port = std::string_view();
+
+  if (output.scheme == "ipc" || output.scheme == "inproc") {
+    output.host = rest;
+    return true;
   }
 
-  output.scheme = connection_string.substr(0, connection_string.find("://"));
-  connection_string = connection_string.substr(connection_string.find("://") + 3);
+  if (!rest.empty() && rest.front() == '[') {
+    auto close = rest.find(']');
+    if (close == std::string_view::npos) {
+      return false;
+    }
+    output.host = rest.substr(1, close - 1);
+    rest = rest.substr(close + 1);
+    if (rest.empty()) {
+      return true;
+    }
+    if (rest.front() != ':') {
+      return false;
+    }
+    output.port = rest.substr(1);
+    return true;
+  }
 
-  if (connection_string.find(":") != std::string::npos) {
-    output.port = connection_string.substr(connection_string.find(":") + 1);
-    connection_string = connection_string.substr(0, connection_string.find(":"));
+  auto colon = rest.find(':');
+  output.host = rest.substr(0, colon);
+  if (colon != std::string_view::npos) {
+    output.port = rest.substr(colon + 1);
   }
-  output.host = connection_string;
 
-  return output;
+  return true;
+}
+
+dunedaq::utilities::ZmqUri
+dunedaq::utilities::parse_connection_string(const std::string& connection_string)
+{
+  ZmqUriView view;
+  if (!try_parse_connection_string(connection_string, view)) {
+    throw InvalidUri(ERS_HERE, connection_string);
+  }
+  return view.to_uri();
 }
@@ -0,0 +1,219 @@
+/**
+ *
+ * @file ResolverCache.cpp ResolverCache implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverCache.hpp"
+#include "utilities/StaticHostTable.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+ResolverCache::ResolverCache(ResolverCacheConfig config)
+  : m_config(config)
+{}
+
+ResolverCache&
+ResolverCache::instance()
+{
+  static ResolverCache s_instance;
+  return s_instance;
+}
+
+void
+ResolverCache::configure(const ResolverCacheConfig& config)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_config = config;
+  trim(m_hosts);
+  trim(m_services);
+}
+
+ResolverCacheConfig
+ResolverCache::get_config() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  return m_config;
+}
+
+HostLookupResult
+ResolverCache::resolve(const std::string& hostname)
+{
+  if (auto table = get_static_host_table()) {
+    HostLookupResult result;
+    if (table->lookup(hostname, result.addresses)) {
+      ++m_static_hits;
+      return result;
+    }
+  }
+
+  bool query_ttl = get_config().query_record_ttl;
+  return resolve_with(m_hosts, hostname, [&]() { return lookup_hostname(hostname, query_ttl); });
+}
+
+ServiceLookupResult
+ResolverCache::resolve_service(const std::string& service)
+{
+  return resolve_with(m_services, service, [&]() { return lookup_service(service); });
+}
+
+void
+ResolverCache::invalidate(const std::string& name)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  erase(m_hosts, name);
+  erase(m_services, name);
+}
+
+void
+ResolverCache::clear()
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_hosts.entries.clear();
+  m_hosts.lru.clear();
+  m_services.entries.clear();
+  m_services.lru.clear();
+}
+
+ResolverCacheStats
+ResolverCache::get_stats() const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto stats = m_stats;
+  stats.static_hits = m_static_hits.load();
+  stats.entries = m_hosts.entries.size() + m_services.entries.size();
+  return stats;
+}
+
+void
+ResolverCache::reset_stats()
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  m_stats = ResolverCacheStats();
+  m_static_hits = 0;
+}
+
+template<class Result, class Lookup>
+Result
+ResolverCache::resolve_with(Table<Result>& table, const std::string& name, Lookup lookup)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+
+  if (!m_config.enabled) {
+    lk.unlock();
+    return lookup();
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  auto entry = table.entries.find(name);
+  if (entry != table.entries.end()) {
+    if (entry->second.expiry > now) {
+      table.lru.splice(table.lru.begin(), table.lru, entry->second.lru_position);
+      if (entry->second.result.error != 0) {
+        ++m_stats.negative_hits;
+      } else {
+        ++m_stats.hits;
+      }
+      TLOG_DEBUG(14) << "Cache hit for " << name;
+      return entry->second.result;
+    }
+    erase(table, name);
+    ++m_stats.expirations;
+  }
+
+  // Another thread is already resolving this name, wait for its answer
+  auto pending = table.pending.find(name);
+  if (pending != table.pending.end()) {
+    auto future = pending->second;
+    ++m_stats.coalesced;
+    lk.unlock();
+    return future.get();
+  }
+
+  ++m_stats.misses;
+  std::promise<Result> promise;
+  table.pending.emplace(name, promise.get_future().share());
+  lk.unlock();
+
+  Result result;
+  try {
+    result = lookup();
+  } catch (...) {
+    lk.lock();
+    table.pending.erase(name);
+    lk.unlock();
+    promise.set_exception(std::current_exception());
+    throw;
+  }
+
+  lk.lock();
+  insert(table, name, result);
+  table.pending.erase(name);
+  lk.unlock();
+
+  promise.set_value(result);
+  return result;
+}
+
+template<class Result>
+void
+ResolverCache::insert(Table<Result>& table, const std::string& name, const Result& result)
+{
+  auto ttl = ttl_for(result);
+  if (ttl.count() <= 0 || m_config.max_entries == 0) {
+    return;
+  }
+
+  erase(table, name);
+  table.lru.push_front(name);
+  table.entries.emplace(
+    name, typename Table<Result>::Entry{ result, std::chrono::steady_clock::now() + ttl, table.lru.begin() });
+  TLOG_DEBUG(14) << "Caching lookup of " << name << " for " << ttl.count() << " s";
+  trim(table);
+}
+
+template<class Result>
+void
+ResolverCache::erase(Table<Result>& table, const std::string& name)
+{
+  auto entry = table.entries.find(name);
+  if (entry != table.entries.end()) {
+    table.lru.erase(entry->second.lru_position);
+    table.entries.erase(entry);
+  }
+}
+
+template<class Result>
+void
+ResolverCache::trim(Table<Result>& table)
+{
+  while (table.entries.size() > m_config.max_entries) {
+    table.entries.erase(table.lru.back());
+    table.lru.pop_back();
+    ++m_stats.evictions;
+  }
+}
+
+template<class Result>
+std::chrono::seconds
+ResolverCache::ttl_for(const Result& result) const
+{
+  if (result.error != 0) {
+    return m_config.negative_ttl;
+  }
+
+  auto ttl = result.ttl_known ? std::chrono::seconds(result.ttl_seconds) : m_config.default_ttl;
+  return std::clamp(ttl, m_config.min_ttl, std::max(m_config.min_ttl, m_config.max_ttl));
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,233 @@
+/**
+ *
+ * @file ResolverService.cpp ResolverService implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverService.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace dunedaq {
+namespace utilities {
+
+ResolverService::ResolverService(std::chrono::milliseconds refresh_period, BatchResolver resolver)
+  : m_resolver(resolver)
+  , m_refresh_period(refresh_period)
+  , m_thread(std::bind(&ResolverService::do_work, this, std::placeholders::_1))
+{
+  if (!m_resolver) {
+    m_resolver = [](const std::vector<std::string>& connection_strings) {
+      return resolve_uri_hostnames(connection_strings);
+    };
+  }
+}
+
+ResolverService::~ResolverService()
+{
+  if (is_running()) {
+    stop();
+  }
+}
+
+void
+ResolverService::start(const std::string& name)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop_requested = false;
+    m_wake = true;
+  }
+  m_thread.start_working_thread(name);
+}
+
+void
+ResolverService::stop()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stop_requested = true;
+  }
+  m_cv.notify_all();
+  m_thread.stop_working_thread();
+}
+
+uint64_t // NOLINT(build/unsigned)
+ResolverService::subscribe(const std::string& connection_string, Callback callback)
+{
+  uint64_t id = 0; // NOLINT(build/unsigned)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    id = m_next_subscription_id++;
+    m_endpoints[connection_string].subscribers[id] = Subscriber{ callback, false };
+    m_subscriptions[id] = connection_string;
+    m_wake = true;
+  }
+  m_cv.notify_all();
+  return id;
+}
+
+void
+ResolverService::unsubscribe(uint64_t subscription_id) // NOLINT(build/unsigned)
+{
+  std::unique_lock<std::mutex> lk(m_mutex);
+  auto subscription = m_subscriptions.find(subscription_id);
+  if (subscription == m_subscriptions.end()) {
+    return;
+  }
+
+  auto endpoint = m_endpoints.find(subscription->second);
+  endpoint->second.subscribers.erase(subscription_id);
+  if (endpoint->second.subscribers.empty()) {
+    m_endpoints.erase(endpoint);
+  }
+  m_subscriptions.erase(subscription);
+
+  // Wait for a callback already running for this subscription, unless it is the caller
+  if (m_notifying_id == subscription_id && m_notifying_thread != std::this_thread::get_id()) {
+    m_notify_cv.wait(lk, [&]() { return m_notifying_id != subscription_id; });
+  }
+}
+
+std::vector<std::string>
+ResolverService::get_endpoints(const std::string& connection_string) const
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto endpoint = m_endpoints.find(connection_string);
+  if (endpoint == m_endpoints.end()) {
+    return {};
+  }
+  return endpoint->second.resolved;
+}
+
+void
+ResolverService::refresh_now()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_wake = true;
+  }
+  m_cv.notify_all();
+}
+
+void
+ResolverService::set_refresh_period(std::chrono::milliseconds refresh_period)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_refresh_period = refresh_period;
+    m_period_changed = true;
+  }
+  m_cv.notify_all();
+}
+
+void
+ResolverService::do_work(std::atomic<bool>& running_flag)
+{
+  while (running_flag.load()) {
+    refresh();
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    auto period_start = std::chrono::steady_clock::now();
+    do {
+      // A new period takes effect immediately, measured from the last refresh
+      m_period_changed = false;
+      m_cv.wait_until(lk, period_start + m_refresh_period, [&]() {
+        return m_wake || m_stop_requested || m_period_changed;
+      });
+    } while (m_period_changed && !m_wake && !m_stop_requested);
+    if (m_stop_requested) {
+      break;
+    }
+  }
+}
+
+void
+ResolverService::refresh()
+{
+  std::vector<std::string> connection_strings;
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_wake = false;
+    for (auto const& endpoint : m_endpoints) {
+      connection_strings.push_back(endpoint.first);
+    }
+  }
+  if (connection_strings.empty()) {
+    return;
+  }
+
+  auto results = m_resolver(connection_strings);
+
+  std::vector<std::tuple<uint64_t, Callback, std::string, std::vector<std::string>>> notifications; // NOLINT
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    for (size_t ii = 0; ii < connection_strings.size() && ii < results.size(); ++ii) {
+      auto endpoint = m_endpoints.find(connection_strings[ii]);
+      if (endpoint == m_endpoints.end()) {
+        continue; // Unsubscribed while resolving
+      }
+      if (!results[ii].ok()) {
+        ers::warning(EndpointRefreshFailed(ERS_HERE, connection_strings[ii], results[ii].error));
+        continue;
+      }
+
+      auto resolved = results[ii].uris;
+      std::sort(resolved.begin(), resolved.end());
+      bool changed = !endpoint->second.known || resolved != endpoint->second.resolved;
+      if (changed) {
+        TLOG_DEBUG(15) << "Endpoint " << connection_strings[ii] << " now resolves to " << resolved.size()
+                       << " address(es)";
+        endpoint->second.resolved = resolved;
+        endpoint->second.known = true;
+      }
+
+      // Everyone hears about a change; new subscribers also hear about the current state
+      for (auto& subscriber : endpoint->second.subscribers) {
+        if ((changed || !subscriber.second.notified) && subscriber.second.callback) {
+          notifications.emplace_back(subscriber.first, subscriber.second.callback, connection_strings[ii], resolved);
+        }
+        subscriber.second.notified = true;
+      }
+    }
+  }
+
+  // Callbacks are called without holding the lock, so that they may use the service. Each one is
+  // marked in flight so that unsubscribe can wait for it, and skipped if it was unsubscribed meanwhile.
+  for (auto const& notification : notifications) {
+    auto id = std::get<0>(notification);
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (m_subscriptions.count(id) == 0) {
+        continue;
+      }
+      m_notifying_id = id;
+      m_notifying_thread = std::this_thread::get_id();
+    }
+    // A throwing subscriber must not take the service thread (and the process) down with it
+    try {
+      std::get<1>(notification)(std::get<2>(notification), std::get<3>(notification));
+    } catch (std::exception const& e) {
+      ers::warning(EndpointCallbackFailed(ERS_HERE, std::get<2>(notification), e.what()));
+    } catch (...) {
+      ers::warning(EndpointCallbackFailed(ERS_HERE, std::get<2>(notification), "unknown exception"));
+    }
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_notifying_id = 0;
+    }
+    m_notify_cv.notify_all();
+  }
+}
+
+} // namespace utilities
+} // namespace dunedaq
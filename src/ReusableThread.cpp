@@ -13,28 +13,52 @@
 #include "utilities/WorkerThread.hpp" // contains exception definition
 
 
-dunedaq::utilities::ReusableThread::ReusableThread(int threadid)
+dunedaq::utilities::ReusableThread::ReusableThread(int threadid, size_t queue_capacity)
   : m_thread_id(threadid)
   , m_task_executed(true)
   , m_task_assigned(false)
   , m_thread_quit(false)
-  , m_worker_done(false)
+  , m_named(false)
+  , m_completion(nullptr)
+  , m_stats(nullptr)
+  , m_tid(0)
+  , m_assigned_ns(0)
+  , m_memory_policy(MemoryPolicy::kNone)
+  , m_memory_node(-1)
+  , m_memory_policy_pending(false)
+  , m_queue(queue_capacity > 0 ? std::make_unique<MpscRing<QueuedTask>>(queue_capacity) : nullptr)
+  , m_queued(0)
+  , m_completed_counter(0)
+  , m_ready_waiters(0)
+  , m_wait_strategy(WaitStrategy::kBlock)
+  , m_spin_budget(s_default_spin_budget)
+  , m_wake_counter(0)
+  , m_worker_parked(false)
   , m_thread(&ReusableThread::thread_worker, this)
 {}
 
 dunedaq::utilities::ReusableThread::~ReusableThread()
 {
-  while (m_task_assigned) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-  }
+  // The worker finishes any assigned and queued tasks before it sees the quit flag
   m_thread_quit = true;
-  while (!m_worker_done) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    m_cv.notify_all();
-  }
+  wake_worker();
   m_thread.join();
 }
 
+void
+dunedaq::utilities::ReusableThread::wait_until_ready()
+{
+  while (!is_idle()) {
+    // Same handshake as wait_for_work: register as a waiter, then re-check
+    m_ready_waiters.fetch_add(1);
+    auto completed_counter = m_completed_counter.load();
+    if (!is_idle()) {
+      detail::futex_wait(m_completed_counter, completed_counter);
+    }
+    m_ready_waiters.fetch_sub(1);
+  }
+}
+
 void
 dunedaq::utilities::ReusableThread::set_name(const std::string& name, int tid)
 {
@@ -44,6 +68,21 @@ dunedaq::utilities::ReusableThread::set_name(const std::string& name, int tid)
   auto handle = m_thread.native_handle();
   pthread_setname_np(handle, tname);
 
+  // Statistics stay registered under the first name; the worker may be using them
+  std::shared_ptr<ThreadStats> stats;
+  if (!m_stats_owner) {
+    stats = ThreadTelemetry::instance().register_thread(name + "-" + std::to_string(tid), "ReusableThread");
+  }
+  if (stats) {
+    // The worker records its tid as soon as it starts
+    while (m_tid.load() == 0) {
+      std::this_thread::yield();
+    }
+    stats->set_started(m_tid.load());
+    m_stats_owner = stats;
+    m_stats.store(stats.get(), std::memory_order_release);
+  }
+
   m_named = true;
 }
 
@@ -66,20 +105,155 @@ dunedaq::utilities::ReusableThread::set_pin(int cpuid)
   }
 }
 
+void
+dunedaq::utilities::ReusableThread::set_pin(const std::vector<int>& cpus)
+{
+  set_thread_affinity(m_thread.native_handle(), cpus);
+}
+
+void
+dunedaq::utilities::ReusableThread::set_placement(const ThreadPlacement& placement)
+{
+  if (!placement.cpus.empty()) {
+    set_pin(placement.cpus);
+  }
+  if (placement.memory_policy != MemoryPolicy::kNone) {
+    m_memory_node.store(placement.memory_node, std::memory_order_relaxed);
+    m_memory_policy.store(placement.memory_policy, std::memory_order_relaxed);
+    m_memory_policy_pending.store(true, std::memory_order_release);
+  }
+}
+
+void
+dunedaq::utilities::ReusableThread::apply_memory_policy()
+{
+  if (m_memory_policy_pending.load(std::memory_order_relaxed) && m_memory_policy_pending.exchange(false)) {
+    set_memory_policy(m_memory_policy.load(std::memory_order_relaxed), m_memory_node.load(std::memory_order_relaxed));
+  }
+}
+
+void
+dunedaq::utilities::ReusableThread::set_wait_strategy(WaitStrategy strategy, uint32_t spin_budget) // NOLINT
+{
+  m_spin_budget.store(spin_budget, std::memory_order_relaxed);
+  m_wait_strategy.store(strategy, std::memory_order_relaxed);
+  // A parked worker re-reads the strategy when woken
+  wake_worker();
+}
+
+void
+dunedaq::utilities::ReusableThread::wait_for_work()
+{
+  auto stats = m_stats.load(std::memory_order_acquire);
+  if (stats == nullptr) {
+    wait_for_work_untimed();
+    return;
+  }
+
+  auto start = ThreadTelemetry::now_ns();
+  wait_for_work_untimed();
+  stats->record_idle(ThreadTelemetry::now_ns() - start);
+}
+
+void
+dunedaq::utilities::ReusableThread::wait_for_work_untimed()
+{
+  auto strategy = m_wait_strategy.load(std::memory_order_relaxed);
+
+  if (strategy != WaitStrategy::kBlock) {
+    auto spin_budget = m_spin_budget.load(std::memory_order_relaxed);
+    for (uint32_t ii = 0; ii < spin_budget || strategy == WaitStrategy::kSpin; ++ii) { // NOLINT(build/unsigned)
+      if (has_work()) {
+        return;
+      }
+      detail::cpu_relax();
+    }
+    if (strategy == WaitStrategy::kSpinYield) {
+      std::this_thread::yield();
+      return;
+    }
+  }
+
+  // Park. Announcing that we are parked before re-checking for work pairs
+  // with wake_worker(), which bumps the counter before checking for a parked
+  // worker: either it sees us parked and wakes us, or we see its work (or the
+  // changed counter makes the futex wait return immediately).
+  m_worker_parked.store(true);
+  auto wake_counter = m_wake_counter.load();
+  if (!has_work()) {
+    detail::futex_wait(m_wake_counter, wake_counter);
+  }
+  m_worker_parked.store(false, std::memory_order_relaxed);
+}
+
+void
+dunedaq::utilities::ReusableThread::notify_completion()
+{
+  m_completed_counter.fetch_add(1);
+  if (m_ready_waiters.load() > 0) {
+    detail::futex_wake(m_completed_counter);
+  }
+}
+
+bool
+dunedaq::utilities::ReusableThread::run_queued_tasks()
+{
+  if (!m_queue) {
+    return false;
+  }
+
+  QueuedTask batch[s_drain_batch];
+  auto count = m_queue->try_pop_batch(batch, s_drain_batch);
+  for (size_t ii = 0; ii < count; ++ii) {
+    run_task(batch[ii].task, batch[ii].submitted_ns);
+  }
+  if (count > 0) {
+    m_queued.fetch_sub(count);
+    notify_completion();
+  }
+  return count > 0;
+}
+
+void
+dunedaq::utilities::ReusableThread::run_task(Task& task, int64_t submitted_ns)
+{
+  auto stats = m_stats.load(std::memory_order_acquire);
+  if (stats == nullptr) {
+    task();
+    task.reset();
+    return;
+  }
+
+  auto start = ThreadTelemetry::now_ns();
+  task();
+  task.reset();
+  stats->record_task(submitted_ns != 0 ? start - submitted_ns : -1, ThreadTelemetry::now_ns() - start);
+}
+
 void
 dunedaq::utilities::ReusableThread::thread_worker()
 {
-  std::unique_lock<std::mutex> lock(m_mtx);
+  m_tid.store(ThreadTelemetry::current_tid());
 
-  while (!m_thread_quit) {
-    if (!m_task_executed && m_task_assigned) {
-      m_task();
-      m_task_executed = true;
+  while (true) {
+    apply_memory_policy();
+    if (m_task_assigned.load(std::memory_order_acquire)) {
+      run_task(m_task, m_assigned_ns); // Also releases whatever the task holds before announcing completion
       m_task_assigned = false;
+      // Signal before the slot is released, so that a new task cannot reset the
+      // completion first. set_work may therefore briefly fail after wait() returns.
+      if (m_completion != nullptr) {
+        m_completion->signal();
+        m_completion = nullptr;
+      }
+      m_task_executed = true;
+      notify_completion();
+    } else if (run_queued_tasks()) {
+      continue;
+    } else if (m_thread_quit.load(std::memory_order_acquire) && m_queued.load() == 0) {
+      break;
     } else {
-      m_cv.wait(lock);
+      wait_for_work();
     }
   }
-
-  m_worker_done = true;
 }
@@ -0,0 +1,158 @@
+/**
+ *
+ * @file ReusableThreadPool.cpp ReusableThreadPool implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThreadPool.hpp"
+#include "utilities/WorkerThread.hpp" // contains exception definition
+
+#include <algorithm>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+// The pool and queue index of the calling thread, if it is a pool thread
+thread_local const ReusableThreadPool* t_pool = nullptr;
+thread_local size_t t_queue_index = 0;
+} // namespace
+
+ReusableThreadPool::ReusableThreadPool(size_t n_threads, const std::string& name)
+  : m_queues(new Queue[std::max<size_t>(n_threads, 1)])
+{
+  n_threads = std::max<size_t>(n_threads, 1);
+  for (size_t ii = 0; ii < n_threads; ++ii) {
+    m_threads.emplace_back(std::make_unique<ReusableThread>(static_cast<int>(ii)));
+    m_threads.back()->set_name(name, static_cast<int>(ii));
+  }
+  // Each thread runs the pool's work loop as one long task
+  for (size_t ii = 0; ii < n_threads; ++ii) {
+    m_threads[ii]->set_work(&ReusableThreadPool::worker_loop, this, ii);
+  }
+}
+
+ReusableThreadPool::~ReusableThreadPool()
+{
+  m_quit.store(true);
+  m_wake_counter.fetch_add(1);
+  detail::futex_wake(m_wake_counter);
+  // ReusableThread's destructor waits for the work loop to return
+  m_threads.clear();
+}
+
+void
+ReusableThreadPool::submit_task(Task&& task)
+{
+  size_t index = t_queue_index;
+  if (t_pool != this) {
+    index = m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_threads.size();
+  }
+
+  // Counting the task before queueing it means m_queued never under-counts,
+  // so a thread that sees it at zero may safely park
+  m_queued.fetch_add(1);
+  {
+    std::lock_guard<std::mutex> lk(m_queues[index].mutex);
+    m_queues[index].tasks.push_back(std::move(task));
+  }
+
+  // Pairs with wait_for_tasks(): either the parking thread sees the task, or we see it idle
+  if (m_idle_threads.load() > 0) {
+    m_wake_counter.fetch_add(1);
+    detail::futex_wake(m_wake_counter, 1);
+  }
+}
+
+void
+ReusableThreadPool::set_pin(size_t thread_index, int cpuid)
+{
+  if (thread_index >= m_threads.size()) {
+    ers::warning(ThreadingIssue(ERS_HERE, "No thread " + std::to_string(thread_index) + " in pool"));
+    return;
+  }
+  m_threads[thread_index]->set_pin(cpuid);
+}
+
+void
+ReusableThreadPool::worker_loop(size_t index)
+{
+  t_pool = this;
+  t_queue_index = index;
+
+  Task task;
+  while (true) {
+    if (try_pop(index, task) || try_steal(index, task)) {
+      task();
+      task.reset();
+      m_tasks_executed.fetch_add(1, std::memory_order_relaxed);
+    } else if (m_quit.load() && m_queued.load() == 0) {
+      break;
+    } else {
+      wait_for_tasks();
+    }
+  }
+
+  t_pool = nullptr;
+}
+
+bool
+ReusableThreadPool::try_pop(size_t index, Task& task)
+{
+  std::lock_guard<std::mutex> lk(m_queues[index].mutex);
+  auto& tasks = m_queues[index].tasks;
+  if (tasks.empty()) {
+    return false;
+  }
+  task = std::move(tasks.front());
+  tasks.pop_front();
+  m_queued.fetch_sub(1);
+  return true;
+}
+
+bool
+ReusableThreadPool::try_steal(size_t index, Task& task)
+{
+  if (m_queued.load(std::memory_order_relaxed) == 0) {
+    return false;
+  }
+
+  for (size_t offset = 1; offset < m_threads.size(); ++offset) {
+    auto& victim = m_queues[(index + offset) % m_threads.size()];
+    // Do not queue up behind the owner or another thief, try the next one instead
+    std::unique_lock<std::mutex> lk(victim.mutex, std::try_to_lock);
+    if (!lk.owns_lock() || victim.tasks.empty()) {
+      continue;
+    }
+    task = std::move(victim.tasks.back());
+    victim.tasks.pop_back();
+    m_queued.fetch_sub(1);
+    m_tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+void
+ReusableThreadPool::wait_for_tasks()
+{
+  for (int ii = 0; ii < s_idle_spins; ++ii) {
+    if (m_queued.load(std::memory_order_relaxed) > 0 || m_quit.load(std::memory_order_relaxed)) {
+      return;
+    }
+    detail::cpu_relax();
+  }
+
+  m_idle_threads.fetch_add(1);
+  auto wake_counter = m_wake_counter.load();
+  if (m_queued.load() == 0 && !m_quit.load()) {
+    detail::futex_wait(m_wake_counter, wake_counter);
+  }
+  m_idle_threads.fetch_sub(1);
+}
+
+} // namespace utilities
+} // namespace dunedaq
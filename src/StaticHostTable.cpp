@@ -0,0 +1,321 @@
+/**
+ *
+ * @file StaticHostTable.cpp StaticHostTable implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/StaticHostTable.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+
+// File layout: Header, Bucket[bucket_count], uint32_t addresses[address_count], char strings[string_size]
+constexpr char kMagic[8] = { 'D', 'A', 'Q', 'H', 'O', 'S', 'T', 'S' };
+constexpr uint32_t kVersion = 2; // NOLINT(build/unsigned) 2: names are stored in lower case
+
+struct Header
+{
+  char magic[8];
+  uint32_t version;       // NOLINT(build/unsigned)
+  uint32_t bucket_count;  // NOLINT(build/unsigned)
+  uint32_t entry_count;   // NOLINT(build/unsigned)
+  uint32_t address_count; // NOLINT(build/unsigned)
+  uint32_t string_size;   // NOLINT(build/unsigned)
+  uint32_t reserved;      // NOLINT(build/unsigned)
+};
+
+// Hostnames are case-insensitive (RFC 4343); only ASCII letters are folded
+char
+to_lower(char c) noexcept
+{
+  return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+} // namespace
+
+struct StaticHostTable::Bucket
+{
+  uint64_t hash;           // NOLINT(build/unsigned)
+  uint32_t name_offset;    // NOLINT(build/unsigned)
+  uint32_t name_length;    // NOLINT(build/unsigned), 0 for an empty bucket
+  uint32_t address_offset; // NOLINT(build/unsigned)
+  uint32_t address_count;  // NOLINT(build/unsigned)
+};
+
+uint64_t // NOLINT(build/unsigned)
+StaticHostTable::hash(std::string_view hostname) noexcept
+{
+  // FNV-1a of the lower-case name
+  uint64_t hash = 14695981039346656037ULL; // NOLINT(build/unsigned)
+  for (auto c : hostname) {
+    hash ^= static_cast<unsigned char>(to_lower(c));
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+StaticHostTable::StaticHostTable(const std::string& path)
+  : m_path(path)
+{
+  auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw StaticHostTableError(ERS_HERE, path, std::strerror(errno));
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    throw StaticHostTableError(ERS_HERE, path, "file is too small");
+  }
+
+  m_mapping_size = static_cast<size_t>(st.st_size);
+  m_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+  close(fd);
+  if (m_mapping == MAP_FAILED) { // NOLINT
+    m_mapping = nullptr;
+    throw StaticHostTableError(ERS_HERE, path, std::strerror(errno));
+  }
+
+  auto base = static_cast<const char*>(m_mapping);
+  Header header;
+  std::memcpy(&header, base, sizeof(header));
+
+  size_t expected_size = sizeof(Header) + sizeof(Bucket) * header.bucket_count +
+                         sizeof(uint32_t) * header.address_count + header.string_size; // NOLINT(build/unsigned)
+  std::string error;
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    error = "bad magic number";
+  } else if (header.version != kVersion) {
+    error = "unsupported version " + std::to_string(header.version);
+  } else if (header.bucket_count == 0 || (header.bucket_count & (header.bucket_count - 1)) != 0) {
+    error = "bucket count is not a power of two";
+  } else if (expected_size != m_mapping_size) {
+    error = "file size does not match header";
+  }
+  if (!error.empty()) {
+    munmap(m_mapping, m_mapping_size);
+    m_mapping = nullptr;
+    throw StaticHostTableError(ERS_HERE, path, error);
+  }
+
+  m_buckets = reinterpret_cast<const Bucket*>(base + sizeof(Header)); // NOLINT
+  m_addresses = reinterpret_cast<const uint32_t*>(m_buckets + header.bucket_count); // NOLINT
+  m_strings = reinterpret_cast<const char*>(m_addresses + header.address_count); // NOLINT
+  m_bucket_mask = header.bucket_count - 1;
+  m_entry_count = header.entry_count;
+
+  // Reject out-of-range offsets once here, so that find() need not check them
+  for (uint32_t ii = 0; ii < header.bucket_count; ++ii) { // NOLINT(build/unsigned)
+    auto const& bucket = m_buckets[ii];
+    if (bucket.name_length == 0)
+      continue;
+    if (static_cast<uint64_t>(bucket.name_offset) + bucket.name_length > header.string_size ||
+        static_cast<uint64_t>(bucket.address_offset) + bucket.address_count > header.address_count) {
+      munmap(m_mapping, m_mapping_size);
+      m_mapping = nullptr;
+      throw StaticHostTableError(ERS_HERE, path, "entry points outside the file");
+    }
+  }
+
+  TLOG_DEBUG(12) << "Mapped static host table " << path << " with " << m_entry_count << " entries";
+}
+
+StaticHostTable::~StaticHostTable()
+{
+  if (m_mapping != nullptr) {
+    munmap(m_mapping, m_mapping_size);
+  }
+}
+
+bool
+StaticHostTable::find(std::string_view hostname, const uint32_t*& addresses, size_t& count) const noexcept
+{
+  auto h = hash(hostname);
+  for (uint32_t probe = 0; probe <= m_bucket_mask; ++probe) { // NOLINT(build/unsigned)
+    auto const& bucket = m_buckets[(h + probe) & m_bucket_mask];
+    if (bucket.name_length == 0) {
+      return false;
+    }
+    // Stored names are lower case
+    if (bucket.hash == h && bucket.name_length == hostname.size() &&
+        std::equal(hostname.begin(), hostname.end(), m_strings + bucket.name_offset, [](char a, char b) {
+          return to_lower(a) == b;
+        })) {
+      addresses = m_addresses + bucket.address_offset;
+      count = bucket.address_count;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool
+StaticHostTable::lookup(std::string_view hostname, std::vector<std::string>& addresses) const
+{
+  const uint32_t* found = nullptr; // NOLINT(build/unsigned)
+  size_t count = 0;
+  if (!find(hostname, found, count)) {
+    return false;
+  }
+
+  addresses.clear();
+  for (size_t ii = 0; ii < count; ++ii) {
+    char buffer[INET_ADDRSTRLEN];
+    struct in_addr address;
+    address.s_addr = found[ii];
+    inet_ntop(AF_INET, &address, buffer, sizeof(buffer));
+    addresses.emplace_back(buffer);
+  }
+  return true;
+}
+
+void
+StaticHostTable::compile(const std::string& hosts_path, const std::string& table_path)
+{
+  std::ifstream input(hosts_path);
+  if (!input) {
+    throw StaticHostTableError(ERS_HERE, hosts_path, "could not open hosts file");
+  }
+
+  // Name -> addresses, in file order without duplicates
+  std::map<std::string, std::vector<uint32_t>> hosts; // NOLINT(build/unsigned)
+  std::string line;
+  while (std::getline(input, line)) {
+    line = line.substr(0, line.find('#'));
+    std::istringstream fields(line);
+    std::string address_string;
+    if (!(fields >> address_string)) {
+      continue;
+    }
+    struct in_addr address;
+    if (inet_pton(AF_INET, address_string.c_str(), &address) != 1) {
+      continue; // IPv6 or malformed
+    }
+    std::string name;
+    while (fields >> name) {
+      std::transform(name.begin(), name.end(), name.begin(), to_lower);
+      auto& addresses = hosts[name];
+      if (std::find(addresses.begin(), addresses.end(), address.s_addr) == addresses.end()) {
+        addresses.push_back(address.s_addr);
+      }
+    }
+  }
+
+  // Keep the load factor at or below one half so that probe sequences stay short
+  uint32_t bucket_count = 1; // NOLINT(build/unsigned)
+  while (bucket_count < 2 * hosts.size()) {
+    bucket_count <<= 1;
+  }
+
+  std::vector<Bucket> buckets(bucket_count, Bucket{ 0, 0, 0, 0, 0 });
+  std::vector<uint32_t> addresses; // NOLINT(build/unsigned)
+  std::string strings;
+  for (auto const& host : hosts) {
+    auto h = hash(host.first);
+    auto index = h & (bucket_count - 1);
+    while (buckets[index].name_length != 0) {
+      index = (index + 1) & (bucket_count - 1);
+    }
+    buckets[index] = Bucket{ h,
+                             static_cast<uint32_t>(strings.size()),       // NOLINT(build/unsigned)
+                             static_cast<uint32_t>(host.first.size()),    // NOLINT(build/unsigned)
+                             static_cast<uint32_t>(addresses.size()),     // NOLINT(build/unsigned)
+                             static_cast<uint32_t>(host.second.size()) }; // NOLINT(build/unsigned)
+    strings += host.first;
+    addresses.insert(addresses.end(), host.second.begin(), host.second.end());
+  }
+
+  Header header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.bucket_count = bucket_count;
+  header.entry_count = static_cast<uint32_t>(hosts.size());       // NOLINT(build/unsigned)
+  header.address_count = static_cast<uint32_t>(addresses.size()); // NOLINT(build/unsigned)
+  header.string_size = static_cast<uint32_t>(strings.size());     // NOLINT(build/unsigned)
+  header.reserved = 0;
+
+  // Write to a temporary file and rename, so that readers never map a partial table
+  auto temporary_path = table_path + ".tmp";
+  {
+    std::ofstream output(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!output) {
+      throw StaticHostTableError(ERS_HERE, table_path, "could not open output file");
+    }
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));                      // NOLINT
+    output.write(reinterpret_cast<const char*>(buckets.data()), sizeof(Bucket) * buckets.size()); // NOLINT
+    output.write(reinterpret_cast<const char*>(addresses.data()),                                // NOLINT
+                 sizeof(uint32_t) * addresses.size());                                           // NOLINT(build/unsigned)
+    output.write(strings.data(), strings.size());
+    if (!output) {
+      throw StaticHostTableError(ERS_HERE, table_path, "error while writing");
+    }
+  }
+  if (std::rename(temporary_path.c_str(), table_path.c_str()) != 0) {
+    throw StaticHostTableError(ERS_HERE, table_path, std::strerror(errno));
+  }
+}
+
+namespace {
+std::mutex g_table_mutex;
+std::shared_ptr<const StaticHostTable> g_table;
+bool g_table_initialized = false;
+} // namespace
+
+void
+set_static_host_table(const std::string& path)
+{
+  std::shared_ptr<const StaticHostTable> table;
+  if (!path.empty()) {
+    table = std::make_shared<const StaticHostTable>(path);
+  }
+
+  std::lock_guard<std::mutex> lk(g_table_mutex);
+  std::atomic_store(&g_table, table);
+  g_table_initialized = true;
+}
+
+std::shared_ptr<const StaticHostTable>
+get_static_host_table()
+{
+  static std::once_flag s_environment_flag;
+  std::call_once(s_environment_flag, []() {
+    auto path = std::getenv("DUNEDAQ_STATIC_HOST_TABLE");
+    std::lock_guard<std::mutex> lk(g_table_mutex);
+    if (path == nullptr || g_table_initialized) {
+      return;
+    }
+    try {
+      std::atomic_store(&g_table, std::shared_ptr<const StaticHostTable>(std::make_shared<const StaticHostTable>(path)));
+    } catch (StaticHostTableError const& e) {
+      ers::warning(e);
+    }
+    g_table_initialized = true;
+  });
+
+  return std::atomic_load(&g_table);
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,101 @@
+/**
+ * @file StopToken.cpp StopState implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/StopToken.hpp"
+
+#include "utilities/detail/Futex.hpp"
+
+#include <algorithm>
+#include <thread>
+
+void
+dunedaq::utilities::StopState::request_stop()
+{
+  m_stop.store(1, std::memory_order_seq_cst);
+  detail::futex_wake(m_stop);
+
+  std::unique_lock<std::mutex> lk(m_waiters_mutex);
+  for (auto* word : m_parked_words) {
+    word->fetch_add(1);
+    detail::futex_wake(*word);
+  }
+
+  // A registered waiter holds its mutex from before it checks stop_requested()
+  // until it is inside cv.wait(), so taking that mutex once after setting the
+  // flag guarantees the notification is not lost. The waiter may hold the mutex
+  // while it registers or deregisters, so only try_lock it, and drop our own
+  // lock between passes to let it make progress.
+  while (true) {
+    bool pending = false;
+    for (auto* waiter : m_waiters) {
+      if (waiter->notified) {
+        continue;
+      }
+      if (waiter->mutex->try_lock()) {
+        waiter->mutex->unlock();
+        waiter->cv->notify_all();
+        waiter->notified = true;
+      } else {
+        pending = true;
+      }
+    }
+    if (!pending) {
+      return;
+    }
+    lk.unlock();
+    std::this_thread::yield();
+    lk.lock();
+  }
+}
+
+void
+dunedaq::utilities::StopState::sleep_for(std::chrono::nanoseconds timeout)
+{
+  auto timeout_ns = timeout.count();
+  struct timespec relative;
+  relative.tv_sec = static_cast<time_t>(timeout_ns / 1000000000);
+  relative.tv_nsec = static_cast<long>(timeout_ns % 1000000000); // NOLINT(runtime/int)
+  detail::futex_wait(m_stop, 0, &relative);
+}
+
+void
+dunedaq::utilities::StopState::sleep_until(std::chrono::steady_clock::time_point deadline)
+{
+  detail::futex_wait_until(m_stop, 0, deadline);
+}
+
+void
+dunedaq::utilities::StopState::park(std::atomic<uint32_t>& word,                    // NOLINT(build/unsigned)
+                                    uint32_t expected,                              // NOLINT(build/unsigned)
+                                    std::chrono::steady_clock::time_point deadline)
+{
+  {
+    std::lock_guard<std::mutex> lk(m_waiters_mutex);
+    m_parked_words.push_back(&word);
+  }
+  // A stop requested after this check changes the word, so the wait cannot miss it
+  if (!stop_requested()) {
+    detail::futex_wait_until(word, expected, deadline);
+  }
+  std::lock_guard<std::mutex> lk(m_waiters_mutex);
+  m_parked_words.erase(std::find(m_parked_words.begin(), m_parked_words.end(), &word));
+}
+
+void
+dunedaq::utilities::StopState::add_waiter(CvWaiter* waiter)
+{
+  std::lock_guard<std::mutex> lk(m_waiters_mutex);
+  m_waiters.push_back(waiter);
+}
+
+void
+dunedaq::utilities::StopState::remove_waiter(CvWaiter* waiter)
+{
+  std::lock_guard<std::mutex> lk(m_waiters_mutex);
+  m_waiters.erase(std::remove(m_waiters.begin(), m_waiters.end(), waiter), m_waiters.end());
+}
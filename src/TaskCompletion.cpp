@@ -0,0 +1,57 @@
+/**
+ * @file TaskCompletion.cpp TaskCompletion implementation
+ *
+ * This is part of the DUNE DAQ , copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TaskCompletion.hpp"
+
+void
+dunedaq::utilities::TaskCompletion::wait()
+{
+  while (true) {
+    auto state = m_state.load(std::memory_order_acquire);
+    if (state == s_ready) {
+      return;
+    }
+    // Announce the waiter, so that signal() knows to wake us
+    if (state == s_pending && !m_state.compare_exchange_weak(state, s_pending_wait)) {
+      continue;
+    }
+    detail::futex_wait(m_state, s_pending_wait);
+  }
+}
+
+bool
+dunedaq::utilities::TaskCompletion::wait_for(std::chrono::nanoseconds timeout)
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (true) {
+    auto state = m_state.load(std::memory_order_acquire);
+    if (state == s_ready) {
+      return true;
+    }
+    auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::nanoseconds::zero()) {
+      return false;
+    }
+    if (state == s_pending && !m_state.compare_exchange_weak(state, s_pending_wait)) {
+      continue;
+    }
+    auto remaining_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining).count();
+    struct timespec relative;
+    relative.tv_sec = static_cast<time_t>(remaining_ns / 1000000000);
+    relative.tv_nsec = static_cast<long>(remaining_ns % 1000000000); // NOLINT(runtime/int)
+    detail::futex_wait(m_state, s_pending_wait, &relative);
+  }
+}
+
+void
+dunedaq::utilities::TaskCompletion::signal()
+{
+  if (m_state.exchange(s_ready, std::memory_order_acq_rel) == s_pending_wait) {
+    detail::futex_wake(m_state);
+  }
+}
@@ -0,0 +1,161 @@
+/**
+ * @file ThreadAttributes.cpp ThreadAttributes implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ThreadAttributes.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+#include "utilities/WorkerThread.hpp" // contains exception definition
+
+#include <sched.h>
+#include <sys/resource.h>
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+int
+native_policy(SchedulingPolicy policy)
+{
+  switch (policy) {
+    case SchedulingPolicy::kFifo:
+      return SCHED_FIFO;
+    case SchedulingPolicy::kRoundRobin:
+      return SCHED_RR;
+    default:
+      return SCHED_OTHER;
+  }
+}
+
+bool
+check(int rc, const std::string& what)
+{
+  if (rc != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE, "Error calling " + what + ": " + std::strerror(rc)));
+    return false;
+  }
+  return true;
+}
+} // namespace
+
+std::string
+to_string(SchedulingPolicy policy)
+{
+  switch (policy) {
+    case SchedulingPolicy::kInherit:
+      return "inherited";
+    case SchedulingPolicy::kOther:
+      return "SCHED_OTHER";
+    case SchedulingPolicy::kFifo:
+      return "SCHED_FIFO";
+    case SchedulingPolicy::kRoundRobin:
+      return "SCHED_RR";
+  }
+  return "unknown";
+}
+
+bool
+build_pthread_attr(const ThreadAttributes& attributes, pthread_attr_t& attr, bool with_scheduling)
+{
+  bool ok = check(pthread_attr_init(&attr), "pthread_attr_init");
+
+  if (with_scheduling && attributes.policy != SchedulingPolicy::kInherit) {
+    int policy = native_policy(attributes.policy);
+    int min_priority = sched_get_priority_min(policy);
+    int max_priority = sched_get_priority_max(policy);
+    if (attributes.priority < min_priority || attributes.priority > max_priority) {
+      ers::warning(ThreadingIssue(ERS_HERE,
+                                  "Priority " + std::to_string(attributes.priority) + " is outside the range " +
+                                    std::to_string(min_priority) + "-" + std::to_string(max_priority) + " of " +
+                                    to_string(attributes.policy) + ", keeping the inherited scheduling"));
+      ok = false;
+    } else {
+      sched_param param{};
+      param.sched_priority = attributes.priority;
+      // All three must succeed, otherwise the thread would silently inherit
+      bool sched_ok =
+        check(pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED), "pthread_attr_setinheritsched") &&
+        check(pthread_attr_setschedpolicy(&attr, policy), "pthread_attr_setschedpolicy") &&
+        check(pthread_attr_setschedparam(&attr, &param), "pthread_attr_setschedparam");
+      if (!sched_ok) {
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        ok = false;
+      }
+    }
+  }
+
+  if (!attributes.cpus.empty()) {
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (auto cpu : attributes.cpus) {
+      if (cpu >= 0 && cpu < CPU_SETSIZE) {
+        CPU_SET(cpu, &cpuset);
+      }
+    }
+    if (CPU_COUNT(&cpuset) == 0) {
+      ers::warning(ThreadingIssue(ERS_HERE, "Not setting CPU affinity to an empty set of CPUs"));
+      ok = false;
+    } else {
+      ok = check(pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpuset), "pthread_attr_setaffinity_np") && ok;
+    }
+  }
+
+  if (attributes.stack_size != 0) {
+    ok = check(pthread_attr_setstacksize(&attr, attributes.stack_size),
+               "pthread_attr_setstacksize(" + std::to_string(attributes.stack_size) + ")") &&
+         ok;
+  }
+
+  if (attributes.guard_size) {
+    ok = check(pthread_attr_setguardsize(&attr, *attributes.guard_size),
+               "pthread_attr_setguardsize(" + std::to_string(*attributes.guard_size) + ")") &&
+         ok;
+  }
+
+  return ok;
+}
+
+bool
+set_current_thread_nice(int nice)
+{
+  // On Linux the nice value belongs to the thread, addressed by its tid
+  if (setpriority(PRIO_PROCESS, static_cast<id_t>(ThreadTelemetry::current_tid()), nice) != 0) {
+    ers::warning(ThreadingIssue(ERS_HERE,
+                                "Error setting nice value " + std::to_string(nice) + ": " + std::strerror(errno)));
+    return false;
+  }
+  return true;
+}
+
+bool
+get_thread_scheduling(pthread_t handle, SchedulingPolicy& policy, int& priority)
+{
+  int native = 0;
+  sched_param param{};
+  if (pthread_getschedparam(handle, &native, &param) != 0) {
+    return false;
+  }
+  switch (native) {
+    case SCHED_FIFO:
+      policy = SchedulingPolicy::kFifo;
+      break;
+    case SCHED_RR:
+      policy = SchedulingPolicy::kRoundRobin;
+      break;
+    default:
+      policy = SchedulingPolicy::kOther;
+      break;
+  }
+  priority = param.sched_priority;
+  return true;
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -0,0 +1,157 @@
+/**
+ *
+ * @file ThreadTelemetry.cpp ThreadTelemetry implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ThreadTelemetry.hpp"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+
+// Add the context switch counts and CPU time of a thread of this process to stats
+void
+read_proc_task(pid_t tid, nlohmann::json& stats)
+{
+  auto task_dir = "/proc/self/task/" + std::to_string(tid);
+
+  std::ifstream status(task_dir + "/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    uint64_t value = 0; // NOLINT(build/unsigned)
+    fields >> key >> value;
+    if (key == "voluntary_ctxt_switches:") {
+      stats["voluntary_context_switches"] = value;
+    } else if (key == "nonvoluntary_ctxt_switches:") {
+      stats["involuntary_context_switches"] = value;
+    }
+  }
+
+  // utime and stime are fields 14 and 15; the command name before them may contain spaces
+  std::ifstream stat_file(task_dir + "/stat");
+  std::string stat_line;
+  std::getline(stat_file, stat_line);
+  auto close_paren = stat_line.rfind(')');
+  if (close_paren != std::string::npos) {
+    std::istringstream fields(stat_line.substr(close_paren + 2));
+    std::string field;
+    uint64_t utime = 0; // NOLINT(build/unsigned)
+    uint64_t stime = 0; // NOLINT(build/unsigned)
+    for (int ii = 3; ii < 14 && fields >> field; ++ii) {
+    }
+    if (fields >> utime >> stime) {
+      stats["cpu_time_s"] = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+    }
+  }
+}
+
+} // namespace
+
+nlohmann::json
+DurationHistogram::to_json() const
+{
+  nlohmann::json histogram = nlohmann::json::array();
+  for (size_t ii = 0; ii < s_buckets; ++ii) {
+    auto count = m_counts[ii].load(std::memory_order_relaxed);
+    if (count > 0) {
+      // Upper bound of the bucket
+      histogram.push_back({ { "lt_ns", ii == 0 ? 1 : (1ULL << ii) }, { "count", count } });
+    }
+  }
+
+  auto count = m_count.load(std::memory_order_relaxed);
+  nlohmann::json result;
+  result["count"] = count;
+  result["mean_ns"] = count == 0 ? 0.0 : static_cast<double>(m_sum_ns.load(std::memory_order_relaxed)) / count;
+  result["max_ns"] = m_max_ns.load(std::memory_order_relaxed);
+  result["histogram"] = histogram;
+  return result;
+}
+
+void
+ThreadStats::set_started(pid_t tid)
+{
+  m_tid.store(tid);
+  m_started_ns.store(ThreadTelemetry::now_ns());
+}
+
+nlohmann::json
+ThreadStats::to_json() const
+{
+  nlohmann::json stats;
+  stats["type"] = m_type;
+  stats["tid"] = m_tid.load();
+  auto started = m_started_ns.load();
+  stats["running_s"] = started == 0 ? 0.0 : static_cast<double>(ThreadTelemetry::now_ns() - started) * 1e-9;
+  stats["tasks_executed"] = m_tasks_executed.load(std::memory_order_relaxed);
+  stats["busy_s"] = static_cast<double>(m_busy_ns.load(std::memory_order_relaxed)) * 1e-9;
+  stats["idle_s"] = static_cast<double>(m_idle_ns.load(std::memory_order_relaxed)) * 1e-9;
+  stats["run_time"] = m_run_time.to_json();
+  stats["handoff_latency"] = m_handoff.to_json();
+  if (m_tid.load() != 0) {
+    read_proc_task(m_tid.load(), stats);
+  }
+  return stats;
+}
+
+ThreadTelemetry&
+ThreadTelemetry::instance()
+{
+  static ThreadTelemetry s_instance;
+  return s_instance;
+}
+
+std::shared_ptr<ThreadStats>
+ThreadTelemetry::register_thread(const std::string& name, const std::string& type)
+{
+  if (!is_enabled()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lk(m_mutex);
+  auto key = name;
+  for (int suffix = 2; !m_threads[key].expired(); ++suffix) {
+    key = name + "#" + std::to_string(suffix);
+  }
+  auto stats = std::make_shared<ThreadStats>(key, type);
+  m_threads[key] = stats;
+  return stats;
+}
+
+nlohmann::json
+ThreadTelemetry::snapshot()
+{
+  nlohmann::json result = nlohmann::json::object();
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto it = m_threads.begin(); it != m_threads.end();) {
+    if (auto stats = it->second.lock()) {
+      result[it->first] = stats->to_json();
+      ++it;
+    } else {
+      it = m_threads.erase(it);
+    }
+  }
+  return result;
+}
+
+pid_t
+ThreadTelemetry::current_tid()
+{
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -11,7 +11,9 @@
 
 #include "logging/Logging.hpp"
 
+#include <algorithm>
 #include <memory>
+#include <thread>
 #include <unistd.h>
 
 #define TRACE_NAME "TimestampEstimator" // NOLINT
@@ -25,10 +27,12 @@ TimestampEstimator::TimestampEstimator(uint32_t run_number, uint64_t clock_frequ
 }
 
 TimestampEstimator::TimestampEstimator(uint64_t clock_frequency_hz) // NOLINT(build/unsigned)
-  : m_current_timestamp_estimate(TimeSyncPoint{std::numeric_limits<uint64_t>::max(), std::chrono::time_point<std::chrono::steady_clock>()})
+  : m_current_timestamp_estimate(TimeSyncPoint{std::numeric_limits<uint64_t>::max(), std::chrono::time_point<std::chrono::steady_clock>(), static_cast<double>(clock_frequency_hz), 0, TscScale(), 0, 0.})
   , m_clock_frequency_hz(clock_frequency_hz)
+  , m_pending(s_pending_capacity)
   , m_most_recent_daq_time(0)
   , m_most_recent_system_time(0)
+  , m_drift(clock_frequency_hz, 1)
   , m_run_number(0)
   , m_received_timesync_count(0)
 {
@@ -41,29 +45,151 @@ TimestampEstimator::~TimestampEstimator()
 
 uint64_t
 TimestampEstimator::get_timestamp_estimate() const {
-  using namespace std::chrono;
-  
   TimeSyncPoint estimate = m_current_timestamp_estimate.load();
-  
-  auto delta_time_us = duration_cast<microseconds>(steady_clock::now() - estimate.system_time).count();
-      
-  const uint64_t new_timestamp =
-    estimate.daq_time + delta_time_us * m_clock_frequency_hz / 1000000;
+  if (estimate.daq_time == std::numeric_limits<uint64_t>::max()) {
+    // No TimeSync yet
+    return estimate.daq_time;
+  }
+  if (estimate.tsc_scale.multiplier != 0) {
+    return extrapolate(estimate, std::chrono::steady_clock::time_point(), TscClock::now());
+  }
+  return extrapolate(estimate, std::chrono::steady_clock::now(), 0);
+}
+
+uint64_t
+TimestampEstimator::extrapolate(const TimeSyncPoint& estimate,
+                                std::chrono::steady_clock::time_point now,
+                                uint64_t tsc_now) // NOLINT(build/unsigned)
+{
+  using namespace std::chrono;
+  uint64_t extrapolated = 0; // NOLINT(build/unsigned)
+  double elapsed = 0.;
+  if (estimate.tsc_scale.multiplier != 0) {
+    // The counter may have been read before the estimate was loaded; never extrapolate backwards
+    auto delta_tsc = static_cast<int64_t>(tsc_now - estimate.tsc);
+    if (delta_tsc > 0) {
+      extrapolated = estimate.tsc_scale.convert(static_cast<uint64_t>(delta_tsc));
+      elapsed = static_cast<double>(delta_tsc);
+    }
+  } else {
+    auto delta_time_us = duration_cast<microseconds>(now - estimate.system_time).count();
+    extrapolated = static_cast<uint64_t>(static_cast<double>(delta_time_us) * estimate.frequency_hz / 1e6);
+    elapsed = static_cast<double>(delta_time_us);
+  }
+  if (estimate.slew_ticks != 0) {
+    // The rate stays at or above s_min_slew_rate of frequency_hz, so this never goes back
+    extrapolated -= elapsed >= estimate.slew_span
+                      ? estimate.slew_ticks
+                      : static_cast<uint64_t>(static_cast<double>(estimate.slew_ticks) * elapsed / estimate.slew_span);
+  }
+  return estimate.daq_time + extrapolated;
+}
 
-  return new_timestamp;
+TimestampEstimator::TimeSyncPoint
+TimestampEstimator::make_estimate(uint64_t daq_time, // NOLINT(build/unsigned)
+                                  double frequency_hz,
+                                  std::chrono::steady_clock::time_point now,
+                                  uint64_t tsc_now,        // NOLINT(build/unsigned)
+                                  uint64_t slew_ticks,     // NOLINT(build/unsigned)
+                                  double slew_span_us) const
+{
+  auto tsc_scale = TscScale::for_frequency(frequency_hz, m_tsc_frequency_hz);
+  auto slew_span = tsc_scale.multiplier != 0 ? slew_span_us * m_tsc_frequency_hz / 1e6 : slew_span_us;
+  return TimeSyncPoint{ daq_time, now, frequency_hz, tsc_now, tsc_scale, slew_ticks, slew_span };
+}
 
+void
+TimestampEstimator::claim_ingestion()
+{
+  while (m_ingesting.exchange(true)) {
+    std::this_thread::yield();
+  }
 }
 
+bool
+TimestampEstimator::set_use_tsc(bool use)
+{
+  auto tsc_frequency_hz = use ? TscClock::get_frequency_hz() : 0.;
+  claim_ingestion();
+  m_tsc_frequency_hz = tsc_frequency_hz;
 
+  // Restart the estimate from where it has got to, so that readers change clocks straight away
+  auto estimate = m_current_timestamp_estimate.load();
+  if (estimate.daq_time != std::numeric_limits<uint64_t>::max()) {
+    auto now = std::chrono::steady_clock::now();
+    auto tsc_now = TscClock::now();
+    m_current_timestamp_estimate.store(
+      make_estimate(extrapolate(estimate, now, tsc_now), estimate.frequency_hz, now, tsc_now));
+  }
+  ingest_pending(true);
+  return tsc_frequency_hz > 0.;
+}
+
+void
+TimestampEstimator::set_drift_window(size_t window)
+{
+  claim_ingestion();
+  m_drift.reset(window);
+  m_most_recent_daq_time = 0;
+  m_most_recent_system_time = 0;
+  ingest_pending(true);
+}
 
 void
 TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_time)
 {
-    using namespace std::chrono;
+  if (!m_pending.try_push(TimeSyncSample{ daq_time, system_time })) {
+    m_dropped_timesync_count.fetch_add(1, std::memory_order_relaxed);
+    TLOG_DEBUG(TLVL_TIME_SYNC_NOTES) << "Dropping TimeSync timestamp = " << daq_time << ", "
+                                     << s_pending_capacity << " are already waiting to be ingested";
+    return;
+  }
+  m_queued_count.fetch_add(1);
+  ingest_pending(false);
+}
 
-  std::scoped_lock<std::mutex> lk(m_datapoint_mutex);
+void
+TimestampEstimator::ingest_pending(bool claimed)
+{
+  // Whoever holds m_ingesting drains the ring; everyone else just leaves
+  // their TimeSync queued. No thread ever waits for another.
+  TimeSyncSample sample;
+  while (claimed || !m_ingesting.exchange(true)) {
+    claimed = false;
+    auto drained_from = m_ingested_count;
+    while (m_pending.try_pop(sample)) {
+      ingest(sample);
+      ++m_ingested_count;
+    }
+    auto ingested = m_ingested_count;
+    m_ingesting.store(false);
 
-  // First, update the latest timestamp
+    // A drain which found nothing stopped at a TimeSync still being written.
+    // Its sender counts it once written and then tries the flag itself, so
+    // it ingests that TimeSync and any queued behind it; retrying here would
+    // only spin until then.
+    if (ingested == drained_from) {
+      return;
+    }
+
+    // A sender which counted its TimeSync after the drain, but found the flag
+    // still held, has left it to us. One which has not counted it yet (so it
+    // may already be ingested) will try the flag itself.
+    if (static_cast<int64_t>(m_queued_count.load() - ingested) <= 0) {
+      return;
+    }
+  }
+}
+
+void
+TimestampEstimator::ingest(const TimeSyncSample& sample)
+{
+  using namespace std::chrono;
+
+  auto daq_time = sample.daq_time;
+  auto system_time = sample.system_time;
+
+  // First, update the latest timestamp. Only this thread stores estimates.
   TimeSyncPoint estimate = m_current_timestamp_estimate.load();
   int64_t diff = estimate.daq_time - daq_time;
   TLOG_DEBUG(TLVL_TIME_SYNC_PROPERTIES) << "Got a TimeSync timestamp = " << daq_time
@@ -74,6 +200,7 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
       daq_time > m_most_recent_daq_time) {
     m_most_recent_daq_time = daq_time;
     m_most_recent_system_time = system_time;
+    m_drift.add(daq_time, system_time);
   }
 
   if (m_most_recent_daq_time != std::numeric_limits<uint64_t>::max()) {
@@ -83,6 +210,7 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
     auto time_now =
       static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count()); // NOLINT
     auto steady_time_now = steady_clock::now();
+    auto tsc_now = TscClock::now();
 
     // (PAR 2021-07-22) We only want to _increase_ our timestamp
     // estimate, not _decrease_ it, so we only attempt the update if
@@ -107,8 +235,32 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
       if (delta_time > 1e6)
         ers::warning(LateTimeSync(ERS_HERE, delta_time));
 
-      const uint64_t new_timestamp =
-        m_most_recent_daq_time + delta_time * m_clock_frequency_hz / 1000000;
+      uint64_t new_timestamp = m_drift.predict(time_now);
+      double frequency_hz = m_drift.get_frequency_hz();
+      uint64_t slew_ticks = 0; // NOLINT(build/unsigned)
+      double slew_span_us = 0.;
+
+      // With a fitted frequency, a new fit may lag the estimate extrapolated
+      // with the previous one. Rather than step the estimate back, carry on
+      // from where it has got to. A lead beyond the noise of the fit is taken
+      // off over about one TimeSync interval, after which the estimate runs
+      // with the fit even if no further TimeSync arrives.
+      if (m_drift.get_window() > 1 && estimate.daq_time != std::numeric_limits<uint64_t>::max()) {
+        auto extrapolated = extrapolate(estimate, steady_time_now, tsc_now);
+        if (extrapolated > new_timestamp) {
+          auto lead = extrapolated - new_timestamp;
+          auto ticks_per_us = frequency_hz / 1e6;
+          auto threshold = s_slew_threshold_rms * m_drift.get_residual_rms_ticks() + ticks_per_us;
+          if (static_cast<double>(lead) > threshold) {
+            slew_ticks = lead;
+            slew_span_us = std::max(m_drift.get_interval_us(),
+                                    static_cast<double>(lead) / (ticks_per_us * (1. - s_min_slew_rate)));
+            TLOG_DEBUG(TLVL_TIME_SYNC_NOTES) << "Estimate is " << lead << " ticks ahead of the fit, slewing over "
+                                             << slew_span_us << " us";
+          }
+          new_timestamp = extrapolated;
+        }
+      }
 
       // Don't ever decrease the timestamp; just wait until enough
       // time passes that we want to increase it
@@ -123,10 +275,12 @@ TimestampEstimator::add_timestamp_datapoint(uint64_t daq_time, uint64_t system_t
           << (static_cast<double>(m_most_recent_daq_time % (m_clock_frequency_hz * 1000)) /
               static_cast<double>(m_clock_frequency_hz))
           << " sec), delta_time is " << delta_time << " usec, clock_freq is " << m_clock_frequency_hz << " Hz";
-        m_current_timestamp_estimate.store(TimeSyncPoint{new_timestamp, steady_time_now});
+        m_current_timestamp_estimate.store(
+          make_estimate(new_timestamp, frequency_hz, steady_time_now, tsc_now, slew_ticks, slew_span_us));
+        notify_waiters();
       } else {
         TLOG_DEBUG(TLVL_TIME_SYNC_NOTES) << "Not updating timestamp estimate backwards from "
-                                         << m_current_timestamp_estimate.load().daq_time << " to " << new_timestamp;
+                                         << estimate.daq_time << " to " << new_timestamp;
       }
     }
   }
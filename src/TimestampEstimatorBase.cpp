@@ -8,29 +8,97 @@
 
 #include "utilities/TimestampEstimatorBase.hpp"
 
-#include <thread>
+#include "utilities/detail/Futex.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 namespace dunedaq {
 namespace utilities {
+
+namespace {
+// Longest sleep between checks of a continue flag, or of an estimator which cannot predict its timestamps
+constexpr std::chrono::milliseconds s_poll_interval(10);
+
+// Estimates advance in whole microseconds, so wake up just after the one which reaches the target
+constexpr std::chrono::microseconds s_estimate_granularity(1);
+
+// Longest predicted sleep; a new estimate wakes the wait earlier
+constexpr double s_max_sleep_seconds = 3600.;
+} // namespace
+
 TimestampEstimatorBase::WaitStatus
 TimestampEstimatorBase::wait_for_valid_timestamp(std::atomic<bool>& continue_flag)
 {
-  while (continue_flag.load() && get_timestamp_estimate() == std::numeric_limits<uint64_t>::max()) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-  }
-
-  return continue_flag.load() ? TimestampEstimatorBase::kFinished : TimestampEstimatorBase::kInterrupted;
+  return wait_for(0, &continue_flag, nullptr);
 }
 
 TimestampEstimatorBase::WaitStatus
 TimestampEstimatorBase::wait_for_timestamp(uint64_t ts, std::atomic<bool>& continue_flag)
 {
-  while (continue_flag.load() &&
-         (get_timestamp_estimate() < ts || get_timestamp_estimate() == std::numeric_limits<uint64_t>::max())) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  return wait_for(ts, &continue_flag, nullptr);
+}
+
+TimestampEstimatorBase::WaitStatus
+TimestampEstimatorBase::wait_for_valid_timestamp(const StopToken& stop)
+{
+  return wait_for(0, nullptr, &stop);
+}
+
+TimestampEstimatorBase::WaitStatus
+TimestampEstimatorBase::wait_for_timestamp(uint64_t ts, const StopToken& stop)
+{
+  return wait_for(ts, nullptr, &stop);
+}
+
+void
+TimestampEstimatorBase::notify_waiters()
+{
+  // Pairs with the waiters' increment of m_waiters: either we see the waiter
+  // or it sees the new generation
+  m_estimate_generation.fetch_add(1);
+  if (m_waiters.load() != 0) {
+    detail::futex_wake(m_estimate_generation);
   }
+}
 
-  return continue_flag.load() ? TimestampEstimatorBase::kFinished : TimestampEstimatorBase::kInterrupted;
+TimestampEstimatorBase::WaitStatus
+TimestampEstimatorBase::wait_for(uint64_t ts, std::atomic<bool>* continue_flag, const StopToken* stop)
+{
+  using namespace std::chrono;
+  const uint64_t invalid = std::numeric_limits<uint64_t>::max(); // NOLINT(build/unsigned)
+  const auto frequency = get_clock_frequency_hz();
+
+  m_waiters.fetch_add(1);
+  WaitStatus status = kInterrupted;
+  while (continue_flag ? continue_flag->load() : !stop->stop_requested()) {
+    // Read before the estimate, so that a newer estimate makes the sleep return at once
+    auto generation = m_estimate_generation.load();
+    auto estimate = get_timestamp_estimate();
+    if (estimate != invalid && estimate >= ts) {
+      status = kFinished;
+      break;
+    }
+
+    // Without an estimate there is nothing to predict from; sleep until one is published
+    auto now = steady_clock::now();
+    auto deadline = steady_clock::time_point::max();
+    if (frequency == 0) {
+      deadline = now + s_poll_interval;
+    } else if (estimate != invalid) {
+      auto seconds = std::min(static_cast<double>(ts - estimate) / static_cast<double>(frequency), s_max_sleep_seconds);
+      deadline = now + duration_cast<steady_clock::duration>(duration<double>(seconds)) + s_estimate_granularity;
+    }
+
+    if (continue_flag) {
+      detail::futex_wait_until(m_estimate_generation, generation, std::min(deadline, now + s_poll_interval));
+    } else {
+      stop->park_until(m_estimate_generation, generation, deadline);
+    }
+  }
+  m_waiters.fetch_sub(1);
+  return status;
 }
 
 } // namespace utilities
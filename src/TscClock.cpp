@@ -0,0 +1,106 @@
+/**
+ * @file TscClock.cpp TscClock implementation
+ *
+ * This is part of the DUNE DAQ Software Suite, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TscClock.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include <time.h>
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+struct CalibrationPoint
+{
+  uint64_t tsc; // NOLINT(build/unsigned)
+  int64_t monotonic_ns;
+};
+
+// A CLOCK_MONOTONIC reading and the TSC half-way through it, from the
+// quickest of a few tries so that an interrupt does not skew it
+CalibrationPoint
+read_calibration_point()
+{
+  CalibrationPoint best{ 0, 0 };
+  uint64_t best_width = std::numeric_limits<uint64_t>::max(); // NOLINT(build/unsigned)
+  for (int ii = 0; ii < 8; ++ii) {
+    struct timespec ts;
+    auto before = TscClock::now();
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    auto after = TscClock::now();
+    if (after - before < best_width) {
+      best_width = after - before;
+      best = CalibrationPoint{ before + (after - before) / 2,
+                               static_cast<int64_t>(ts.tv_sec) * 1000000000 + static_cast<int64_t>(ts.tv_nsec) };
+    }
+  }
+  return best;
+}
+
+double
+calibrate()
+{
+  if (!TscClock::is_invariant()) {
+    return 0.;
+  }
+  auto start = read_calibration_point();
+  std::this_thread::sleep_for(std::chrono::milliseconds(TscClock::s_calibration_ms));
+  auto end = read_calibration_point();
+  return static_cast<double>(end.tsc - start.tsc) * 1e9 / static_cast<double>(end.monotonic_ns - start.monotonic_ns);
+}
+} // namespace
+
+bool
+TscClock::is_invariant()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  // CPUID leaf 0x80000007, EDX bit 8: invariant TSC
+  unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) == 0 || eax < 0x80000007) {
+    return false;
+  }
+  __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+  return (edx & (1U << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+double
+TscClock::get_frequency_hz()
+{
+  static const double frequency_hz = calibrate();
+  return frequency_hz;
+}
+
+TscScale
+TscScale::for_frequency(double frequency_hz, double tsc_frequency_hz)
+{
+  TscScale scale;
+  if (frequency_hz <= 0. || tsc_frequency_hz <= 0.) {
+    return scale;
+  }
+  auto ratio = frequency_hz / tsc_frequency_hz;
+  scale.shift = 63;
+  while (scale.shift > 0 && std::ldexp(ratio, static_cast<int>(scale.shift)) >= std::ldexp(1., 63)) {
+    --scale.shift;
+  }
+  scale.multiplier = static_cast<uint64_t>(std::llround(std::ldexp(ratio, static_cast<int>(scale.shift)))); // NOLINT
+  return scale;
+}
+
+} // namespace utilities
+} // namespace dunedaq
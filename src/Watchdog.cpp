@@ -0,0 +1,288 @@
+/**
+ *
+ * @file Watchdog.cpp Heartbeat and Watchdog implementation
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Watchdog.hpp"
+
+#include "utilities/Issues.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include "logging/Logging.hpp"
+
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+namespace dunedaq {
+namespace utilities {
+
+namespace {
+
+constexpr int s_max_frames = 64;
+
+// Filled in by the signal handler of the thread being traced. Each capture
+// sends its own number with the signal and sets state to it; the handler
+// moves state to number + kWriting and then number + kDone, and does nothing
+// if state no longer holds its number, i.e. for a signal delivered after its
+// capture timed out.
+struct StackCapture
+{
+  static constexpr uintptr_t kWriting = 1;
+  static constexpr uintptr_t kDone = 2;
+  static constexpr uintptr_t kStep = 4; // Capture numbers are multiples of this
+
+  std::atomic<uintptr_t> state{ 0 };
+  uintptr_t next_number{ kStep }; // Only touched with s_capture_mutex held
+  void* frames[s_max_frames];
+  int depth{ 0 };
+};
+
+StackCapture s_capture;
+std::mutex s_capture_mutex; // One capture at a time
+int s_capture_signal = 0;   // 0 until the handler is installed, -1 if it cannot be
+
+void
+capture_handler(int, siginfo_t* info, void*)
+{
+  auto number = reinterpret_cast<uintptr_t>(info->si_value.sival_ptr); // NOLINT
+  if (!s_capture.state.compare_exchange_strong(number, number + StackCapture::kWriting)) {
+    return;
+  }
+  s_capture.depth = backtrace(s_capture.frames, s_max_frames);
+  s_capture.state.store(number + StackCapture::kDone, std::memory_order_release);
+}
+
+// Called with s_capture_mutex held
+bool
+install_capture_handler()
+{
+  if (s_capture_signal == 0) {
+    int signal_number = SIGRTMIN + 4;
+    struct sigaction old_action;
+    sigaction(signal_number, nullptr, &old_action);
+    if ((old_action.sa_flags & SA_SIGINFO) != 0 || old_action.sa_handler != SIG_DFL) {
+      ers::warning(ThreadingIssue(ERS_HERE,
+                                  "Signal " + std::to_string(signal_number) +
+                                    " already has a handler, stalled threads will not be traced"));
+      s_capture_signal = -1;
+      return false;
+    }
+
+    // backtrace() loads libgcc on its first call, which must not happen in a signal handler
+    void* frames[1];
+    backtrace(frames, 1);
+
+    struct sigaction action = {};
+    action.sa_sigaction = capture_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(signal_number, &action, nullptr);
+    s_capture_signal = signal_number;
+  }
+  return s_capture_signal > 0;
+}
+
+} // namespace
+
+void
+Heartbeat::attach_current_thread()
+{
+  m_tid.store(ThreadTelemetry::current_tid());
+}
+
+Watchdog&
+Watchdog::instance()
+{
+  static Watchdog s_instance;
+  return s_instance;
+}
+
+Watchdog::Watchdog(std::chrono::milliseconds sample_period)
+  : m_sample_period_ms(sample_period.count())
+{}
+
+Watchdog::~Watchdog()
+{
+  if (m_thread && m_thread->thread_running()) {
+    m_thread->stop_working_thread();
+  }
+}
+
+void
+Watchdog::watch(const std::shared_ptr<Heartbeat>& heartbeat)
+{
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto const& watched : m_watched) {
+    if (watched.heartbeat.lock() == heartbeat) {
+      return;
+    }
+  }
+  Watched watched;
+  watched.heartbeat = heartbeat;
+  m_watched.push_back(watched);
+
+  if (!m_thread) {
+    m_thread = std::make_unique<WorkerThread>([this](const StopToken& stop) {
+      while (stop.wait_for(std::chrono::milliseconds(m_sample_period_ms.load()))) {
+        sample();
+      }
+    });
+    m_thread->start_working_thread("watchdog");
+  }
+}
+
+void
+Watchdog::sample()
+{
+  struct Stall
+  {
+    std::string name;
+    pid_t tid;
+    int64_t stalled_ms;
+  };
+  std::vector<Stall> stalls;
+
+  auto now = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_watched.erase(std::remove_if(m_watched.begin(),
+                                   m_watched.end(),
+                                   [](const Watched& watched) { return watched.heartbeat.expired(); }),
+                    m_watched.end());
+
+    for (auto& watched : m_watched) {
+      auto heartbeat = watched.heartbeat.lock();
+      if (!heartbeat) {
+        continue;
+      }
+      auto count = heartbeat->get_count();
+      bool active = heartbeat->is_active();
+
+      if (active && watched.was_active) {
+        auto seconds = std::chrono::duration<double>(now - watched.last_sample).count();
+        watched.rate_hz = seconds > 0 ? static_cast<double>(count - watched.last_count) / seconds : 0.;
+      } else {
+        watched.rate_hz = 0.;
+      }
+
+      if (!active || !watched.was_active || count != watched.last_count) {
+        if (watched.stalled) {
+          TLOG() << "Worker " << heartbeat->get_name() << " is making progress again";
+        }
+        watched.last_change = now;
+        watched.stalled = false;
+      } else {
+        auto threshold = heartbeat->get_stall_threshold();
+        auto stalled_for = now - watched.last_change;
+        if (threshold.count() > 0 && !watched.stalled && stalled_for > threshold) {
+          watched.stalled = true;
+          stalls.push_back(
+            { heartbeat->get_name(),
+              heartbeat->m_tid.load(),
+              std::chrono::duration_cast<std::chrono::milliseconds>(stalled_for).count() });
+        }
+      }
+
+      watched.was_active = active;
+      watched.last_count = count;
+      watched.last_sample = now;
+    }
+  }
+
+  // Report without holding the lock, as taking a stack trace can take a while
+  for (auto const& stall : stalls) {
+    std::string stack_trace;
+    if (m_capture_stack_traces.load() && stall.tid != 0) {
+      stack_trace = capture_stack_trace(stall.tid);
+    }
+    m_stall_count.store(m_stall_count.load() + 1);
+    ers::warning(
+      WorkerStalled(ERS_HERE, stall.name, stall.stalled_ms, stack_trace.empty() ? "" : ", stack trace:\n" + stack_trace));
+  }
+}
+
+nlohmann::json
+Watchdog::snapshot()
+{
+  nlohmann::json result = nlohmann::json::object();
+  auto now = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lk(m_mutex);
+  for (auto const& watched : m_watched) {
+    auto heartbeat = watched.heartbeat.lock();
+    if (!heartbeat) {
+      continue;
+    }
+    nlohmann::json stats;
+    stats["iterations"] = heartbeat->get_count();
+    stats["rate_hz"] = watched.rate_hz;
+    stats["active"] = heartbeat->is_active();
+    stats["stalled"] = watched.stalled;
+    stats["ms_since_progress"] =
+      watched.was_active ? std::chrono::duration_cast<std::chrono::milliseconds>(now - watched.last_change).count() : 0;
+    result[heartbeat->get_name()] = stats;
+  }
+  return result;
+}
+
+std::string
+Watchdog::capture_stack_trace(pid_t tid)
+{
+  std::lock_guard<std::mutex> lk(s_capture_mutex);
+  if (!install_capture_handler()) {
+    return "";
+  }
+
+  auto number = s_capture.next_number;
+  s_capture.next_number += StackCapture::kStep;
+  s_capture.state.store(number);
+
+  siginfo_t info = {};
+  info.si_signo = s_capture_signal;
+  info.si_code = SI_QUEUE;
+  info.si_pid = getpid();
+  info.si_uid = getuid();
+  info.si_value.sival_ptr = reinterpret_cast<void*>(number); // NOLINT
+  if (syscall(SYS_rt_tgsigqueueinfo, getpid(), tid, s_capture_signal, &info) != 0) {
+    s_capture.state.store(0);
+    return "";
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+  while (s_capture.state.load(std::memory_order_acquire) != number + StackCapture::kDone) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      // Withdraw the capture, unless the handler has already started writing,
+      // in which case let it finish so that the next capture does not race it
+      auto expected = number;
+      if (s_capture.state.compare_exchange_strong(expected, 0)) {
+        return "";
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  s_capture.state.store(0);
+
+  // The first frame is the signal handler itself
+  std::ostringstream trace;
+  char** symbols = backtrace_symbols(s_capture.frames, s_capture.depth);
+  for (int ii = 1; ii < s_capture.depth; ++ii) {
+    trace << "  #" << ii - 1 << " " << (symbols ? symbols[ii] : "?") << "\n";
+  }
+  free(symbols); // NOLINT
+  return trace.str();
+}
+
+} // namespace utilities
+} // namespace dunedaq
@@ -1,12 +1,12 @@
 /**
  * @file WorkerThread.cpp WorkerThread class definitions
  *
- * WorkerThread defines a std::thread which runs the do_work()
+ * WorkerThread defines a thread which runs the do_work()
  * function as well as methods to start and stop that thread.
  * This file is intended to help reduce code duplication for the common
- * task of starting and stopping threads. As in artdaq, std::thread may
- * be replaced by boost::thread to allow setting the stack size at a
- * later date if that functionality is found to be necessary.
+ * task of starting and stopping threads. The thread is created with
+ * pthread_create so that its scheduling policy, priority, affinity and
+ * stack can be chosen with ThreadAttributes.
  *
  * This is part of the DUNE DAQ Application Framework, copyright 2020.
  * Licensing/copyright details are in the COPYING file that you should have
@@ -15,31 +15,141 @@
 
 #include "utilities/WorkerThread.hpp"
 
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <sstream>
+#include <string>
+
+namespace {
+// Exceptions escaping the work function terminate the program, as with std::thread
+void*
+run_working_thread(void* arg) noexcept
+{
+  std::unique_ptr<std::function<void()>> body(static_cast<std::function<void()>*>(arg));
+  (*body)();
+  return nullptr;
+}
+} // namespace
+
 dunedaq::utilities::WorkerThread::WorkerThread(std::function<void(std::atomic<bool>&)> do_work)
   : m_thread_running(false)
-  , m_working_thread(nullptr)
   , m_do_work(do_work)
+  , m_heartbeat(std::make_shared<Heartbeat>("noname"))
 {}
 
+dunedaq::utilities::WorkerThread::WorkerThread(std::function<void(const StopToken&)> do_work)
+  : m_thread_running(false)
+  , m_do_work([this, do_work](std::atomic<bool>&) { do_work(get_stop_token()); })
+  , m_heartbeat(std::make_shared<Heartbeat>("noname"))
+{}
+
+dunedaq::utilities::WorkerThread::WorkerThread(const PeriodicOptions& options,
+                                               std::function<void(const PeriodicTick&)> do_tick)
+  : WorkerThread([this, options, do_tick](const StopToken& stop) {
+    PeriodicTimer timer(options, m_periodic_stats.get());
+    auto& heartbeat = get_heartbeat();
+    PeriodicTick tick;
+    while (timer.wait_next(stop, tick)) {
+      heartbeat.beat();
+      do_tick(tick);
+    }
+  })
+{
+  m_periodic_stats = std::make_unique<PeriodicStats>();
+}
+
+dunedaq::utilities::WorkerThread::~WorkerThread()
+{
+  // Destroying a WorkerThread which was not stopped is a programming error,
+  // reported the way a joinable std::thread would report it
+  if (m_joinable) {
+    std::terminate();
+  }
+}
+
 void
-dunedaq::utilities::WorkerThread::start_working_thread(const std::string& name)
+dunedaq::utilities::WorkerThread::start_working_thread(const std::string& name, const ThreadAttributes& attributes)
 {
   if (thread_running()) {
     throw ThreadingIssue(ERS_HERE,
                          "Attempted to start working thread "
                          "when it is already running!");
   }
+  m_stop_state.reset();
   m_thread_running = true;
-  m_working_thread.reset(new std::thread([&] { m_do_work(std::ref(m_thread_running)); }));
-  auto handle = m_working_thread->native_handle();
-  auto rc = pthread_setname_np(handle, name.c_str());
+  // A restart under the same name keeps accumulating into the same statistics
+  if (!m_stats || m_stats->get_name() != name) {
+    m_stats = ThreadTelemetry::instance().register_thread(name, "WorkerThread");
+  }
+  if (m_heartbeat->get_name() != name) {
+    m_heartbeat = std::make_shared<Heartbeat>(name);
+  }
+  m_heartbeat->set_stall_threshold(m_stall_threshold);
+  m_heartbeat->set_active(true);
+  if (m_stall_threshold.count() > 0) {
+    Watchdog::instance().watch(m_heartbeat);
+  }
+  auto body = std::make_unique<std::function<void()>>(
+    [this, name, placement = m_placement, stats = m_stats, heartbeat = m_heartbeat, nice = attributes.nice] {
+      heartbeat->attach_current_thread();
+      // Named by the thread itself, as a high-priority thread may finish before
+      // pthread_create returns
+      if (pthread_setname_np(pthread_self(), name.c_str()) != 0) {
+        std::ostringstream s;
+        s << "The name " << name << " provided for the thread is too long.";
+        ers::warning(ThreadingIssue(ERS_HERE, s.str()));
+      }
+      if (stats) {
+        stats->set_started(ThreadTelemetry::current_tid());
+      }
+      if (!placement.cpus.empty() || placement.memory_policy != MemoryPolicy::kNone) {
+        apply_placement_to_current_thread(placement);
+      }
+      if (nice) {
+        set_current_thread_nice(*nice);
+      }
+      m_do_work(std::ref(m_thread_running));
+    });
+
+  pthread_attr_t attr;
+  build_pthread_attr(attributes, attr);
+  int rc = pthread_create(&m_working_thread, &attr, &run_working_thread, body.get());
+  pthread_attr_destroy(&attr);
+  if (rc != 0 && attributes.policy != SchedulingPolicy::kInherit) {
+    // Typically EPERM, for lack of CAP_SYS_NICE
+    ers::warning(ThreadingIssue(ERS_HERE,
+                                "Could not start thread " + name + " with " + to_string(attributes.policy) +
+                                  " priority " + std::to_string(attributes.priority) + " (" + std::strerror(rc) +
+                                  "), starting it with the inherited scheduling"));
+    build_pthread_attr(attributes, attr, false);
+    rc = pthread_create(&m_working_thread, &attr, &run_working_thread, body.get());
+    pthread_attr_destroy(&attr);
+  }
   if (rc != 0) {
-    std::ostringstream s;
-    s << "The name " << name << " provided for the thread is too long.";
-    ers::warning(ThreadingIssue(ERS_HERE, s.str()));
+    m_thread_running = false;
+    m_heartbeat->set_active(false);
+    throw ThreadingIssue(ERS_HERE, "Error creating thread " + name + ": " + std::strerror(rc));
+  }
+  body.release(); // Now owned by the thread
+  m_joinable = true;
+}
+
+void
+dunedaq::utilities::WorkerThread::set_placement(const ThreadPlacement& placement)
+{
+  m_placement = placement;
+  if (thread_running() && !placement.cpus.empty()) {
+    set_thread_affinity(m_working_thread, placement.cpus);
   }
 }
 
+void
+dunedaq::utilities::WorkerThread::set_stall_threshold(std::chrono::milliseconds threshold)
+{
+  m_stall_threshold = threshold;
+}
+
 void
 dunedaq::utilities::WorkerThread::stop_working_thread()
 {
@@ -49,12 +159,16 @@ dunedaq::utilities::WorkerThread::stop_working_thread()
                          "when it is not running!");
   }
   m_thread_running = false;
+  m_heartbeat->set_active(false);
+  m_stop_state.request_stop();
 
-  if (m_working_thread->joinable()) {
-    try {
-      m_working_thread->join();
-    } catch (std::system_error const& e) {
-      throw ThreadingIssue(ERS_HERE, std::string("Error while joining thread, ") + e.what());
+  if (m_joinable) {
+    m_joinable = false;
+    int rc = pthread_join(m_working_thread, nullptr);
+    // The work function may have marked its heartbeat active again while stopping
+    m_heartbeat->set_active(false);
+    if (rc != 0) {
+      throw ThreadingIssue(ERS_HERE, std::string("Error while joining thread, ") + std::strerror(rc));
     }
   } else {
     throw ThreadingIssue(ERS_HERE, "Thread not in joinable state during working thread stop!");
@@ -0,0 +1,159 @@
+/**
+ * @file drift_estimation_benchmark.cpp
+ *
+ * Offline accuracy of DriftEstimator on synthetic TimeSync streams: a DAQ
+ * clock with a known frequency offset, TimeSyncs whose system time stamps
+ * carry Gaussian jitter, and the estimate checked against the true DAQ time
+ * at ten points between consecutive TimeSyncs. A window of 1 is the
+ * extrapolation from the latest TimeSync at the nominal frequency.
+ *
+ * The same streams are then fed in real time to a TimestampEstimator, which
+ * reads the clocks itself, and its published estimate is checked the same
+ * way. This includes the slewing which keeps the estimate from going back.
+ *
+ * Usage: drift_estimation_benchmark [n_timesyncs [period_us [n_realtime [realtime_period_us]]]]
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/DriftEstimator.hpp"
+#include "utilities/TimestampEstimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+
+using namespace dunedaq::utilities;
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_timesyncs = 600;
+  double period_us = 1e6;
+  size_t n_realtime = 100;
+  double realtime_period_us = 2e4;
+  if (argc > 1) {
+    n_timesyncs = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    period_us = std::stod(argv[2]);
+  }
+  if (argc > 3) {
+    n_realtime = std::stoul(argv[3]);
+  }
+  if (argc > 4) {
+    realtime_period_us = std::stod(argv[4]);
+  }
+
+  const uint64_t nominal_hz = 62500000; // NOLINT(build/unsigned)
+  const double nominal_ticks_per_us = static_cast<double>(nominal_hz) / 1e6;
+  const uint64_t system_start = 1700000000000000ULL; // NOLINT(build/unsigned)
+  const uint64_t daq_start = 100000000000000ULL;     // NOLINT(build/unsigned)
+
+  std::cout << n_timesyncs << " TimeSyncs " << period_us / 1e3 << " ms apart, errors in us\n";
+  std::printf("%10s %12s %8s %10s %10s\n", "drift ppm", "jitter us", "window", "rms", "max");
+
+  for (double drift_ppm : { 0., 50., 200. }) {
+    for (double jitter_us : { 0., 20., 100. }) {
+      for (size_t window : { 1, 8, 32 }) {
+        std::mt19937_64 generator(1234);
+        std::normal_distribution<double> jitter(0., jitter_us > 0 ? jitter_us : 1.);
+        const double true_ticks_per_us = nominal_ticks_per_us * (1. + drift_ppm * 1e-6);
+        auto true_daq_time = [&](double system_us) {
+          return static_cast<double>(daq_start) + (system_us - static_cast<double>(system_start)) * true_ticks_per_us;
+        };
+
+        DriftEstimator estimator(nominal_hz, window);
+        double sum_squares = 0.;
+        double max_error = 0.;
+        size_t n_errors = 0;
+        for (size_t ii = 0; ii < n_timesyncs; ++ii) {
+          double system_us = static_cast<double>(system_start) + static_cast<double>(ii) * period_us;
+          double stamped_us = system_us + (jitter_us > 0 ? jitter(generator) : 0.);
+          estimator.add(static_cast<uint64_t>(true_daq_time(system_us)), static_cast<uint64_t>(stamped_us)); // NOLINT
+
+          // Skip the first 32, while the largest window fills up
+          if (ii < 32) {
+            continue;
+          }
+          for (int jj = 1; jj <= 10; ++jj) {
+            double query_us = system_us + period_us * jj / 10.;
+            auto predicted = estimator.predict(static_cast<uint64_t>(query_us)); // NOLINT(build/unsigned)
+            double error_us = (static_cast<double>(predicted) - true_daq_time(query_us)) / nominal_ticks_per_us;
+            sum_squares += error_us * error_us;
+            max_error = std::max(max_error, std::fabs(error_us));
+            ++n_errors;
+          }
+        }
+        std::printf("%10.0f %12.0f %8zu %10.2f %10.2f\n",
+                    drift_ppm,
+                    jitter_us,
+                    window,
+                    std::sqrt(sum_squares / static_cast<double>(n_errors)),
+                    max_error);
+      }
+    }
+  }
+
+  std::cout << "\nTimestampEstimator, " << n_realtime << " TimeSyncs " << realtime_period_us / 1e3
+            << " ms apart in real time, errors in us\n";
+  std::printf("%10s %12s %8s %10s %10s\n", "drift ppm", "jitter us", "window", "rms", "max");
+
+  auto now_us = []() {
+    using namespace std::chrono;
+    return static_cast<double>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+  };
+  for (double drift_ppm : { 0., 200. }) {
+    for (double jitter_us : { 0., 20. }) {
+      for (size_t window : { 1, 16 }) {
+        std::mt19937_64 generator(1234);
+        std::normal_distribution<double> jitter(0., jitter_us > 0 ? jitter_us : 1.);
+        const double true_ticks_per_us = nominal_ticks_per_us * (1. + drift_ppm * 1e-6);
+        const double start_us = now_us();
+        auto true_daq_time = [&](double system_us) {
+          return static_cast<double>(daq_start) + (system_us - start_us) * true_ticks_per_us;
+        };
+
+        TimestampEstimator estimator(nominal_hz);
+        estimator.set_drift_window(window);
+        double sum_squares = 0.;
+        double max_error = 0.;
+        size_t n_errors = 0;
+        for (size_t ii = 0; ii < n_realtime; ++ii) {
+          double system_us = now_us();
+          double stamped_us = system_us + (jitter_us > 0 ? jitter(generator) : 0.);
+          estimator.add_timestamp_datapoint(static_cast<uint64_t>(true_daq_time(system_us)),  // NOLINT
+                                            static_cast<uint64_t>(stamped_us));               // NOLINT
+
+          for (int jj = 1; jj <= 10; ++jj) {
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(realtime_period_us / 10.)));
+            // Skip the first 16, while the window fills up
+            if (ii < 16) {
+              continue;
+            }
+            auto estimate = estimator.get_timestamp_estimate();
+            double error_us = (static_cast<double>(estimate) - true_daq_time(now_us())) / nominal_ticks_per_us;
+            sum_squares += error_us * error_us;
+            max_error = std::max(max_error, std::fabs(error_us));
+            ++n_errors;
+          }
+        }
+        std::printf("%10.0f %12.0f %8zu %10.2f %10.2f\n",
+                    drift_ppm,
+                    jitter_us,
+                    window,
+                    std::sqrt(sum_squares / static_cast<double>(n_errors)),
+                    max_error);
+      }
+    }
+  }
+  return 0;
+}
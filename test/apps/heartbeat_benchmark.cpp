@@ -0,0 +1,75 @@
+/**
+ * @file heartbeat_benchmark.cpp
+ *
+ * Measure the cost of Heartbeat::beat() in a tight loop, while a Watchdog
+ * samples it, against an empty loop and against a locked atomic increment
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Watchdog.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace dunedaq::utilities;
+
+namespace {
+// Keep the compiler from removing or merging the loop iterations
+inline void
+compiler_barrier()
+{
+  asm volatile("" ::: "memory");
+}
+
+template<typename Body>
+double
+ns_per_iteration(size_t iterations, Body body)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    body();
+    compiler_barrier();
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+         static_cast<double>(iterations);
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t iterations = 200000000;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+
+  Watchdog watchdog(std::chrono::milliseconds(1));
+  auto heartbeat = std::make_shared<Heartbeat>("benchmark");
+  heartbeat->set_stall_threshold(std::chrono::seconds(10));
+  heartbeat->set_active(true);
+  heartbeat->attach_current_thread();
+  watchdog.watch(heartbeat);
+
+  std::atomic<uint64_t> locked_counter{ 0 }; // NOLINT(build/unsigned)
+
+  auto empty = ns_per_iteration(iterations, []() {});
+  auto beat = ns_per_iteration(iterations, [&]() { heartbeat->beat(); });
+  auto locked = ns_per_iteration(iterations, [&]() { locked_counter.fetch_add(1, std::memory_order_relaxed); });
+
+  std::cout << iterations << " iterations, watchdog sampling every 1 ms\n";
+  std::printf("empty loop             %6.3f ns/iteration\n", empty);
+  std::printf("Heartbeat::beat()      %6.3f ns/iteration (+%.3f)\n", beat, beat - empty);
+  std::printf("atomic fetch_add       %6.3f ns/iteration (+%.3f)\n", locked, locked - empty);
+  std::cout << "Watchdog saw " << watchdog.snapshot()["benchmark"]["iterations"] << " beats\n";
+
+  heartbeat->set_active(false);
+  return 0;
+}
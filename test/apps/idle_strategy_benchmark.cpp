@@ -0,0 +1,119 @@
+/**
+ * @file idle_strategy_benchmark.cpp
+ *
+ * For each IdleStrategy mode, measure how long a consumer takes to notice an
+ * event posted at irregular intervals, against the CPU time the consumer
+ * burns while waiting for it
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/IdleStrategy.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+int64_t
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+
+int64_t
+thread_cpu_ns()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t events = 2000;
+  if (argc > 1) {
+    events = std::stoul(argv[1]);
+  }
+
+  std::cout << events << " events, 50-1000 us apart\n";
+  std::printf("%-8s %10s %10s %10s %10s %8s   %s\n", "mode", "p50 (us)", "p99 (us)", "max (us)", "cpu (ms)", "cpu %", "phases");
+
+  for (auto mode : { IdleMode::kSpin, IdleMode::kBackoff, IdleMode::kLadder, IdleMode::kPark }) {
+    IdleOptions options;
+    options.mode = mode;
+    IdleStrategy idle(options);
+
+    std::atomic<int64_t> posted_ns{ 0 }; // Time of the latest event not yet seen, 0 if none
+    std::vector<int64_t> latency_ns;
+    latency_ns.reserve(events);
+    int64_t cpu_ns = 0;
+
+    WorkerThread consumer([&](const StopToken& stop) {
+      auto cpu_start = thread_cpu_ns();
+      while (idle.wait(stop, [&]() { return posted_ns.load(std::memory_order_acquire) != 0; })) {
+        latency_ns.push_back(now_ns() - posted_ns.load());
+        posted_ns.store(0, std::memory_order_release);
+      }
+      cpu_ns = thread_cpu_ns() - cpu_start;
+    });
+    consumer.start_working_thread("consumer");
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> gap_us(50, 1000);
+    auto wall_start = std::chrono::steady_clock::now();
+    for (size_t ii = 0; ii < events; ++ii) {
+      std::this_thread::sleep_for(std::chrono::microseconds(gap_us(generator)));
+      while (posted_ns.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+      }
+      posted_ns.store(now_ns(), std::memory_order_release);
+      idle.wake();
+    }
+    while (posted_ns.load(std::memory_order_acquire) != 0) {
+      std::this_thread::yield();
+    }
+    auto wall_ns = (std::chrono::steady_clock::now() - wall_start).count();
+    consumer.stop_working_thread();
+
+    std::sort(latency_ns.begin(), latency_ns.end());
+    auto percentile = [&](double fraction) {
+      return static_cast<double>(latency_ns[static_cast<size_t>(fraction * static_cast<double>(latency_ns.size() - 1))]) /
+             1000.;
+    };
+    std::string phases;
+    for (size_t ii = 0; ii < IdleStats::s_phases; ++ii) {
+      auto phase = static_cast<IdlePhase>(ii);
+      auto time_ns = idle.get_stats().get_time_ns(phase);
+      if (time_ns > 0) {
+        phases += " " + to_string(phase) + " " + std::to_string(time_ns / 1000000) + " ms";
+      }
+    }
+    std::printf("%-8s %10.1f %10.1f %10.1f %10.1f %7.1f%%  %s\n",
+                to_string(mode).c_str(),
+                percentile(0.5),
+                percentile(0.99),
+                percentile(1.),
+                static_cast<double>(cpu_ns) / 1e6,
+                100. * static_cast<double>(cpu_ns) / static_cast<double>(wall_ns),
+                phases.c_str());
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file periodic_jitter_benchmark.cpp
+ *
+ * Measure how late each iteration of a periodic loop starts, and how far the
+ * loop drifts, for a naive work-then-sleep_for loop against a PeriodicTimer
+ * which only sleeps and one which sleeps then spins
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/PeriodicTimer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+// Stand-in for the periodic work
+void
+work(std::chrono::microseconds duration)
+{
+  auto end = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+void
+report(const std::string& label, std::vector<int64_t>& lateness_ns, std::chrono::nanoseconds drift)
+{
+  std::sort(lateness_ns.begin(), lateness_ns.end());
+  auto percentile = [&](double fraction) {
+    auto index = static_cast<size_t>(fraction * static_cast<double>(lateness_ns.size() - 1));
+    return static_cast<double>(lateness_ns[index]) / 1000.;
+  };
+  std::printf("%-24s %9.1f %9.1f %9.1f %9.1f %12.1f\n",
+              label.c_str(),
+              percentile(0.5),
+              percentile(0.99),
+              percentile(0.999),
+              percentile(1.),
+              static_cast<double>(drift.count()) / 1000.);
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t ticks = 2000;
+  std::chrono::microseconds period(1000);
+  std::chrono::microseconds work_time(100);
+  if (argc > 1) {
+    ticks = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    period = std::chrono::microseconds(std::stol(argv[2]));
+  }
+
+  std::cout << ticks << " ticks of " << period.count() << " us with " << work_time.count() << " us of work\n";
+  std::printf("%-24s %9s %9s %9s %9s %12s\n", "lateness (us)", "p50", "p99", "p99.9", "max", "drift");
+
+  std::vector<int64_t> lateness_ns(ticks);
+  StopState state;
+  StopToken stop(state);
+
+  // Lateness against the grid the loop is meant to follow; drift is where the last tick ended up
+  {
+    auto first = std::chrono::steady_clock::now() + period;
+    std::this_thread::sleep_until(first);
+    for (size_t ii = 0; ii < ticks; ++ii) {
+      lateness_ns[ii] = (std::chrono::steady_clock::now() - (first + ii * period)).count();
+      work(work_time);
+      std::this_thread::sleep_for(period);
+    }
+    report("sleep_for loop", lateness_ns, std::chrono::nanoseconds(lateness_ns.back()));
+  }
+
+  for (auto spin_window : { std::chrono::microseconds(0), std::chrono::microseconds(100) }) {
+    PeriodicOptions options;
+    options.period = period;
+    options.spin_window = spin_window;
+    options.missed_tick_policy = MissedTickPolicy::kCatchUp;
+    PeriodicTimer timer(options);
+    PeriodicTick tick;
+    for (size_t ii = 0; ii < ticks && timer.wait_next(stop, tick); ++ii) {
+      lateness_ns[ii] = (std::chrono::steady_clock::now() - tick.deadline).count();
+      work(work_time);
+    }
+    report(spin_window.count() > 0 ? "PeriodicTimer, 100us spin" : "PeriodicTimer, sleep",
+           lateness_ns,
+           std::chrono::nanoseconds(lateness_ns.back()));
+  }
+  return 0;
+}
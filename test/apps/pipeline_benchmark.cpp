@@ -0,0 +1,165 @@
+/**
+ * @file pipeline_benchmark.cpp
+ *
+ * Measure the throughput of a 4-stage Pipeline moving fixed-size records, for
+ * several batch sizes, and of the same chain built from WorkerThreads and
+ * mutex-protected queues
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Pipeline.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+constexpr size_t s_n_stages = 4;
+
+struct Record
+{
+  uint64_t sequence{ 0 };             // NOLINT(build/unsigned)
+  std::array<uint8_t, 248> payload{}; // NOLINT(build/unsigned)
+};
+
+// Touch the payload, so that the stages do some work on each record
+bool
+process(Record& record)
+{
+  record.payload[record.sequence % record.payload.size()] ^= 0x5a;
+  return true;
+}
+
+double
+time_pipeline(size_t n_records, size_t batch_size)
+{
+  Pipeline<Record> pipeline("bench");
+  for (size_t ii = 0; ii < s_n_stages; ++ii) {
+    StageConfig config{ 4096, batch_size, BackPressure::kBlock, ThreadAttributes() };
+    pipeline.add_stage("stage" + std::to_string(ii), process, config);
+  }
+  pipeline.start();
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_records; ++ii) {
+    Record record;
+    record.sequence = ii;
+    pipeline.push(std::move(record));
+  }
+  pipeline.stop(StopMode::kDrain);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// The ad-hoc alternative: each WorkerThread waits on a locked deque
+class LockedQueue
+{
+public:
+  void push(Record&& record)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_records.push_back(std::move(record));
+    }
+    m_cv.notify_one();
+  }
+
+  bool pop(Record& record, const StopToken& stop)
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (!stop.wait(lk, m_cv, [&]() { return !m_records.empty(); })) {
+      return false;
+    }
+    record = std::move(m_records.front());
+    m_records.pop_front();
+    return true;
+  }
+
+  bool empty()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_records.empty();
+  }
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<Record> m_records;
+};
+
+double
+time_locked_queues(size_t n_records)
+{
+  std::vector<std::unique_ptr<LockedQueue>> queues;
+  for (size_t ii = 0; ii < s_n_stages; ++ii) {
+    queues.emplace_back(std::make_unique<LockedQueue>());
+  }
+  std::vector<std::unique_ptr<WorkerThread>> threads;
+  for (size_t ii = 0; ii < s_n_stages; ++ii) {
+    threads.emplace_back(std::make_unique<WorkerThread>([&, ii](const StopToken& stop) {
+      Record record;
+      while (queues[ii]->pop(record, stop)) {
+        process(record);
+        if (ii + 1 < s_n_stages) {
+          queues[ii + 1]->push(std::move(record));
+        }
+      }
+    }));
+    threads.back()->start_working_thread("locked" + std::to_string(ii));
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_records; ++ii) {
+    Record record;
+    record.sequence = ii;
+    queues[0]->push(std::move(record));
+  }
+  // Drain in order, as the pipeline does
+  for (size_t ii = 0; ii < s_n_stages; ++ii) {
+    while (!queues[ii]->empty()) {
+      std::this_thread::yield();
+    }
+    threads[ii]->stop_working_thread();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_records = 2000000;
+  if (argc > 1) {
+    n_records = std::stoul(argv[1]);
+  }
+
+  std::cout << "Moving " << n_records << " records of " << sizeof(Record) << " bytes through " << s_n_stages
+            << " stages\n";
+  std::cout << "queue                   Mrecords/s   GB/s\n";
+  for (size_t batch_size : { 1, 16, 64, 256 }) {
+    auto seconds = time_pipeline(n_records, batch_size);
+    std::printf("Pipeline batch %-8zu %10.2f %6.2f\n",
+                batch_size,
+                static_cast<double>(n_records) / seconds / 1e6,
+                static_cast<double>(n_records * sizeof(Record)) / seconds / 1e9);
+  }
+  auto seconds = time_locked_queues(n_records);
+  std::printf("mutex + deque           %10.2f %6.2f\n",
+              static_cast<double>(n_records) / seconds / 1e6,
+              static_cast<double>(n_records * sizeof(Record)) / seconds / 1e9);
+
+  return 0;
+}
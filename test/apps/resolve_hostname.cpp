@@ -1,18 +1,203 @@
+/**
+ * @file resolve_hostname.cpp
+ *
+ * Resolve hostnames or connection strings and report the results. With a
+ * file of names, several threads and repetitions it doubles as a resolver
+ * load tool, reporting latency percentiles, throughput, cache hit rate and
+ * failures as text or JSON.
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
 #include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
+
+#include "boost/program_options.hpp"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace bpo = boost::program_options;
+using namespace dunedaq::utilities;
+
+namespace {
+
+struct Lookup
+{
+  std::vector<std::string> results;
+  bool ok;
+};
+
+Lookup
+resolve(const std::string& input)
+{
+  if (input.find("://") == std::string::npos) {
+    auto result = ResolverCache::instance().resolve(input);
+    return { result.addresses, result.error == 0 };
+  }
+
+  auto result = resolve_uri_hostnames({ input }, 1);
+  return { result[0].uris, result[0].ok() };
+}
+
+double
+percentile(const std::vector<double>& sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0;
+  auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace ""
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<std::string> names;
+  std::string input_file;
+  size_t concurrency = 1;
+  size_t repetitions = 1;
+  bool no_cache = false;
+  bool json_output = false;
+
+  bpo::options_description desc("Usage: resolve_hostname [options] [name...]\n"
+                                "Names may be hostnames or connection strings such as tcp://host:port");
+  desc.add_options()("help,h", "Print this help")(
+    "file,f", bpo::value<std::string>(&input_file), "File of names to resolve, one per line ('#' starts a comment)")(
+    "concurrency,c", bpo::value<size_t>(&concurrency)->default_value(1), "Number of resolving threads")(
+    "repetitions,r", bpo::value<size_t>(&repetitions)->default_value(1), "Number of passes over the names")(
+    "no-cache", bpo::bool_switch(&no_cache), "Bypass the ResolverCache")(
+    "json,j", bpo::bool_switch(&json_output), "Print the report as JSON")(
+    "name", bpo::value<std::vector<std::string>>(&names), "Names to resolve");
+  bpo::positional_options_description positional;
+  positional.add("name", -1);
 
-int main(int argc, char* argv[]) {
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(desc).positional(positional).run(), vm);
+    bpo::notify(vm);
+  } catch (bpo::error const& e) {
+    std::cout << "Invalid arguments: " << e.what() << "\n" << desc << "\n";
+    exit(1);
+  }
 
-    if (argc != 2) {
-        std::cout << "Invalid number of arguments:\nresolve hostname\n";
-        exit(1);
+  if (vm.count("help")) {
+    std::cout << desc << "\n";
+    return 0;
+  }
+
+  if (!input_file.empty()) {
+    std::ifstream file(input_file);
+    if (!file) {
+      std::cout << "Could not open " << input_file << "\n";
+      exit(1);
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+      line = line.substr(0, line.find('#'));
+      line.erase(0, line.find_first_not_of(" \t\r"));
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      if (!line.empty())
+        names.push_back(line);
+    }
+  }
+
+  if (names.empty()) {
+    std::cout << "No names to resolve\n" << desc << "\n";
+    exit(1);
+  }
+  concurrency = std::max<size_t>(concurrency, 1);
+
+  auto config = ResolverCache::instance().get_config();
+  config.enabled = !no_cache;
+  ResolverCache::instance().configure(config);
+
+  // The simple case: show what a single name resolves to
+  bool single_lookup = names.size() == 1 && repetitions == 1 && !json_output;
+
+  std::vector<std::string> work;
+  for (size_t rep = 0; rep < repetitions; ++rep)
+    work.insert(work.end(), names.begin(), names.end());
+
+  std::vector<double> latencies_us(work.size());
+  std::vector<Lookup> lookups(single_lookup ? 1 : 0);
+  std::atomic<size_t> next{ 0 };
+  std::atomic<size_t> failures{ 0 };
+
+  auto start = std::chrono::steady_clock::now();
+  auto worker = [&]() {
+    for (auto ii = next++; ii < work.size(); ii = next++) {
+      auto lookup_start = std::chrono::steady_clock::now();
+      auto lookup = resolve(work[ii]);
+      latencies_us[ii] =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - lookup_start).count();
+      if (!lookup.ok)
+        ++failures;
+      if (single_lookup)
+        lookups[0] = lookup;
     }
+  };
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii < concurrency; ++ii)
+    threads.emplace_back(worker);
+  for (auto& thread : threads)
+    thread.join();
+  auto elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  if (single_lookup) {
+    for (auto const& r : lookups[0].results)
+      std::cout << r << "\n";
+    return lookups[0].ok ? 0 : 1;
+  }
+
+  std::sort(latencies_us.begin(), latencies_us.end());
+  auto stats = ResolverCache::instance().get_stats();
+  auto cached = stats.static_hits + stats.hits + stats.negative_hits + stats.coalesced;
+  double hit_rate = work.empty() ? 0 : static_cast<double>(cached) / static_cast<double>(work.size());
+
+  nlohmann::json report;
+  report["names"] = names.size();
+  report["distinct_names"] = std::unordered_set<std::string>(names.begin(), names.end()).size();
+  report["lookups"] = work.size();
+  report["failures"] = failures.load();
+  report["concurrency"] = concurrency;
+  report["cache_enabled"] = !no_cache;
+  report["elapsed_s"] = elapsed_s;
+  report["throughput_per_s"] = static_cast<double>(work.size()) / elapsed_s;
+  report["cache_hit_rate"] = hit_rate;
+  report["latency_us"] = { { "min", latencies_us.front() },
+                           { "p50", percentile(latencies_us, 0.50) },
+                           { "p90", percentile(latencies_us, 0.90) },
+                           { "p99", percentile(latencies_us, 0.99) },
+                           { "p999", percentile(latencies_us, 0.999) },
+                           { "max", latencies_us.back() } };
 
-    auto results = dunedaq::utilities::get_ips_from_hostname(argv[1]);
-    for (auto const& r: results)
-        std::cout << r << "\n";
+  if (json_output) {
+    std::cout << report.dump(2) << "\n";
+  } else {
+    std::cout << "Resolved " << work.size() << " name(s) (" << report["distinct_names"].get<size_t>() << " distinct) with " << concurrency
+              << " thread(s), cache " << (no_cache ? "disabled" : "enabled") << "\n";
+    std::cout << "  elapsed:    " << elapsed_s << " s\n";
+    std::cout << "  throughput: " << report["throughput_per_s"].get<double>() << " lookups/s\n";
+    std::cout << "  latency us: p50=" << report["latency_us"]["p50"].get<double>()
+              << " p90=" << report["latency_us"]["p90"].get<double>()
+              << " p99=" << report["latency_us"]["p99"].get<double>()
+              << " p99.9=" << report["latency_us"]["p999"].get<double>()
+              << " max=" << report["latency_us"]["max"].get<double>() << "\n";
+    std::cout << "  cache hit rate: " << hit_rate * 100 << " %\n";
+    std::cout << "  failures:   " << failures.load() << "\n";
+  }
 
-    if (results.size() > 1)
-        return 0;
-    else
-        return 1;
-}
\ No newline at end of file
+  return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file resolver_batch_benchmark.cpp
+ *
+ * Compare resolving N tcp:// connection strings one at a time against
+ * resolve_uri_hostnames. The ResolverCache is disabled so that the
+ * difference comes from host de-duplication and concurrency alone. Use
+ * names from /etc/hosts or a local stub resolver to get stable numbers.
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+int
+main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cout << "Usage: resolver_batch_benchmark N max_concurrency [hostname...]\n";
+    exit(1);
+  }
+
+  size_t n_uris = std::stoul(argv[1]);
+  size_t max_concurrency = std::stoul(argv[2]);
+  std::vector<std::string> hosts;
+  for (int ii = 3; ii < argc; ++ii) {
+    hosts.push_back(argv[ii]);
+  }
+  if (hosts.empty()) {
+    hosts = { "localhost", "127.0.0.1" };
+  }
+
+  std::vector<std::string> uris;
+  for (size_t ii = 0; ii < n_uris; ++ii) {
+    uris.push_back("tcp://" + hosts[ii % hosts.size()] + ":" + std::to_string(10000 + ii));
+  }
+
+  auto config = ResolverCache::instance().get_config();
+  config.enabled = false;
+  ResolverCache::instance().configure(config);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t serial_failures = 0;
+  for (auto const& uri : uris) {
+    if (resolve_uri_hostname(uri).empty())
+      ++serial_failures;
+  }
+  auto serial_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  auto results = resolve_uri_hostnames(uris, max_concurrency);
+  auto batch_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  size_t batch_failures = 0;
+  for (auto const& result : results) {
+    if (!result.ok())
+      ++batch_failures;
+  }
+
+  std::cout << "Resolved " << n_uris << " connection strings over " << hosts.size() << " unique host(s)\n";
+  std::cout << "  serial: " << serial_ms << " ms, " << serial_failures << " failure(s)\n";
+  std::cout << "  batch:  " << batch_ms << " ms, " << batch_failures << " failure(s), max_concurrency "
+            << max_concurrency << "\n";
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file resolver_cache_benchmark.cpp
+ *
+ * Resolve N connection strings with the ResolverCache disabled, then cold
+ * and warm with it enabled, and print the time taken by each pass
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+double
+time_pass(const std::vector<std::string>& uris)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (auto const& uri : uris) {
+    resolve_uri_hostname(uri);
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  if (argc < 2) {
+    std::cout << "Usage: resolver_cache_benchmark N [hostname...]\n";
+    exit(1);
+  }
+
+  size_t n_uris = std::stoul(argv[1]);
+  std::vector<std::string> hosts;
+  for (int ii = 2; ii < argc; ++ii) {
+    hosts.push_back(argv[ii]);
+  }
+  if (hosts.empty()) {
+    hosts = { "localhost", "127.0.0.1" };
+  }
+
+  std::vector<std::string> uris;
+  for (size_t ii = 0; ii < n_uris; ++ii) {
+    uris.push_back("tcp://" + hosts[ii % hosts.size()] + ":" + std::to_string(10000 + ii));
+  }
+
+  auto& cache = ResolverCache::instance();
+  auto config = cache.get_config();
+
+  config.enabled = false;
+  cache.configure(config);
+  auto uncached_ms = time_pass(uris);
+
+  config.enabled = true;
+  cache.configure(config);
+  cache.clear();
+  cache.reset_stats();
+  auto cold_ms = time_pass(uris);
+  auto warm_ms = time_pass(uris);
+  auto stats = cache.get_stats();
+
+  std::cout << "Resolved " << n_uris << " connection strings over " << hosts.size() << " host(s)\n";
+  std::cout << "  uncached: " << uncached_ms << " ms (" << uncached_ms * 1000 / n_uris << " us/uri)\n";
+  std::cout << "  cold:     " << cold_ms << " ms (" << cold_ms * 1000 / n_uris << " us/uri)\n";
+  std::cout << "  warm:     " << warm_ms << " ms (" << warm_ms * 1000 / n_uris << " us/uri)\n";
+  std::cout << "  cache hits=" << stats.hits << " negative_hits=" << stats.negative_hits << " misses=" << stats.misses
+            << " entries=" << stats.entries << "\n";
+
+  return 0;
+}
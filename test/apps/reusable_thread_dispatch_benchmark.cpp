@@ -0,0 +1,108 @@
+/**
+ * @file reusable_thread_dispatch_benchmark.cpp
+ *
+ * Measure the time from ReusableThread::set_work to the start of the task
+ * for each wait strategy, with the caller and the worker pinned to separate
+ * cores, and print latency percentiles
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+double
+percentile(const std::vector<double>& sorted, double fraction)
+{
+  auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void
+pin_this_thread(int cpu)
+{
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(cpu, &cpuset);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  if (argc > 1 && std::string(argv[1]) == "-h") {
+    std::cout << "Usage: reusable_thread_dispatch_benchmark [N [gap_us [caller_cpu [worker_cpu]]]]\n";
+    return 0;
+  }
+
+  size_t n_tasks = argc > 1 ? std::stoul(argv[1]) : 10000;
+  int gap_us = argc > 2 ? std::stoi(argv[2]) : 50;
+  int caller_cpu = argc > 3 ? std::stoi(argv[3]) : 0;
+  int worker_cpu = argc > 4 ? std::stoi(argv[4]) : 1;
+
+  if (std::thread::hardware_concurrency() < 2) {
+    std::cout << "Warning: only one CPU available, the spinning strategies will look very bad\n";
+  }
+  pin_this_thread(caller_cpu);
+
+  const std::vector<std::pair<std::string, ReusableThread::WaitStrategy>> strategies{
+    { "block", ReusableThread::WaitStrategy::kBlock },
+    { "spin", ReusableThread::WaitStrategy::kSpin },
+    { "spin-yield", ReusableThread::WaitStrategy::kSpinYield },
+    { "spin-park", ReusableThread::WaitStrategy::kSpinPark },
+  };
+
+  std::cout << n_tasks << " dispatches per strategy, " << gap_us << " us apart, caller on CPU " << caller_cpu
+            << ", worker on CPU " << worker_cpu << "\n";
+  std::cout << "strategy      p50 ns    p90 ns    p99 ns  p99.9 ns    max ns\n";
+
+  for (auto const& strategy : strategies) {
+    ReusableThread worker(0);
+    worker.set_name("dispatch", 0);
+    worker.set_pin(worker_cpu);
+    worker.set_wait_strategy(strategy.second);
+
+    std::vector<double> latencies_ns(n_tasks);
+    std::chrono::steady_clock::time_point dispatched;
+    for (size_t ii = 0; ii < n_tasks; ++ii) {
+      if (gap_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(gap_us));
+      }
+      dispatched = std::chrono::steady_clock::now();
+      worker.set_work([&latencies_ns, &dispatched, ii]() {
+        latencies_ns[ii] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - dispatched).count();
+      });
+      while (!worker.get_readiness()) {
+      }
+    }
+
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    std::printf("%-10s %9.0f %9.0f %9.0f %9.0f %9.0f\n",
+                strategy.first.c_str(),
+                percentile(latencies_ns, 0.5),
+                percentile(latencies_ns, 0.9),
+                percentile(latencies_ns, 0.99),
+                percentile(latencies_ns, 0.999),
+                latencies_ns.back());
+  }
+
+  return 0;
+}
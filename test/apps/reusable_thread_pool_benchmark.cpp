@@ -0,0 +1,179 @@
+/**
+ * @file reusable_thread_pool_benchmark.cpp
+ *
+ * Compare ReusableThreadPool with the pattern it replaces, a vector of
+ * ReusableThreads searched round-robin for one whose get_readiness() is true.
+ * Reports throughput (tasks/s) against thread count for short tasks, and the
+ * submit-to-start latency percentiles for tasks of mixed length arriving at
+ * a fixed rate.
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+#include "utilities/ReusableThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+void
+busy_for(std::chrono::nanoseconds duration)
+{
+  auto end = clock_type::now() + duration;
+  while (clock_type::now() < end) {
+  }
+}
+
+// The pre-pool pattern: poll the threads in turn until one accepts the task
+class RoundRobin
+{
+public:
+  explicit RoundRobin(size_t n_threads)
+  {
+    for (size_t ii = 0; ii < n_threads; ++ii) {
+      m_threads.emplace_back(std::make_unique<ReusableThread>(static_cast<int>(ii)));
+    }
+  }
+
+  template<typename Function>
+  void submit(Function&& f)
+  {
+    while (!m_threads[m_next]->set_work(f)) {
+      m_next = (m_next + 1) % m_threads.size();
+    }
+    m_next = (m_next + 1) % m_threads.size();
+  }
+
+  void wait_all()
+  {
+    for (auto& thread : m_threads) {
+      while (!thread->get_readiness()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<ReusableThread>> m_threads;
+  size_t m_next = 0;
+};
+
+template<typename Executor>
+double
+throughput(Executor& executor, size_t n_tasks, std::chrono::nanoseconds task_length)
+{
+  std::atomic<size_t> done{ 0 };
+  auto start = clock_type::now();
+  for (size_t ii = 0; ii < n_tasks; ++ii) {
+    executor.submit([&done, task_length]() {
+      busy_for(task_length);
+      ++done;
+    });
+  }
+  while (done.load() < n_tasks) {
+    std::this_thread::yield();
+  }
+  return static_cast<double>(n_tasks) / std::chrono::duration<double>(clock_type::now() - start).count();
+}
+
+template<typename Executor>
+std::vector<double>
+latencies(Executor& executor, size_t n_tasks, std::chrono::microseconds interval)
+{
+  std::vector<double> latencies_us(n_tasks);
+  std::atomic<size_t> done{ 0 };
+  auto next_submit = clock_type::now();
+  for (size_t ii = 0; ii < n_tasks; ++ii) {
+    next_submit += interval;
+    while (clock_type::now() < next_submit) {
+    }
+    // One task in sixteen is long, so it holds up whatever is queued behind it
+    auto length = std::chrono::microseconds(ii % 16 == 0 ? 20 * interval.count() : interval.count() / 2);
+    auto submitted = clock_type::now();
+    executor.submit([&latencies_us, &done, ii, submitted, length]() {
+      latencies_us[ii] = std::chrono::duration<double, std::micro>(clock_type::now() - submitted).count();
+      busy_for(length);
+      ++done;
+    });
+  }
+  while (done.load() < n_tasks) {
+    std::this_thread::yield();
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  return latencies_us;
+}
+
+double
+percentile(const std::vector<double>& sorted, double fraction)
+{
+  auto index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t max_threads = argc > 1 ? std::stoul(argv[1]) : std::max(2U, std::thread::hardware_concurrency());
+  size_t n_tasks = argc > 2 ? std::stoul(argv[2]) : 100000;
+  auto task_length = std::chrono::nanoseconds(argc > 3 ? std::stol(argv[3]) : 1000);
+
+  std::cout << "Throughput, " << n_tasks << " tasks of " << task_length.count() << " ns\n";
+  std::cout << "threads   pool tasks/s   round-robin tasks/s\n";
+  for (size_t n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+    double pool_rate = 0;
+    {
+      ReusableThreadPool pool(n_threads, "bench");
+      pool_rate = throughput(pool, n_tasks, task_length);
+    }
+    RoundRobin round_robin(n_threads);
+    double round_robin_rate = throughput(round_robin, n_tasks, task_length);
+    round_robin.wait_all();
+    std::printf("%7zu %14.0f %21.0f\n", n_threads, pool_rate, round_robin_rate);
+  }
+
+  size_t n_latency_tasks = n_tasks / 10;
+  auto interval = std::chrono::microseconds(20);
+  std::cout << "\nSubmit-to-start latency, " << n_latency_tasks << " tasks every " << interval.count() << " us on "
+            << max_threads << " threads\n";
+  std::cout << "executor        p50 us    p90 us    p99 us  p99.9 us    max us\n";
+  {
+    ReusableThreadPool pool(max_threads, "bench");
+    auto sorted = latencies(pool, n_latency_tasks, interval);
+    std::printf("pool        %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                percentile(sorted, 0.5),
+                percentile(sorted, 0.9),
+                percentile(sorted, 0.99),
+                percentile(sorted, 0.999),
+                sorted.back());
+  }
+  {
+    RoundRobin round_robin(max_threads);
+    auto sorted = latencies(round_robin, n_latency_tasks, interval);
+    round_robin.wait_all();
+    std::printf("round-robin %9.1f %9.1f %9.1f %9.1f %9.1f\n",
+                percentile(sorted, 0.5),
+                percentile(sorted, 0.9),
+                percentile(sorted, 0.99),
+                percentile(sorted, 0.999),
+                sorted.back());
+  }
+
+  return 0;
+}
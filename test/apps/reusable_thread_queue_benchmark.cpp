@@ -0,0 +1,100 @@
+/**
+ * @file reusable_thread_queue_benchmark.cpp
+ *
+ * Measure the rate at which one producer can feed short tasks to a
+ * ReusableThread through try_submit, for increasing queue depths (0 being the
+ * single set_work slot), with single and batch submission
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+std::atomic<uint64_t> s_sink{ 0 }; // NOLINT(build/unsigned)
+
+struct Result
+{
+  double tasks_per_s;
+  double full_per_task;
+};
+
+Result
+run_single(size_t depth, size_t n_tasks)
+{
+  ReusableThread worker(0, depth);
+  size_t full = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_tasks; ++ii) {
+    while (worker.try_submit([ii]() { s_sink += ii; }) == ReusableThread::SubmitResult::kFull) {
+      ++full;
+      std::this_thread::yield();
+    }
+  }
+  worker.wait_until_ready();
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return { static_cast<double>(n_tasks) / elapsed, static_cast<double>(full) / static_cast<double>(n_tasks) };
+}
+
+Result
+run_batch(size_t depth, size_t n_tasks, size_t batch_size)
+{
+  ReusableThread worker(0, depth);
+  size_t full = 0;
+  std::vector<ReusableThread::Task> batch(batch_size);
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_tasks; ii += batch_size) {
+    for (size_t jj = 0; jj < batch_size; ++jj) {
+      batch[jj] = [ii]() { s_sink += ii; };
+    }
+    auto first = batch.begin();
+    while (true) {
+      first += worker.try_submit_batch(first, batch.end());
+      if (first == batch.end()) {
+        break;
+      }
+      ++full;
+      std::this_thread::yield();
+    }
+  }
+  worker.wait_until_ready();
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return { static_cast<double>(n_tasks) / elapsed, static_cast<double>(full) / static_cast<double>(n_tasks) };
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_tasks = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  size_t batch_size = argc > 2 ? std::stoul(argv[2]) : 16;
+
+  std::cout << n_tasks << " tasks, batches of " << batch_size << "\n";
+  std::cout << "depth   try_submit Mtasks/s  full/task   try_submit_batch Mtasks/s  full/task\n";
+  for (size_t depth : { 0, 1, 4, 16, 64, 256, 1024, 4096 }) {
+    auto single = run_single(depth, depth == 0 ? n_tasks / 10 : n_tasks);
+    auto batch = run_batch(depth, n_tasks, depth == 0 ? 1 : batch_size);
+    std::printf("%5zu %22.3f %10.3f %26.3f %10.3f\n",
+                depth,
+                single.tasks_per_s / 1e6,
+                single.full_per_task,
+                batch.tasks_per_s / 1e6,
+                batch.full_per_task);
+  }
+
+  return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file reusable_thread_stop_benchmark.cpp
+ *
+ * Measure how long it takes to destroy N idle ReusableThreads, and N
+ * ReusableThreads which are still finishing a short task, as happens at the
+ * stop transition
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+double
+time_teardown(size_t n_threads, std::chrono::microseconds task_length)
+{
+  std::vector<std::unique_ptr<ReusableThread>> threads;
+  for (size_t ii = 0; ii < n_threads; ++ii) {
+    threads.emplace_back(std::make_unique<ReusableThread>(static_cast<int>(ii)));
+  }
+  // Let the workers settle into waiting
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  if (task_length.count() > 0) {
+    for (auto& thread : threads) {
+      thread->set_work([task_length]() { std::this_thread::sleep_for(task_length); });
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  threads.clear();
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<size_t> counts{ 1, 10, 100, 500 };
+  if (argc > 1) {
+    counts.clear();
+    for (int ii = 1; ii < argc; ++ii) {
+      counts.push_back(std::stoul(argv[ii]));
+    }
+  }
+
+  std::cout << "threads   idle teardown ms   busy (1 ms task) teardown ms\n";
+  for (auto n_threads : counts) {
+    auto idle = time_teardown(n_threads, std::chrono::microseconds(0));
+    auto busy = time_teardown(n_threads, std::chrono::microseconds(1000));
+    std::printf("%7zu %18.3f %30.3f\n", n_threads, idle, busy);
+  }
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file reusable_thread_task_benchmark.cpp
+ *
+ * Measure the cost and heap allocations per ReusableThread::set_work for
+ * tasks of increasing size, next to the cost of storing the same task in a
+ * std::function as set_work used to
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+
+namespace {
+std::atomic<size_t> s_allocations{ 0 };
+}
+
+void*
+operator new(size_t size)
+{
+  ++s_allocations;
+  if (void* ptr = std::malloc(size)) // NOLINT
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr); // NOLINT
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr); // NOLINT
+}
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+std::atomic<uint64_t> s_sink{ 0 }; // NOLINT(build/unsigned)
+
+template<size_t Words>
+void
+measure(ReusableThread& worker, size_t iterations)
+{
+  std::array<uint64_t, Words> payload{}; // NOLINT(build/unsigned)
+  auto task = [](const std::array<uint64_t, Words>& data) { s_sink += data[0]; }; // NOLINT(build/unsigned)
+
+  // set_work, including waiting for the worker to take the task
+  auto allocations_before = s_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    payload[0] = ii;
+    while (!worker.set_work(task, payload)) {
+      std::this_thread::yield();
+    }
+  }
+  while (!worker.get_readiness()) {
+    std::this_thread::yield();
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  auto allocations = s_allocations.load() - allocations_before;
+
+  // The old storage: std::function<void()> holding std::bind(f, args...)
+  std::function<void()> function;
+  auto function_allocations_before = s_allocations.load();
+  auto function_start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    payload[0] = ii;
+    function = std::bind(task, payload);
+    function();
+  }
+  auto function_elapsed =
+    std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - function_start).count();
+  auto function_allocations = s_allocations.load() - function_allocations_before;
+
+  std::printf("%5zu bytes  set_work %8.1f ns %6.2f allocs  |  std::function store+call %6.1f ns %6.2f allocs\n",
+              sizeof(payload),
+              elapsed / static_cast<double>(iterations),
+              static_cast<double>(allocations) / static_cast<double>(iterations),
+              function_elapsed / static_cast<double>(iterations),
+              static_cast<double>(function_allocations) / static_cast<double>(iterations));
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t iterations = argc > 1 ? std::stoul(argv[1]) : 100000;
+
+  ReusableThread worker(0);
+
+  std::cout << iterations << " dispatches per task size, task capacity " << ReusableThread::s_task_capacity
+            << " bytes\n";
+  measure<1>(worker, iterations);
+  measure<4>(worker, iterations);
+  measure<8>(worker, iterations);
+  measure<14>(worker, iterations);
+
+  return s_sink.load() == 0 ? 1 : 0;
+}
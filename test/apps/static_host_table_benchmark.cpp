@@ -0,0 +1,84 @@
+/**
+ * @file static_host_table_benchmark.cpp
+ *
+ * Compare hostname lookups in a StaticHostTable with getaddrinfo
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/StaticHostTable.hpp"
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_hosts = 10000;
+  size_t iterations = 1000000;
+  if (argc > 1)
+    n_hosts = std::stoul(argv[1]);
+  if (argc > 2)
+    iterations = std::stoul(argv[2]);
+
+  auto pid = std::to_string(getpid());
+  auto hosts_path = "/tmp/static_host_table_benchmark_hosts_" + pid;
+  auto table_path = "/tmp/static_host_table_benchmark_table_" + pid;
+  std::vector<std::string> names;
+  {
+    std::ofstream hosts(hosts_path);
+    for (size_t ii = 0; ii < n_hosts; ++ii) {
+      names.push_back("np04-srv-" + std::to_string(ii) + ".cern.ch");
+      hosts << "10." << (ii >> 16) % 256 << "." << (ii >> 8) % 256 << "." << ii % 256 << " " << names.back() << "\n";
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  StaticHostTable::compile(hosts_path, table_path);
+  auto compile_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  StaticHostTable table(table_path);
+  size_t found = 0;
+  start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    const uint32_t* addresses = nullptr; // NOLINT(build/unsigned)
+    size_t count = 0;
+    found += table.find(names[(ii * 7919) % names.size()], addresses, count) ? count : 0;
+  }
+  auto find_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::vector<std::string> strings;
+  start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    found += table.lookup(names[(ii * 7919) % names.size()], strings) ? strings.size() : 0;
+  }
+  auto lookup_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  size_t gai_iterations = std::min<size_t>(iterations, 10000);
+  start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < gai_iterations; ++ii) {
+    found += lookup_hostname("localhost").addresses.size();
+  }
+  auto gai_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::remove(hosts_path.c_str());
+  std::remove(table_path.c_str());
+
+  std::cout << "Table of " << n_hosts << " hosts compiled in " << compile_ms << " ms\n";
+  std::cout << "  StaticHostTable::find:    " << find_ns / iterations << " ns/lookup\n";
+  std::cout << "  StaticHostTable::lookup:  " << lookup_ns / iterations << " ns/lookup (with string conversion)\n";
+  std::cout << "  getaddrinfo(localhost):   " << gai_ns / gai_iterations << " ns/lookup\n";
+  std::cout << "  (checksum " << found << ")\n";
+  return 0;
+}
@@ -0,0 +1,185 @@
+/**
+ * @file timestamp_contention_benchmark.cpp
+ *
+ * Reader threads call get_timestamp_estimate as fast as they can while
+ * several sources feed TimeSyncs. For the previous design (TimeSyncs
+ * ingested under a mutex, the estimate published through a
+ * std::atomic<TimeSyncPoint>, which libatomic implements with a lock) and for
+ * TimestampEstimator, report the read rate and how long sources spent adding
+ * each TimeSync
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TimestampEstimator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+const uint64_t s_clock_frequency_hz = 62500000; // NOLINT(build/unsigned)
+
+// What TimestampEstimator used to do, with a window of one TimeSync
+class LockedEstimator
+{
+public:
+  explicit LockedEstimator(uint64_t clock_frequency_hz) // NOLINT(build/unsigned)
+    : m_clock_frequency_hz(clock_frequency_hz)
+  {
+  }
+
+  uint64_t get_timestamp_estimate() const // NOLINT(build/unsigned)
+  {
+    auto estimate = m_estimate.load();
+    if (estimate.daq_time == std::numeric_limits<uint64_t>::max()) {
+      return estimate.daq_time;
+    }
+    auto delta_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - estimate.system_time)
+        .count();
+    return estimate.daq_time + static_cast<uint64_t>(static_cast<double>(delta_us) * estimate.frequency_hz / 1e6);
+  }
+
+  void add_timestamp_datapoint(uint64_t daq_time, uint64_t system_time) // NOLINT(build/unsigned)
+  {
+    std::scoped_lock<std::mutex> lk(m_mutex);
+    auto estimate = m_estimate.load();
+    if (daq_time > m_most_recent_daq_time) {
+      m_most_recent_daq_time = daq_time;
+      m_most_recent_system_time = system_time;
+    }
+    auto time_now = static_cast<uint64_t>( // NOLINT(build/unsigned)
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count());
+    if (time_now > m_most_recent_system_time) {
+      auto new_timestamp = m_most_recent_daq_time + (time_now - m_most_recent_system_time) * m_clock_frequency_hz / 1000000;
+      if (estimate.daq_time == std::numeric_limits<uint64_t>::max() || new_timestamp >= estimate.daq_time) {
+        m_estimate.store(
+          Point{ new_timestamp, std::chrono::steady_clock::now(), static_cast<double>(m_clock_frequency_hz) });
+      }
+    }
+  }
+
+private:
+  struct Point
+  {
+    uint64_t daq_time; // NOLINT(build/unsigned)
+    std::chrono::steady_clock::time_point system_time;
+    double frequency_hz;
+  };
+
+  uint64_t m_clock_frequency_hz; // NOLINT(build/unsigned)
+  std::atomic<Point> m_estimate{ Point{ std::numeric_limits<uint64_t>::max(), {}, 0. } };
+  std::mutex m_mutex;
+  uint64_t m_most_recent_daq_time{ 0 };   // NOLINT(build/unsigned)
+  uint64_t m_most_recent_system_time{ 0 }; // NOLINT(build/unsigned)
+};
+
+uint64_t // NOLINT(build/unsigned)
+system_time_us()
+{
+  return static_cast<uint64_t>( // NOLINT(build/unsigned)
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+template<typename Estimator>
+void
+run(const char* label, size_t n_readers, size_t n_sources, std::chrono::milliseconds duration)
+{
+  Estimator te(s_clock_frequency_hz);
+  auto daq_start = 1000000000ULL;
+  auto system_start = system_time_us();
+  te.add_timestamp_datapoint(daq_start, system_start - 1);
+
+  std::atomic<bool> running{ true };
+  std::atomic<uint64_t> reads{ 0 };     // NOLINT(build/unsigned)
+  std::atomic<uint64_t> additions{ 0 }; // NOLINT(build/unsigned)
+  std::mutex results_mutex;
+  std::vector<double> add_ns;
+
+  std::vector<std::thread> threads;
+  for (size_t ii = 0; ii < n_readers; ++ii) {
+    threads.emplace_back([&]() {
+      uint64_t my_reads = 0; // NOLINT(build/unsigned)
+      uint64_t sink = 0;     // NOLINT(build/unsigned)
+      while (running.load(std::memory_order_relaxed)) {
+        sink ^= te.get_timestamp_estimate();
+        ++my_reads;
+      }
+      reads.fetch_add(my_reads + (sink & 0));
+    });
+  }
+  for (size_t ii = 0; ii < n_sources; ++ii) {
+    threads.emplace_back([&]() {
+      std::vector<double> my_add_ns;
+      while (running.load(std::memory_order_relaxed)) {
+        auto now = system_time_us() - 1;
+        auto start = std::chrono::steady_clock::now();
+        te.add_timestamp_datapoint(daq_start + (now - system_start) * s_clock_frequency_hz / 1000000, now);
+        my_add_ns.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      additions.fetch_add(my_add_ns.size());
+      std::lock_guard<std::mutex> lk(results_mutex);
+      add_ns.insert(add_ns.end(), my_add_ns.begin(), my_add_ns.end());
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  running = false;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::sort(add_ns.begin(), add_ns.end());
+  auto percentile = [&](double fraction) {
+    return add_ns.empty() ? 0. : add_ns[static_cast<size_t>(fraction * static_cast<double>(add_ns.size() - 1))];
+  };
+  auto seconds = std::chrono::duration<double>(duration).count();
+  std::printf("%-20s %14.2f %12.0f %12.0f %12.0f %10lu\n",
+              label,
+              static_cast<double>(reads.load()) / seconds / 1e6,
+              percentile(0.5),
+              percentile(0.99),
+              percentile(1.),
+              static_cast<unsigned long>(additions.load())); // NOLINT
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_readers = 8;
+  size_t n_sources = 4;
+  std::chrono::milliseconds duration(2000);
+  if (argc > 1) {
+    n_readers = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    n_sources = std::stoul(argv[2]);
+  }
+  if (argc > 3) {
+    duration = std::chrono::milliseconds(std::stoul(argv[3]));
+  }
+
+  std::cout << n_readers << " readers, " << n_sources << " sources each adding a TimeSync every 100 us, for "
+            << duration.count() << " ms; TimestampEstimator lock-free: " << std::boolalpha
+            << TimestampEstimator::is_lock_free() << "\n";
+  std::printf("%-20s %14s %12s %12s %12s %10s\n", "estimator", "reads (M/s)", "add p50 ns", "add p99 ns", "add max ns",
+              "additions");
+  run<LockedEstimator>("mutex + atomic<T>", n_readers, n_sources, duration);
+  run<TimestampEstimator>("TimestampEstimator", n_readers, n_sources, duration);
+  return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file timestamp_tsc_benchmark.cpp
+ *
+ * Cost and accuracy of get_timestamp_estimate when extrapolating with
+ * steady_clock (in whole microseconds) and with the TSC. The accuracy is
+ * measured, a given time after a TimeSync, against the TimeSync's DAQ time
+ * extrapolated from the system clock in nanoseconds
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TimestampEstimator.hpp"
+#include "utilities/TscClock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+const uint64_t s_clock_frequency_hz = 62500000; // NOLINT(build/unsigned)
+const uint64_t s_daq_start = 1000000000000ULL;  // NOLINT(build/unsigned)
+
+int64_t
+system_time_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+    .count();
+}
+
+double
+ns_per_call(const TimestampEstimator& te, size_t n_calls)
+{
+  uint64_t sink = 0; // NOLINT(build/unsigned)
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < n_calls; ++ii) {
+    sink ^= te.get_timestamp_estimate();
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return elapsed / static_cast<double>(n_calls) + static_cast<double>(sink & 0);
+}
+
+// Mean error and largest absolute error in DAQ ticks, delay after a TimeSync
+std::pair<double, double>
+error_after(bool use_tsc, std::chrono::microseconds delay, size_t n_samples)
+{
+  std::vector<double> errors;
+  for (size_t ii = 0; ii < n_samples; ++ii) {
+    TimestampEstimator te(s_clock_frequency_hz);
+    te.set_use_tsc(use_tsc);
+    // Sent at the start of the previous microsecond; the estimator ignores one from the current microsecond
+    auto sent_us = static_cast<uint64_t>(system_time_ns() / 1000) - 1; // NOLINT(build/unsigned)
+    te.add_timestamp_datapoint(s_daq_start, sent_us);
+    std::this_thread::sleep_for(delay);
+
+    auto estimate = te.get_timestamp_estimate();
+    auto now_ns = system_time_ns();
+    auto expected = static_cast<double>(s_daq_start) +
+                    static_cast<double>(now_ns - static_cast<int64_t>(sent_us) * 1000) *
+                      static_cast<double>(s_clock_frequency_hz) / 1e9;
+    errors.push_back(static_cast<double>(estimate) - expected);
+  }
+  double sum = 0.;
+  double largest = 0.;
+  for (auto error : errors) {
+    sum += error;
+    largest = std::max(largest, std::fabs(error));
+  }
+  return { sum / static_cast<double>(errors.size()), largest };
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_calls = 10000000;
+  size_t n_samples = 20;
+  if (argc > 1) {
+    n_calls = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    n_samples = std::stoul(argv[2]);
+  }
+
+  std::cout << "TSC invariant: " << std::boolalpha << TscClock::is_invariant()
+            << ", frequency: " << TscClock::get_frequency_hz() / 1e9 << " GHz\n";
+  if (!TscClock::is_invariant()) {
+    std::cout << "Only steady_clock is available\n";
+  }
+
+  std::printf("%-14s %12s\n", "clock", "ns/call");
+  for (auto use_tsc : { false, true }) {
+    TimestampEstimator te(s_clock_frequency_hz);
+    if (te.set_use_tsc(use_tsc) != use_tsc) {
+      continue;
+    }
+    te.add_timestamp_datapoint(s_daq_start, static_cast<uint64_t>(system_time_ns() / 1000) - 1); // NOLINT
+    std::printf("%-14s %12.2f\n", use_tsc ? "TSC" : "steady_clock", ns_per_call(te, n_calls));
+  }
+
+  std::printf("\n%-14s %12s %16s %16s\n", "clock", "delay", "mean error (tk)", "max |error| (tk)");
+  for (auto use_tsc : { false, true }) {
+    if (use_tsc && !TscClock::is_invariant()) {
+      continue;
+    }
+    for (auto delay_us : { 100, 1000, 10000, 100000, 1000000 }) {
+      auto samples = delay_us >= 1000000 ? std::max<size_t>(n_samples / 10, 1) : n_samples;
+      auto error = error_after(use_tsc, std::chrono::microseconds(delay_us), samples);
+      std::printf("%-14s %9d us %16.1f %16.1f\n", use_tsc ? "TSC" : "steady_clock", delay_us, error.first, error.second);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file timestamp_wait_benchmark.cpp
+ *
+ * Waiters repeatedly wait for a timestamp a few milliseconds ahead of the
+ * current estimate while TimeSyncs arrive at 10 Hz. For the previous 10 ms
+ * polling loop, and for wait_for_timestamp with a continue flag and with a
+ * StopToken, report how far past its target each waiter woke up, its CPU
+ * time, how often it was woken and the wall time of the run
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TimestampEstimator.hpp"
+
+#include <sys/resource.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+const uint64_t s_clock_frequency_hz = 62500000; // NOLINT(build/unsigned)
+
+enum class Method
+{
+  kPoll,
+  kContinueFlag,
+  kStopToken
+};
+
+// The loop wait_for_timestamp used to be
+void
+poll_for_timestamp(const TimestampEstimator& te, uint64_t ts, std::atomic<bool>& continue_flag) // NOLINT
+{
+  while (continue_flag.load() &&
+         (te.get_timestamp_estimate() < ts || te.get_timestamp_estimate() == std::numeric_limits<uint64_t>::max())) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+uint64_t // NOLINT(build/unsigned)
+system_time_us()
+{
+  return static_cast<uint64_t>( // NOLINT(build/unsigned)
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_waiters = 8;
+  size_t n_waits = 100;
+  if (argc > 1) {
+    n_waiters = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    n_waits = std::stoul(argv[2]);
+  }
+
+  std::cout << n_waiters << " waiters, " << n_waits << " waits each for 1-20 ms ahead, TimeSync at 10 Hz\n";
+  std::printf("%-14s %10s %10s %10s %14s %14s %10s\n",
+              "method",
+              "p50 (us)",
+              "p99 (us)",
+              "max (us)",
+              "cpu/waiter",
+              "wakes/wait",
+              "wall (s)");
+
+  for (auto method : { Method::kPoll, Method::kContinueFlag, Method::kStopToken }) {
+    TimestampEstimator te(s_clock_frequency_hz);
+    auto daq_start = 1000000000ULL;
+    auto system_start = system_time_us();
+    te.add_timestamp_datapoint(daq_start, system_start - 1);
+
+    std::atomic<bool> sending{ true };
+    std::thread sender([&]() {
+      while (sending.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        auto now = system_time_us();
+        te.add_timestamp_datapoint(daq_start + (now - system_start) * s_clock_frequency_hz / 1000000, now);
+      }
+    });
+
+    std::atomic<bool> continue_flag{ true };
+    StopState stop_state;
+    std::mutex results_mutex;
+    std::vector<double> late_us;
+    double cpu_ms = 0;
+    double wakes = 0;
+    auto wall_start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> waiters;
+    for (size_t ww = 0; ww < n_waiters; ++ww) {
+      waiters.emplace_back([&, ww]() {
+        std::mt19937 generator(ww);
+        std::uniform_int_distribution<uint64_t> ahead_ticks(s_clock_frequency_hz / 1000, s_clock_frequency_hz / 50);
+        std::vector<double> my_late_us;
+        StopToken stop(stop_state);
+        for (size_t ii = 0; ii < n_waits; ++ii) {
+          auto target = te.get_timestamp_estimate() + ahead_ticks(generator);
+          switch (method) {
+            case Method::kPoll:
+              poll_for_timestamp(te, target, continue_flag);
+              break;
+            case Method::kContinueFlag:
+              te.wait_for_timestamp(target, continue_flag);
+              break;
+            case Method::kStopToken:
+              te.wait_for_timestamp(target, stop);
+              break;
+          }
+          auto reached = te.get_timestamp_estimate();
+          my_late_us.push_back(static_cast<double>(reached - target) * 1e6 / static_cast<double>(s_clock_frequency_hz));
+        }
+        struct timespec cpu;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+        struct rusage usage;
+        getrusage(RUSAGE_THREAD, &usage);
+
+        std::lock_guard<std::mutex> lk(results_mutex);
+        late_us.insert(late_us.end(), my_late_us.begin(), my_late_us.end());
+        cpu_ms += static_cast<double>(cpu.tv_sec) * 1e3 + static_cast<double>(cpu.tv_nsec) / 1e6;
+        wakes += static_cast<double>(usage.ru_nvcsw + usage.ru_nivcsw);
+      });
+    }
+    for (auto& waiter : waiters) {
+      waiter.join();
+    }
+    auto wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+    sending = false;
+    sender.join();
+
+    std::sort(late_us.begin(), late_us.end());
+    auto percentile = [&](double fraction) {
+      return late_us[static_cast<size_t>(fraction * static_cast<double>(late_us.size() - 1))];
+    };
+    const char* label = method == Method::kPoll ? "10 ms poll" : method == Method::kContinueFlag ? "continue flag" : "StopToken";
+    std::printf("%-14s %10.1f %10.1f %10.1f %11.2f ms %14.1f %10.2f\n",
+                label,
+                percentile(0.5),
+                percentile(0.99),
+                percentile(1.),
+                cpu_ms / static_cast<double>(n_waiters),
+                wakes / static_cast<double>(n_waiters * n_waits),
+                wall_seconds);
+  }
+  return 0;
+}
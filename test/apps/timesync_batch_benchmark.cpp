@@ -0,0 +1,114 @@
+/**
+ * @file timesync_batch_benchmark.cpp
+ *
+ * Time taken to drain a backlog of TimeSync messages (by default 10k, one in
+ * ten from another run) through timesync_callback one message at a time and
+ * through timesync_batch_callback at once
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/TimestampEstimator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+const uint64_t s_clock_frequency_hz = 62500000; // NOLINT(build/unsigned)
+const uint32_t s_run_number = 5;                // NOLINT(build/unsigned)
+
+// The fields TimestampEstimator reads from a dfmessages::TimeSync
+struct TimeSyncMessage
+{
+  uint64_t daq_time;        // NOLINT(build/unsigned)
+  uint64_t system_time;     // NOLINT(build/unsigned)
+  uint64_t sequence_number; // NOLINT(build/unsigned)
+  uint32_t run_number;      // NOLINT(build/unsigned)
+  uint32_t source_pid;      // NOLINT(build/unsigned)
+};
+
+uint64_t // NOLINT(build/unsigned)
+system_time_us()
+{
+  return static_cast<uint64_t>( // NOLINT(build/unsigned)
+    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// A backlog sent over the half second up to a millisecond ago (so that no
+// TimeSync is late enough to be warned about), starting at daq_start
+std::vector<TimeSyncMessage>
+make_backlog(size_t n_messages, uint64_t daq_start) // NOLINT(build/unsigned)
+{
+  std::vector<TimeSyncMessage> backlog;
+  auto last_system_time = system_time_us() - 1000;
+  for (size_t ii = 0; ii < n_messages; ++ii) {
+    auto before_last_us = static_cast<uint64_t>(n_messages - 1 - ii) * 500000 / n_messages; // NOLINT(build/unsigned)
+    backlog.push_back(TimeSyncMessage{ daq_start + ii * s_clock_frequency_hz / 2 / n_messages,
+                                       last_system_time - before_last_us,
+                                       ii,
+                                       ii % 10 == 0 ? s_run_number + 1 : s_run_number,
+                                       12345 });
+  }
+  return backlog;
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t n_messages = 10000;
+  size_t n_backlogs = 50;
+  if (argc > 1) {
+    n_messages = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    n_backlogs = std::stoul(argv[2]);
+  }
+
+  std::cout << n_backlogs << " backlogs of " << n_messages << " TimeSyncs, one in ten from another run\n";
+  std::printf("%-16s %14s %14s %14s\n", "path", "us/backlog", "ns/message", "estimates");
+
+  double per_message_us = 0.;
+  for (auto batch : { false, true }) {
+    TimestampEstimator te(s_run_number, s_clock_frequency_hz);
+    std::vector<double> elapsed_us;
+    uint64_t daq_start = 1000000000; // NOLINT(build/unsigned)
+    for (size_t bb = 0; bb < n_backlogs; ++bb) {
+      auto backlog = make_backlog(n_messages, daq_start);
+      daq_start += s_clock_frequency_hz;
+
+      auto start = std::chrono::steady_clock::now();
+      if (batch) {
+        te.timesync_batch_callback(backlog.data(), backlog.size());
+      } else {
+        for (auto& tsync : backlog) {
+          te.timesync_callback(tsync);
+        }
+      }
+      elapsed_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(elapsed_us.begin(), elapsed_us.end());
+    auto median_us = elapsed_us[elapsed_us.size() / 2];
+    if (!batch) {
+      per_message_us = median_us;
+    }
+    std::printf("%-16s %14.1f %14.1f %14s\n",
+                batch ? "batch" : "per message",
+                median_us,
+                median_us * 1e3 / static_cast<double>(n_messages),
+                batch ? "1 per backlog" : "1 per message");
+    if (batch) {
+      std::printf("speed-up: %.1fx\n", per_message_us / median_us);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file uri_parser_benchmark.cpp
+ *
+ * Measure the time and number of heap allocations per call of the
+ * connection string parsers
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<size_t> s_allocations{ 0 };
+}
+
+void*
+operator new(size_t size)
+{
+  ++s_allocations;
+  if (void* ptr = std::malloc(size)) // NOLINT
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr); // NOLINT
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr); // NOLINT
+}
+
+using namespace dunedaq::utilities;
+
+namespace {
+template<typename Function>
+void
+measure(const std::string& label, const std::vector<std::string>& inputs, size_t iterations, Function&& f)
+{
+  size_t sink = 0;
+  auto allocations_before = s_allocations.load();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t ii = 0; ii < iterations; ++ii) {
+    sink += f(inputs[ii % inputs.size()]);
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  auto allocations = s_allocations.load() - allocations_before;
+
+  std::cout << label << ": " << elapsed / iterations << " ns/call, "
+            << static_cast<double>(allocations) / iterations << " allocations/call (checksum " << sink << ")\n";
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t iterations = 1000000;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+
+  // Long hostnames, so that small-string optimization does not hide the copies
+  const std::vector<std::string> inputs{ "tcp://np04-srv-021.cern.ch:12345",
+                                         "tcp://[fe80::a00:27ff:fe4e:66a1]:5555",
+                                         "tcp://*:5556",
+                                         "ipc:///tmp/dunedaq/readout-application-socket",
+                                         "inproc://trigger-decision-connection" };
+
+  measure("try_parse_connection_string", inputs, iterations, [](const std::string& input) {
+    ZmqUriView view;
+    try_parse_connection_string(input, view);
+    return view.host.size() + view.port.size();
+  });
+
+  measure("parse_connection_string    ", inputs, iterations, [](const std::string& input) {
+    auto uri = parse_connection_string(input);
+    return uri.host.size() + uri.port.size();
+  });
+
+  auto uri = parse_connection_string(inputs[0]);
+  measure("ZmqUri::to_string          ", inputs, iterations, [&](const std::string&) { return uri.to_string().size(); });
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file worker_thread_stop_benchmark.cpp
+ *
+ * Measure how long it takes to stop N WorkerThreads whose work loops sleep
+ * between iterations, as happens at the stop transition, with plain sleeps
+ * and with StopToken waits
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/WorkerThread.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+std::chrono::milliseconds sleep_period(100);
+
+void
+sleeping_work(std::atomic<bool>& running_flag)
+{
+  while (running_flag.load()) {
+    std::this_thread::sleep_for(sleep_period);
+  }
+}
+
+void
+stoppable_work(const StopToken& stop)
+{
+  while (stop.wait_for(sleep_period)) {
+  }
+}
+
+template<class WorkFunction>
+double
+time_stop(size_t n_threads, WorkFunction do_work)
+{
+  std::vector<std::unique_ptr<WorkerThread>> threads;
+  for (size_t ii = 0; ii < n_threads; ++ii) {
+    threads.emplace_back(std::make_unique<WorkerThread>(do_work));
+    threads.back()->start_working_thread("stopbench");
+  }
+  // Let the workers settle into their sleeps
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  // Modules are stopped one after the other, so the latencies add up
+  auto start = std::chrono::steady_clock::now();
+  for (auto& thread : threads) {
+    thread->stop_working_thread();
+  }
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  std::vector<size_t> counts{ 1, 10, 50 };
+  if (argc > 1) {
+    sleep_period = std::chrono::milliseconds(std::stoul(argv[1]));
+  }
+  if (argc > 2) {
+    counts.clear();
+    for (int ii = 2; ii < argc; ++ii) {
+      counts.push_back(std::stoul(argv[ii]));
+    }
+  }
+
+  std::cout << "Work loops sleep for " << sleep_period.count() << " ms per iteration\n";
+  std::cout << "threads   sleep_for stop ms   StopToken stop ms\n";
+  for (auto n_threads : counts) {
+    auto plain = time_stop(n_threads, sleeping_work);
+    auto token = time_stop(n_threads, stoppable_work);
+    std::printf("%7zu %19.3f %19.3f\n", n_threads, plain, token);
+  }
+
+  return 0;
+}
@@ -0,0 +1,199 @@
+/**
+ *
+ * @file CpuTopology_test.cxx CpuTopology Unit Tests, run against fake sysfs trees
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/CpuTopology.hpp"
+#include "utilities/ReusableThread.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE CpuTopology_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <sched.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+/**
+ * Two-socket machine: 8 CPUs, two hyperthreads per core, one L3 and one NUMA
+ * node per socket, CPU 7 offline, and a NIC on node 1
+ */
+struct FakeSysfs
+{
+  FakeSysfs()
+  {
+    root = std::filesystem::temp_directory_path() / ("CpuTopology_test_" + std::to_string(getpid()));
+    std::filesystem::remove_all(root);
+    auto cpu_dir = root / "devices" / "system" / "cpu";
+    auto node_dir = root / "devices" / "system" / "node";
+
+    write(cpu_dir / "online", "0-6\n");
+    for (int cpu = 0; cpu < 8; ++cpu) {
+      auto dir = cpu_dir / ("cpu" + std::to_string(cpu));
+      int package = cpu / 4;
+      write(dir / "topology" / "core_id", std::to_string((cpu % 4) / 2));
+      write(dir / "topology" / "physical_package_id", std::to_string(package));
+      write(dir / "cache" / "index0" / "level", "1");
+      write(dir / "cache" / "index0" / "shared_cpu_list", std::to_string(cpu));
+      write(dir / "cache" / "index3" / "level", "3");
+      write(dir / "cache" / "index3" / "shared_cpu_list", package == 0 ? "0-3" : "4-7");
+    }
+    write(node_dir / "node0" / "cpulist", "0-3\n");
+    write(node_dir / "node1" / "cpulist", "4-7\n");
+    write(node_dir / "possible", "0-1\n"); // Not a node directory, must be ignored
+
+    auto pci_dir = root / "bus" / "pci" / "devices";
+    write(pci_dir / "0000:3b:00.0" / "numa_node", "1\n");
+    write(pci_dir / "0000:3b:00.0" / "local_cpulist", "4-7\n");
+    write(pci_dir / "0000:af:00.0" / "numa_node", "0\n"); // No local_cpulist
+    write(pci_dir / "0000:00:1f.0" / "numa_node", "-1\n");
+  }
+
+  ~FakeSysfs() { std::filesystem::remove_all(root); }
+
+  static void write(const std::filesystem::path& path, const std::string& content)
+  {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream(path) << content;
+  }
+
+  std::filesystem::path root;
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(CpuTopology_test)
+
+BOOST_AUTO_TEST_CASE(ParseCpuList)
+{
+  BOOST_REQUIRE(CpuTopology::parse_cpu_list("0-3,8,10-11\n") == (std::vector<int>{ 0, 1, 2, 3, 8, 10, 11 }));
+  BOOST_REQUIRE(CpuTopology::parse_cpu_list("5") == std::vector<int>{ 5 });
+  BOOST_REQUIRE(CpuTopology::parse_cpu_list("3,1-2,2").size() == 3);
+  BOOST_REQUIRE(CpuTopology::parse_cpu_list("").empty());
+  BOOST_REQUIRE(CpuTopology::parse_cpu_list("x,4") == std::vector<int>{ 4 });
+}
+
+BOOST_AUTO_TEST_CASE(Discover)
+{
+  FakeSysfs sysfs;
+  auto topology = CpuTopology::discover(sysfs.root.string());
+
+  BOOST_REQUIRE_EQUAL(topology.get_cpus().size(), 7);
+  BOOST_REQUIRE(topology.get_cpu(7) == nullptr);
+  BOOST_REQUIRE_EQUAL(topology.get_cpu(5)->numa_node, 1);
+  BOOST_REQUIRE_EQUAL(topology.get_cpu(5)->package_id, 1);
+  BOOST_REQUIRE_EQUAL(topology.get_cpu(5)->l3_id, 4);
+
+  BOOST_REQUIRE(topology.get_numa_nodes() == (std::vector<int>{ 0, 1 }));
+  BOOST_REQUIRE(topology.get_cpus_in_numa_node(0) == (std::vector<int>{ 0, 1, 2, 3 }));
+  BOOST_REQUIRE(topology.get_cpus_in_numa_node(1) == (std::vector<int>{ 4, 5, 6 }));
+  BOOST_REQUIRE(topology.get_cpus_in_numa_node(2).empty());
+
+  auto l3_groups = topology.get_l3_groups();
+  BOOST_REQUIRE_EQUAL(l3_groups.size(), 2);
+  BOOST_REQUIRE(l3_groups[1] == (std::vector<int>{ 4, 5, 6 }));
+  BOOST_REQUIRE(topology.get_cpus_sharing_l3(2) == (std::vector<int>{ 0, 1, 2, 3 }));
+  BOOST_REQUIRE(topology.get_core_siblings(2) == (std::vector<int>{ 2, 3 }));
+  BOOST_REQUIRE(topology.get_core_siblings(6) == std::vector<int>{ 6 });
+}
+
+BOOST_AUTO_TEST_CASE(DiscoverWithoutOnlineList)
+{
+  FakeSysfs sysfs;
+  auto cpu_dir = sysfs.root / "devices" / "system" / "cpu";
+  std::filesystem::remove(cpu_dir / "online");
+  FakeSysfs::write(cpu_dir / "cpu3" / "online", "0\n");
+
+  auto topology = CpuTopology::discover(sysfs.root.string());
+  BOOST_REQUIRE_EQUAL(topology.get_cpus().size(), 7);
+  BOOST_REQUIRE(topology.get_cpu(3) == nullptr);
+  BOOST_REQUIRE(topology.get_cpu(7) != nullptr);
+
+  BOOST_REQUIRE_THROW(CpuTopology::discover((sysfs.root / "missing").string()), CpuTopologyError);
+}
+
+BOOST_AUTO_TEST_CASE(PciDevices)
+{
+  FakeSysfs sysfs;
+  auto topology = CpuTopology::discover(sysfs.root.string());
+
+  BOOST_REQUIRE_EQUAL(topology.get_pci_numa_node("0000:3b:00.0"), 1);
+  BOOST_REQUIRE(topology.get_pci_local_cpus("0000:3b:00.0") == (std::vector<int>{ 4, 5, 6 }));
+  BOOST_REQUIRE(topology.get_pci_local_cpus("0000:af:00.0") == (std::vector<int>{ 0, 1, 2, 3 }));
+  BOOST_REQUIRE_EQUAL(topology.get_pci_numa_node("0000:00:1f.0"), -1);
+  BOOST_REQUIRE_EQUAL(topology.get_pci_numa_node("0000:ff:00.0"), -1);
+  BOOST_REQUIRE(topology.get_pci_local_cpus("0000:ff:00.0").empty());
+}
+
+BOOST_AUTO_TEST_CASE(Placements)
+{
+  FakeSysfs sysfs;
+  auto topology = CpuTopology::discover(sysfs.root.string());
+
+  auto nic = placement_for_pci_device("0000:3b:00.0", MemoryPolicy::kBind, topology);
+  BOOST_REQUIRE(nic.cpus == (std::vector<int>{ 4, 5, 6 }));
+  BOOST_REQUIRE_EQUAL(nic.memory_node, 1);
+  BOOST_REQUIRE(nic.memory_policy == MemoryPolicy::kBind);
+
+  // A device without a node gives no memory policy
+  auto no_node = placement_for_pci_device("0000:00:1f.0", MemoryPolicy::kBind, topology);
+  BOOST_REQUIRE(no_node.memory_policy == MemoryPolicy::kNone);
+
+  auto node = placement_for_numa_node(0, MemoryPolicy::kPreferred, topology);
+  BOOST_REQUIRE(node.cpus == (std::vector<int>{ 0, 1, 2, 3 }));
+  BOOST_REQUIRE_EQUAL(node.memory_node, 0);
+
+  BOOST_REQUIRE(placement_for_l3_group(5, topology).cpus == (std::vector<int>{ 4, 5, 6 }));
+}
+
+BOOST_AUTO_TEST_CASE(ApplyPlacement)
+{
+  // Pin to one CPU the process may actually use
+  cpu_set_t allowed;
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(allowed), &allowed), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &allowed)) {
+    ++cpu;
+  }
+  ThreadPlacement placement;
+  placement.cpus = { cpu };
+
+  std::atomic<int> seen_cpu{ -1 };
+  WorkerThread worker([&](std::atomic<bool>& running) {
+    seen_cpu = sched_getcpu();
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  worker.set_placement(placement);
+  worker.start_working_thread("placed");
+  while (seen_cpu < 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  worker.stop_working_thread();
+  BOOST_REQUIRE_EQUAL(seen_cpu, cpu);
+
+  ReusableThread reusable(0);
+  reusable.set_placement(placement);
+  seen_cpu = -1;
+  reusable.set_work([&seen_cpu]() { seen_cpu = sched_getcpu(); });
+  reusable.wait_until_ready();
+  BOOST_REQUIRE_EQUAL(seen_cpu, cpu);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
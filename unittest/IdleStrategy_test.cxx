@@ -0,0 +1,171 @@
+/**
+ *
+ * @file IdleStrategy_test.cxx IdleStrategy Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/IdleStrategy.hpp"
+#include "utilities/Pipeline.hpp"
+
+#define BOOST_TEST_MODULE IdleStrategy_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+IdleOptions
+options_for(IdleMode mode)
+{
+  IdleOptions options;
+  options.mode = mode;
+  options.spin_polls = 16;
+  options.yield_polls = 16;
+  options.max_pauses = 16;
+  options.sleep = std::chrono::microseconds(200);
+  return options;
+}
+
+const std::vector<IdleMode> s_modes{ IdleMode::kSpin, IdleMode::kBackoff, IdleMode::kLadder, IdleMode::kPark };
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(IdleStrategy_test)
+
+BOOST_AUTO_TEST_CASE(ReadyStraightAway)
+{
+  StopState state;
+  StopToken stop(state);
+  IdleStrategy idle;
+  BOOST_REQUIRE(idle.wait(stop, []() { return true; }));
+  BOOST_REQUIRE_EQUAL(idle.get_stats().get_waits(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(WaitUntilReady)
+{
+  for (auto mode : s_modes) {
+    BOOST_TEST_MESSAGE("Mode " << to_string(mode));
+    StopState state;
+    StopToken stop(state);
+    IdleStrategy idle(options_for(mode));
+    std::atomic<bool> ready{ false };
+
+    std::thread producer([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      ready = true;
+      idle.wake();
+    });
+    BOOST_REQUIRE(idle.wait(stop, [&]() { return ready.load(); }));
+    producer.join();
+
+    auto& stats = idle.get_stats();
+    BOOST_REQUIRE_EQUAL(stats.get_waits(), 1);
+    BOOST_REQUIRE_EQUAL(stats.get_entries(IdlePhase::kSpin), 1);
+    int64_t total_ns = 0;
+    for (size_t ii = 0; ii < IdleStats::s_phases; ++ii) {
+      total_ns += stats.get_time_ns(static_cast<IdlePhase>(ii));
+    }
+    BOOST_REQUIRE_GE(total_ns, 15000000);
+
+    // The 20 ms wait goes past the spinning phases of every mode but kSpin
+    switch (mode) {
+      case IdleMode::kSpin:
+        BOOST_REQUIRE_GE(stats.get_time_ns(IdlePhase::kSpin), 15000000);
+        break;
+      case IdleMode::kBackoff:
+        BOOST_REQUIRE_EQUAL(stats.get_entries(IdlePhase::kSleep), 1);
+        break;
+      case IdleMode::kLadder:
+        BOOST_REQUIRE_EQUAL(stats.get_entries(IdlePhase::kYield), 1);
+        BOOST_REQUIRE_EQUAL(stats.get_entries(IdlePhase::kSleep), 1);
+        break;
+      case IdleMode::kPark:
+        BOOST_REQUIRE_EQUAL(stats.get_entries(IdlePhase::kPark), 1);
+        BOOST_REQUIRE_GE(stats.get_time_ns(IdlePhase::kPark), 15000000);
+        break;
+    }
+    BOOST_TEST_MESSAGE("Idle statistics: " << stats.to_json().dump());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StopWhileWaiting)
+{
+  for (auto mode : s_modes) {
+    BOOST_TEST_MESSAGE("Mode " << to_string(mode));
+    StopState state;
+    StopToken stop(state);
+    auto options = options_for(mode);
+    options.sleep = std::chrono::seconds(10);
+    IdleStrategy idle(options);
+
+    std::thread stopper([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      state.request_stop();
+    });
+    auto starttime = std::chrono::steady_clock::now();
+    BOOST_REQUIRE(!idle.wait(stop, []() { return false; }));
+    BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime < std::chrono::seconds(1));
+    stopper.join();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(ParkedWakeUps)
+{
+  // Every item is seen although the consumer parks between most of them
+  StopState state;
+  StopToken stop(state);
+  IdleStrategy idle(options_for(IdleMode::kPark));
+  std::atomic<int> produced{ 0 };
+  const int n_items = 2000;
+
+  std::thread producer([&]() {
+    for (int ii = 0; ii < n_items; ++ii) {
+      if (ii % 16 == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+      produced.fetch_add(1);
+      idle.wake();
+    }
+  });
+  int consumed = 0;
+  while (consumed < n_items) {
+    BOOST_REQUIRE(idle.wait(stop, [&]() { return produced.load() > consumed; }));
+    consumed = produced.load();
+  }
+  producer.join();
+  BOOST_REQUIRE_GT(idle.get_stats().get_entries(IdlePhase::kPark), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ParkingPipeline)
+{
+  StageConfig config;
+  config.idle.mode = IdleMode::kPark;
+  config.stall_threshold = std::chrono::milliseconds(10);
+
+  std::vector<int> received;
+  Pipeline<int> pipeline("parking");
+  pipeline.add_stage("double", [](int& value) { value *= 2; return true; }, config);
+  pipeline.add_stage("sink", [&](int& value) { received.push_back(value); return true; }, config);
+  pipeline.start();
+  for (int ii = 0; ii < 1000; ++ii) {
+    if (ii % 100 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    BOOST_REQUIRE(pipeline.push(int(ii)));
+  }
+  pipeline.stop(StopMode::kDrain);
+
+  BOOST_REQUIRE_EQUAL(received.size(), 1000);
+  BOOST_REQUIRE_EQUAL(received.back(), 1998);
+  BOOST_REQUIRE_GT(pipeline.get_stage_idle_stats(1).get_entries(IdlePhase::kPark), 0);
+  BOOST_REQUIRE_EQUAL(pipeline.get_stats()[1]["idle"]["waits"], pipeline.get_stage_idle_stats(1).get_waits());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+/**
+ *
+ * @file PeriodicTimer_test.cxx PeriodicTimer and periodic WorkerThread Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/PeriodicTimer.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE PeriodicTimer_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+PeriodicOptions
+options_for(std::chrono::milliseconds period, MissedTickPolicy policy)
+{
+  PeriodicOptions options;
+  options.period = period;
+  options.missed_tick_policy = policy;
+  options.first_deadline = std::chrono::steady_clock::now() + period;
+  return options;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(PeriodicTimer_test)
+
+BOOST_AUTO_TEST_CASE(NoDrift)
+{
+  StopState state;
+  StopToken stop(state);
+  auto options = options_for(std::chrono::milliseconds(5), MissedTickPolicy::kSkip);
+  PeriodicStats stats;
+  PeriodicTimer timer(options, &stats);
+
+  PeriodicTick tick;
+  for (uint64_t ii = 0; ii < 40; ++ii) { // NOLINT(build/unsigned)
+    BOOST_REQUIRE(timer.wait_next(stop, tick));
+    BOOST_REQUIRE_EQUAL(tick.index, ii);
+    BOOST_REQUIRE(tick.deadline == options.first_deadline + ii * options.period);
+    // Work which would make a sleep_for loop drift
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  // The 40th tick was due 39 periods after the first
+  auto finished = std::chrono::steady_clock::now();
+  BOOST_REQUIRE(finished - options.first_deadline < 39 * options.period + std::chrono::milliseconds(5));
+  BOOST_REQUIRE_EQUAL(stats.get_ticks(), 40);
+  BOOST_REQUIRE_EQUAL(stats.to_json()["lateness"]["count"], 40);
+}
+
+BOOST_AUTO_TEST_CASE(MissedTicks)
+{
+  StopState state;
+  StopToken stop(state);
+  PeriodicTick tick;
+
+  // The first deadline is at 10 ms; at 35 ms the ticks due at 10, 20 and 30 ms have passed
+  {
+    auto options = options_for(std::chrono::milliseconds(10), MissedTickPolicy::kSkip);
+    PeriodicStats stats;
+    PeriodicTimer timer(options, &stats);
+    std::this_thread::sleep_until(options.first_deadline + std::chrono::milliseconds(25));
+    BOOST_REQUIRE(timer.wait_next(stop, tick));
+    BOOST_REQUIRE_EQUAL(tick.index, 3);
+    BOOST_REQUIRE_EQUAL(tick.missed, 3);
+    BOOST_REQUIRE(std::chrono::steady_clock::now() >= options.first_deadline + 3 * options.period);
+    BOOST_REQUIRE_EQUAL(stats.get_missed(), 3);
+  }
+  {
+    auto options = options_for(std::chrono::milliseconds(10), MissedTickPolicy::kCoalesce);
+    PeriodicTimer timer(options);
+    std::this_thread::sleep_until(options.first_deadline + std::chrono::milliseconds(25));
+    BOOST_REQUIRE(timer.wait_next(stop, tick));
+    BOOST_REQUIRE_EQUAL(tick.index, 2);
+    BOOST_REQUIRE_EQUAL(tick.missed, 2);
+    BOOST_REQUIRE(std::chrono::steady_clock::now() < options.first_deadline + 3 * options.period);
+    BOOST_REQUIRE(timer.wait_next(stop, tick));
+    BOOST_REQUIRE_EQUAL(tick.index, 3);
+    BOOST_REQUIRE_EQUAL(tick.missed, 0);
+  }
+  {
+    auto options = options_for(std::chrono::milliseconds(10), MissedTickPolicy::kCatchUp);
+    PeriodicTimer timer(options);
+    std::this_thread::sleep_until(options.first_deadline + std::chrono::milliseconds(25));
+    for (uint64_t ii = 0; ii < 3; ++ii) { // NOLINT(build/unsigned)
+      BOOST_REQUIRE(timer.wait_next(stop, tick));
+      BOOST_REQUIRE_EQUAL(tick.index, ii);
+      BOOST_REQUIRE_EQUAL(tick.missed, 0);
+    }
+    BOOST_REQUIRE(std::chrono::steady_clock::now() < options.first_deadline + 3 * options.period);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StopWhileWaiting)
+{
+  for (auto spin_window : { std::chrono::milliseconds(0), std::chrono::milliseconds(20) }) {
+    StopState state;
+    StopToken stop(state);
+    auto options = options_for(std::chrono::milliseconds(30), MissedTickPolicy::kSkip);
+    options.period = std::chrono::seconds(10);
+    options.first_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(30);
+    options.spin_window = spin_window;
+    PeriodicTimer timer(options);
+
+    PeriodicTick tick;
+    BOOST_REQUIRE(timer.wait_next(stop, tick));
+    std::thread stopper([&]() {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      state.request_stop();
+    });
+    auto starttime = std::chrono::steady_clock::now();
+    BOOST_REQUIRE(!timer.wait_next(stop, tick));
+    BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime < std::chrono::seconds(1));
+    stopper.join();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(PeriodicWorkerThread)
+{
+  std::vector<uint64_t> indices; // NOLINT(build/unsigned)
+  PeriodicOptions options;
+  options.period = std::chrono::milliseconds(2);
+  options.spin_window = std::chrono::microseconds(200);
+  WorkerThread worker(options, [&](const PeriodicTick& tick) { indices.push_back(tick.index); });
+  BOOST_REQUIRE(worker.get_periodic_stats() != nullptr);
+
+  worker.start_working_thread("periodic");
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  worker.stop_working_thread();
+
+  BOOST_REQUIRE_GT(indices.size(), 5);
+  BOOST_REQUIRE_EQUAL(worker.get_periodic_stats()->get_ticks(), indices.size());
+  BOOST_REQUIRE_EQUAL(worker.get_heartbeat().get_count(), indices.size());
+  BOOST_TEST_MESSAGE("Tick statistics: " << worker.get_periodic_stats()->to_json().dump());
+
+  WorkerThread plain([](const StopToken&) {});
+  BOOST_REQUIRE(plain.get_periodic_stats() == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
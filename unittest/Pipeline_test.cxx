@@ -0,0 +1,217 @@
+/**
+ *
+ * @file Pipeline_test.cxx SpscRing and Pipeline Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Pipeline.hpp"
+#include "utilities/SpscRing.hpp"
+
+#define BOOST_TEST_MODULE Pipeline_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(Pipeline_test)
+
+BOOST_AUTO_TEST_CASE(RingBatches)
+{
+  SpscRing<int> ring(5);
+  BOOST_REQUIRE_EQUAL(ring.capacity(), 8);
+
+  std::vector<int> in{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+  BOOST_REQUIRE_EQUAL(ring.try_push_batch(in.data(), in.size()), 8);
+  BOOST_REQUIRE_EQUAL(ring.size(), 8);
+  BOOST_REQUIRE(!ring.try_push(10));
+
+  BOOST_REQUIRE(ring.try_evict_oldest());
+  BOOST_REQUIRE(ring.try_push(8));
+
+  std::vector<int> out(4);
+  BOOST_REQUIRE_EQUAL(ring.try_pop_batch(out.data(), out.size()), 4);
+  BOOST_REQUIRE_EQUAL(out[0], 1);
+  BOOST_REQUIRE_EQUAL(out[3], 4);
+  BOOST_REQUIRE_EQUAL(ring.try_pop_batch(out.data(), out.size()), 4);
+  BOOST_REQUIRE_EQUAL(out[3], 8);
+  BOOST_REQUIRE_EQUAL(ring.try_pop_batch(out.data(), out.size()), 0);
+  BOOST_REQUIRE(!ring.try_evict_oldest());
+}
+
+BOOST_AUTO_TEST_CASE(RingEvictionRace)
+{
+  // The consumer and an evicting producer never hand out the same value
+  SpscRing<int> ring(16);
+  const int n_values = 200000;
+  std::atomic<bool> done{ false };
+  int popped = 0;
+  int last = -1;
+  bool in_order = true;
+  std::thread consumer([&]() {
+    int value = 0;
+    while (!done.load() || ring.size() > 0) {
+      if (ring.try_pop(value)) {
+        in_order = in_order && value > last;
+        last = value;
+        ++popped;
+      }
+    }
+  });
+
+  int n_evicted = 0;
+  for (int ii = 0; ii < n_values; ++ii) {
+    int value = ii;
+    while (!ring.try_push(std::move(value))) {
+      if (ring.try_evict_oldest()) {
+        ++n_evicted;
+      }
+    }
+  }
+  done = true;
+  consumer.join();
+
+  BOOST_REQUIRE(in_order);
+  BOOST_REQUIRE_EQUAL(popped + n_evicted, n_values);
+}
+
+BOOST_AUTO_TEST_CASE(DrainInOrder)
+{
+  std::vector<int> received;
+  Pipeline<int> pipeline("test");
+  for (int stage = 0; stage < 3; ++stage) {
+    pipeline.add_stage("add" + std::to_string(stage), [](int& value) {
+      value += 1;
+      return true;
+    });
+  }
+  // Odd values are filtered out on the way
+  pipeline.add_stage("filter", [](int& value) { return value % 2 == 0; });
+  pipeline.add_stage("sink", [&](int& value) {
+    received.push_back(value);
+    return true;
+  });
+
+  BOOST_REQUIRE_THROW(pipeline.stop(), ThreadingIssue);
+  pipeline.start();
+  BOOST_REQUIRE_THROW(pipeline.start(), ThreadingIssue);
+  BOOST_REQUIRE_THROW(pipeline.add_stage("late", [](int&) { return true; }), ThreadingIssue);
+
+  const int n_values = 100000;
+  for (int ii = 0; ii < n_values; ++ii) {
+    BOOST_REQUIRE(pipeline.push(int(ii)));
+  }
+  pipeline.stop(StopMode::kDrain);
+
+  BOOST_REQUIRE_EQUAL(received.size(), n_values / 2);
+  for (size_t ii = 0; ii < received.size(); ++ii) {
+    BOOST_REQUIRE_EQUAL(received[ii], static_cast<int>(2 * ii + 4));
+  }
+  BOOST_REQUIRE_EQUAL(pipeline.get_stage_stats(0).get_items_in(), n_values);
+  BOOST_REQUIRE_EQUAL(pipeline.get_stage_stats(3).get_items_out(), n_values / 2);
+  BOOST_REQUIRE_EQUAL(pipeline.get_stage_stats(4).get_items_in(), n_values / 2);
+
+  auto stats = pipeline.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.size(), 5);
+  BOOST_REQUIRE_EQUAL(stats[4]["name"], "sink");
+  BOOST_REQUIRE_EQUAL(stats[4]["occupancy"], 0);
+  BOOST_REQUIRE_GT(stats[0]["items_per_second"].get<double>(), 0.);
+
+  BOOST_REQUIRE(!pipeline.push(0));
+}
+
+BOOST_AUTO_TEST_CASE(DropPolicies)
+{
+  for (auto policy : { BackPressure::kDropNewest, BackPressure::kDropOldest }) {
+    std::atomic<bool> release{ false };
+    std::vector<int> received;
+    Pipeline<int> pipeline("drop");
+    pipeline.add_stage("hold", [&](int& value) {
+      while (!release.load()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      received.push_back(value);
+      return true;
+    }, { 8, 1, policy, ThreadAttributes() });
+    pipeline.start();
+
+    // The stage takes the first value and holds on to it while the ring fills up
+    BOOST_REQUIRE(pipeline.push(0));
+    while (pipeline.get_stage_occupancy(0) > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    int accepted = 1;
+    for (int ii = 1; ii < 100; ++ii) {
+      accepted += pipeline.push(int(ii)) ? 1 : 0;
+    }
+    release = true;
+    pipeline.stop(StopMode::kDrain);
+
+    BOOST_REQUIRE_EQUAL(received.size(), 9);
+    BOOST_REQUIRE_EQUAL(pipeline.get_stage_stats(0).get_dropped(), 91);
+    BOOST_REQUIRE_EQUAL(pipeline.get_stage_stats(0).get_peak_occupancy(), 8);
+    if (policy == BackPressure::kDropNewest) {
+      BOOST_REQUIRE_EQUAL(accepted, 9);
+      BOOST_REQUIRE_EQUAL(received.back(), 8);
+    } else {
+      BOOST_REQUIRE_EQUAL(accepted, 100);
+      BOOST_REQUIRE_EQUAL(received[1], 92);
+      BOOST_REQUIRE_EQUAL(received.back(), 99);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Abandon)
+{
+  std::atomic<bool> release{ false };
+  std::atomic<int> sunk{ 0 };
+  auto pipeline = std::make_unique<Pipeline<int>>("abandon");
+  pipeline->add_stage("pass", [](int&) { return true; }, { 16, 4, BackPressure::kBlock, ThreadAttributes() });
+  pipeline->add_stage("slow", [&](int&) {
+    while (!release.load()) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    ++sunk;
+    return true;
+  }, { 16, 1, BackPressure::kBlock, ThreadAttributes() });
+  pipeline->start();
+
+  // Fill both rings; the first stage ends up blocked on the second
+  int pushed = 0;
+  for (int ii = 0; ii < 32; ++ii) {
+    pushed += pipeline->push(int(ii)) ? 1 : 0;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  std::thread releaser([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+  });
+  auto starttime = std::chrono::steady_clock::now();
+  pipeline->stop(StopMode::kAbandon);
+  releaser.join();
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime < std::chrono::seconds(1));
+
+  // Every item was either sunk, or abandoned at some stage's input
+  uint64_t abandoned = // NOLINT(build/unsigned)
+    pipeline->get_stage_stats(0).get_abandoned() + pipeline->get_stage_stats(1).get_abandoned();
+  BOOST_REQUIRE_EQUAL(pushed, 32);
+  BOOST_REQUIRE_EQUAL(static_cast<uint64_t>(sunk.load()) + abandoned, 32); // NOLINT(build/unsigned)
+  BOOST_REQUIRE_GT(abandoned, 0);
+  BOOST_REQUIRE_EQUAL(pipeline->get_stage_occupancy(0) + pipeline->get_stage_occupancy(1), 0);
+
+  // Restart works and a running pipeline is abandoned on destruction
+  pipeline->start();
+  BOOST_REQUIRE(pipeline->push(0));
+  pipeline.reset();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
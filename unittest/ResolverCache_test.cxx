@@ -0,0 +1,142 @@
+/**
+ *
+ * @file ResolverCache_test.cxx ResolverCache class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverCache.hpp"
+
+#include "logging/Logging.hpp"
+
+#define BOOST_TEST_MODULE ResolverCache_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(ResolverCache_test)
+
+BOOST_AUTO_TEST_CASE(HitsAndMisses)
+{
+  ResolverCache cache;
+
+  auto res = cache.resolve("127.0.0.1");
+  BOOST_REQUIRE_EQUAL(res.error, 0);
+  BOOST_REQUIRE_EQUAL(res.addresses.size(), 1);
+  BOOST_REQUIRE_EQUAL(res.addresses[0], "127.0.0.1");
+
+  res = cache.resolve("127.0.0.1");
+  BOOST_REQUIRE_EQUAL(res.addresses.size(), 1);
+  BOOST_REQUIRE_EQUAL(res.addresses[0], "127.0.0.1");
+
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.misses, 1);
+  BOOST_REQUIRE_EQUAL(stats.hits, 1);
+  BOOST_REQUIRE_EQUAL(stats.entries, 1);
+
+  cache.invalidate("127.0.0.1");
+  cache.resolve("127.0.0.1");
+  BOOST_REQUIRE_EQUAL(cache.get_stats().misses, 2);
+
+  cache.reset_stats();
+  BOOST_REQUIRE_EQUAL(cache.get_stats().misses, 0);
+  BOOST_REQUIRE_EQUAL(cache.get_stats().entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(NegativeCaching)
+{
+  ResolverCacheConfig config;
+  config.negative_ttl = std::chrono::seconds(60);
+  ResolverCache cache(config);
+
+  auto res = cache.resolve("nonexistent-host.invalid");
+  BOOST_REQUIRE_NE(res.error, 0);
+  BOOST_REQUIRE_EQUAL(res.addresses.size(), 0);
+
+  res = cache.resolve("nonexistent-host.invalid");
+  BOOST_REQUIRE_NE(res.error, 0);
+  BOOST_REQUIRE(res.error_string != "");
+
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.misses, 1);
+  BOOST_REQUIRE_EQUAL(stats.negative_hits, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Expiry)
+{
+  ResolverCacheConfig config;
+  config.min_ttl = std::chrono::seconds(1);
+  config.max_ttl = std::chrono::seconds(1);
+  ResolverCache cache(config);
+
+  cache.resolve("127.0.0.1");
+  std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+  cache.resolve("127.0.0.1");
+
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.misses, 2);
+  BOOST_REQUIRE_EQUAL(stats.expirations, 1);
+}
+
+BOOST_AUTO_TEST_CASE(Eviction)
+{
+  ResolverCacheConfig config;
+  config.max_entries = 2;
+  ResolverCache cache(config);
+
+  cache.resolve("127.0.0.1");
+  cache.resolve("127.0.0.2");
+  cache.resolve("127.0.0.1"); // 127.0.0.2 is now least recently used
+  cache.resolve("127.0.0.3");
+
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.entries, 2);
+  BOOST_REQUIRE_EQUAL(stats.evictions, 1);
+
+  cache.resolve("127.0.0.1");
+  BOOST_REQUIRE_EQUAL(cache.get_stats().misses, 3);
+  cache.resolve("127.0.0.2");
+  BOOST_REQUIRE_EQUAL(cache.get_stats().misses, 4);
+}
+
+BOOST_AUTO_TEST_CASE(Disabled)
+{
+  ResolverCacheConfig config;
+  config.enabled = false;
+  ResolverCache cache(config);
+
+  cache.resolve("127.0.0.1");
+  cache.resolve("127.0.0.1");
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.hits, 0);
+  BOOST_REQUIRE_EQUAL(stats.entries, 0);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentMissesCoalesce)
+{
+  ResolverCache cache;
+  std::vector<std::thread> threads;
+  for (int ii = 0; ii < 8; ++ii) {
+    threads.emplace_back([&]() {
+      auto res = cache.resolve("localhost");
+      BOOST_CHECK_GE(res.addresses.size(), 1);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = cache.get_stats();
+  BOOST_REQUIRE_EQUAL(stats.misses, 1);
+  BOOST_REQUIRE_EQUAL(stats.hits + stats.coalesced, 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
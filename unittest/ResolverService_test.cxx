@@ -0,0 +1,175 @@
+/**
+ *
+ * @file ResolverService_test.cxx ResolverService class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ResolverService.hpp"
+
+#include "logging/Logging.hpp"
+
+#define BOOST_TEST_MODULE ResolverService_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+using namespace std::chrono_literals;
+
+namespace {
+
+template<typename Predicate>
+bool
+wait_until(Predicate predicate, std::chrono::milliseconds timeout = 2000ms)
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline)
+      return false;
+    std::this_thread::sleep_for(1ms);
+  }
+  return true;
+}
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(ResolverService_test)
+
+BOOST_AUTO_TEST_CASE(ResolveAndNotify)
+{
+  ResolverService service(10ms);
+  service.start("test-resolver");
+
+  std::atomic<int> notifications{ 0 };
+  std::vector<std::string> last;
+  std::mutex last_mutex;
+  auto id = service.subscribe("tcp://127.0.0.1:1234", [&](const std::string&, const std::vector<std::string>& resolved) {
+    std::lock_guard<std::mutex> lk(last_mutex);
+    last = resolved;
+    ++notifications;
+  });
+
+  BOOST_REQUIRE(wait_until([&]() { return notifications.load() == 1; }));
+  {
+    std::lock_guard<std::mutex> lk(last_mutex);
+    BOOST_REQUIRE_EQUAL(last.size(), 1);
+    BOOST_REQUIRE_EQUAL(last[0], "tcp://127.0.0.1:1234");
+  }
+  BOOST_REQUIRE_EQUAL(service.get_endpoints("tcp://127.0.0.1:1234").size(), 1);
+
+  // Several refresh periods with an unchanged address set produce no further notifications
+  std::this_thread::sleep_for(100ms);
+  BOOST_REQUIRE_EQUAL(notifications.load(), 1);
+
+  service.unsubscribe(id);
+  BOOST_REQUIRE_EQUAL(service.get_endpoints("tcp://127.0.0.1:1234").size(), 0);
+
+  auto start = std::chrono::steady_clock::now();
+  service.stop();
+  BOOST_REQUIRE_LT(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(),
+                   1000);
+}
+
+BOOST_AUTO_TEST_CASE(NotifyOnChange)
+{
+  std::atomic<int> generation{ 0 };
+  auto resolver = [&](const std::vector<std::string>& connection_strings) {
+    std::vector<UriResolution> output(connection_strings.size());
+    for (auto& result : output) {
+      result.uris = { "tcp://10.0.0." + std::to_string(generation.load()) + ":1234" };
+    }
+    return output;
+  };
+
+  ResolverService service(std::chrono::hours(1), resolver);
+  service.start("test-resolver");
+
+  std::atomic<int> notifications{ 0 };
+  service.subscribe("tcp://node:1234", [&](const std::string&, const std::vector<std::string>&) { ++notifications; });
+  BOOST_REQUIRE(wait_until([&]() { return notifications.load() == 1; }));
+
+  service.refresh_now();
+  std::this_thread::sleep_for(50ms);
+  BOOST_REQUIRE_EQUAL(notifications.load(), 1);
+
+  generation = 1;
+  service.refresh_now();
+  BOOST_REQUIRE(wait_until([&]() { return notifications.load() == 2; }));
+  BOOST_REQUIRE_EQUAL(service.get_endpoints("tcp://node:1234")[0], "tcp://10.0.0.1:1234");
+
+  // A late subscriber hears about the current state once
+  std::atomic<int> late_notifications{ 0 };
+  service.subscribe("tcp://node:1234", [&](const std::string&, const std::vector<std::string>&) { ++late_notifications; });
+  BOOST_REQUIRE(wait_until([&]() { return late_notifications.load() == 1; }));
+  BOOST_REQUIRE_EQUAL(notifications.load(), 2);
+
+  service.stop();
+}
+
+BOOST_AUTO_TEST_CASE(ShorterPeriodTakesEffect)
+{
+  std::atomic<int> resolutions{ 0 };
+  auto resolver = [&](const std::vector<std::string>& connection_strings) {
+    ++resolutions;
+    return std::vector<UriResolution>(connection_strings.size());
+  };
+
+  ResolverService service(std::chrono::hours(1), resolver);
+  service.subscribe("tcp://node:1234", [](const std::string&, const std::vector<std::string>&) {});
+  service.start("test-resolver");
+  BOOST_REQUIRE(wait_until([&]() { return resolutions.load() == 1; }));
+
+  // The service is part way through an hour-long wait; the new period must apply to it
+  service.set_refresh_period(10ms);
+  BOOST_REQUIRE(wait_until([&]() { return resolutions.load() >= 3; }));
+
+  service.stop();
+}
+
+BOOST_AUTO_TEST_CASE(UnsubscribeWaitsForCallback)
+{
+  ResolverService service(std::chrono::hours(1));
+  service.start("test-resolver");
+
+  std::atomic<bool> in_callback{ false };
+  std::atomic<bool> callback_done{ false };
+  auto id = service.subscribe("tcp://127.0.0.1:1234", [&](const std::string&, const std::vector<std::string>&) {
+    in_callback = true;
+    std::this_thread::sleep_for(100ms);
+    callback_done = true;
+  });
+
+  BOOST_REQUIRE(wait_until([&]() { return in_callback.load(); }));
+  service.unsubscribe(id);
+  BOOST_REQUIRE(callback_done.load());
+
+  service.stop();
+}
+
+BOOST_AUTO_TEST_CASE(ThrowingCallback)
+{
+  ResolverService service(std::chrono::hours(1));
+  service.start("test-resolver");
+
+  // A subscriber which throws is reported, and the others are still notified
+  service.subscribe("tcp://127.0.0.1:1234",
+                    [](const std::string&, const std::vector<std::string>&) { throw std::runtime_error("bad subscriber"); });
+  std::atomic<int> notifications{ 0 };
+  service.subscribe("tcp://127.0.0.1:1234", [&](const std::string&, const std::vector<std::string>&) { ++notifications; });
+  BOOST_REQUIRE(wait_until([&]() { return notifications.load() == 1; }));
+  BOOST_REQUIRE(service.is_running());
+
+  service.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
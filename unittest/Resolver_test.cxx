@@ -19,10 +19,39 @@
 #include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <random>
 #include <regex>
+#include <string>
+#include <vector>
 
 using namespace dunedaq::utilities;
 
+namespace {
+
+// The original, allocating implementation of parse_connection_string, kept as a reference
+ZmqUri
+legacy_parse_connection_string(std::string connection_string)
+{
+  ZmqUri output;
+
+  if (connection_string.find("://") == std::string::npos) {
+    throw InvalidUri(ERS_HERE, connection_string);
+  }
+
+  output.scheme = connection_string.substr(0, connection_string.find("://"));
+  connection_string = connection_string.substr(connection_string.find("://") + 3);
+
+  if (connection_string.find(":") != std::string::npos) {
+    output.port = connection_string.substr(connection_string.find(":") + 1);
+    connection_string = connection_string.substr(0, connection_string.find(":"));
+  }
+  output.host = connection_string;
+
+  return output;
+}
+
+} // namespace ""
+
 BOOST_AUTO_TEST_CASE(HostnameLookup)
 {
   TLOG() << "Test HostnameLookup BEGIN";
@@ -69,3 +98,129 @@ BOOST_AUTO_TEST_CASE(UriLookup)
   TLOG() << "Test UriLookup END";
 }
 
+
+BOOST_AUTO_TEST_CASE(BatchUriLookup)
+{
+  TLOG() << "Test BatchUriLookup BEGIN";
+  std::vector<std::string> uris{ "tcp://127.0.0.1:1234", "inproc://foo",  "blah",
+                                 "tcp://localhost:1235", "tcp://127.0.0.1:1236", "tcp://nonexistent-host.invalid:1234" };
+  auto res = resolve_uri_hostnames(uris, 4);
+  BOOST_REQUIRE_EQUAL(res.size(), uris.size());
+
+  BOOST_REQUIRE(res[0].ok());
+  BOOST_REQUIRE_EQUAL(res[0].uris.size(), 1);
+  BOOST_REQUIRE_EQUAL(res[0].uris[0], "tcp://127.0.0.1:1234");
+
+  BOOST_REQUIRE(res[1].ok());
+  BOOST_REQUIRE_EQUAL(res[1].uris[0], "inproc://foo");
+
+  BOOST_REQUIRE(!res[2].ok());
+  BOOST_REQUIRE_EQUAL(res[2].uris.size(), 0);
+
+  BOOST_REQUIRE(res[3].ok());
+  BOOST_REQUIRE_GE(res[3].uris.size(), 1);
+  BOOST_REQUIRE_EQUAL(res[3].uris[0], "tcp://127.0.0.1:1235");
+
+  BOOST_REQUIRE(res[4].ok());
+  BOOST_REQUIRE_EQUAL(res[4].uris[0], "tcp://127.0.0.1:1236");
+
+  BOOST_REQUIRE(!res[5].ok());
+  TLOG() << "Test BatchUriLookup END";
+}
+
+BOOST_AUTO_TEST_CASE(UriParsing)
+{
+  auto uri = parse_connection_string("tcp://localhost:1234");
+  BOOST_REQUIRE_EQUAL(uri.scheme, "tcp");
+  BOOST_REQUIRE_EQUAL(uri.host, "localhost");
+  BOOST_REQUIRE_EQUAL(uri.port, "1234");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://localhost:1234");
+
+  uri = parse_connection_string("tcp://[::1]:5555");
+  BOOST_REQUIRE_EQUAL(uri.host, "::1");
+  BOOST_REQUIRE_EQUAL(uri.port, "5555");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "tcp://[::1]:5555");
+
+  uri = parse_connection_string("tcp://[fe80::1]");
+  BOOST_REQUIRE_EQUAL(uri.host, "fe80::1");
+  BOOST_REQUIRE_EQUAL(uri.port, "");
+
+  uri = parse_connection_string("tcp://*:5555");
+  BOOST_REQUIRE_EQUAL(uri.host, "*");
+  BOOST_REQUIRE_EQUAL(uri.port, "5555");
+
+  uri = parse_connection_string("ipc:///tmp/socket:0");
+  BOOST_REQUIRE_EQUAL(uri.host, "/tmp/socket:0");
+  BOOST_REQUIRE_EQUAL(uri.port, "");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "ipc:///tmp/socket:0");
+
+  uri = parse_connection_string("inproc://foo:bar");
+  BOOST_REQUIRE_EQUAL(uri.host, "foo:bar");
+  BOOST_REQUIRE_EQUAL(uri.to_string(), "inproc://foo:bar");
+
+  ZmqUriView view;
+  std::string buffer = "tcp://node01:5000";
+  BOOST_REQUIRE(try_parse_connection_string(buffer, view));
+  BOOST_REQUIRE(view.host.data() == buffer.data() + 6);
+  BOOST_REQUIRE(view.port == "5000");
+
+  BOOST_REQUIRE(!try_parse_connection_string("blah", view));
+  BOOST_REQUIRE(!try_parse_connection_string("tcp://[::1", view));
+  BOOST_REQUIRE(!try_parse_connection_string("tcp://[::1]5555", view));
+  BOOST_REQUIRE_THROW(parse_connection_string("tcp://[::1"), InvalidUri);
+
+  auto res = resolve_uri_hostname("tcp://*:1234");
+  BOOST_REQUIRE_EQUAL(res.size(), 1);
+  BOOST_REQUIRE_EQUAL(res[0], "tcp://*:1234");
+
+  res = resolve_uri_hostname("tcp://[::1]:1234");
+  BOOST_REQUIRE_EQUAL(res.size(), 1);
+  BOOST_REQUIRE_EQUAL(res[0], "tcp://[::1]:1234");
+}
+
+BOOST_AUTO_TEST_CASE(UriParsingMatchesLegacy)
+{
+  // Random strings built from URI-ish tokens; wherever the original parser was
+  // well-defined (not ipc/inproc, no IPv6 brackets) the results must agree
+  const std::vector<std::string> tokens{ "tcp", "udp", "ipc", "inproc", "://", ":", "/", "[", "]", "*",
+                                         "a",   "host", "1", "5555", ".",      "-",   "",  "::" };
+  std::mt19937 generator(12345);
+  std::uniform_int_distribution<size_t> token_dist(0, tokens.size() - 1);
+  std::uniform_int_distribution<int> length_dist(0, 8);
+
+  size_t compared = 0;
+  for (int iteration = 0; iteration < 200000; ++iteration) {
+    std::string input;
+    auto length = length_dist(generator);
+    for (int ii = 0; ii < length; ++ii) {
+      input += tokens[token_dist(generator)];
+    }
+
+    bool legacy_valid = true;
+    ZmqUri legacy;
+    try {
+      legacy = legacy_parse_connection_string(input);
+    } catch (InvalidUri const&) {
+      legacy_valid = false;
+    }
+
+    ZmqUriView view;
+    bool valid = try_parse_connection_string(input, view);
+
+    if (!legacy_valid) {
+      BOOST_REQUIRE_MESSAGE(!valid, "Accepted invalid URI " << input);
+      continue;
+    }
+    auto rest = input.substr(input.find("://") + 3);
+    if (legacy.scheme == "ipc" || legacy.scheme == "inproc" || (!rest.empty() && rest[0] == '[')) {
+      continue;
+    }
+
+    BOOST_REQUIRE_MESSAGE(valid, "Rejected valid URI " << input);
+    BOOST_REQUIRE_EQUAL(std::string(view.scheme), legacy.scheme);
+    BOOST_REQUIRE_EQUAL(std::string(view.host), legacy.host);
+    BOOST_REQUIRE_EQUAL(std::string(view.port), legacy.port);
+    ++compared;
+  }
+  BOOST_REQUIRE_GT(compared, 1000);
+}
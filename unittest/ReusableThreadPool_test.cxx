@@ -0,0 +1,123 @@
+/**
+ *
+ * @file ReusableThreadPool_test.cxx ReusableThreadPool class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThreadPool.hpp"
+
+#define BOOST_TEST_MODULE ReusableThreadPool_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace dunedaq::utilities;
+
+namespace {
+template<typename Predicate>
+bool
+wait_until(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::seconds(10))
+{
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(ReusableThreadPool_test)
+
+BOOST_AUTO_TEST_CASE(CopyAndMoveSemantics)
+{
+  BOOST_REQUIRE(!std::is_copy_constructible_v<ReusableThreadPool>);
+  BOOST_REQUIRE(!std::is_copy_assignable_v<ReusableThreadPool>);
+  BOOST_REQUIRE(!std::is_move_constructible_v<ReusableThreadPool>);
+  BOOST_REQUIRE(!std::is_move_assignable_v<ReusableThreadPool>);
+}
+
+BOOST_AUTO_TEST_CASE(RunsAllTasks)
+{
+  ReusableThreadPool pool(4, "pooltest");
+  BOOST_REQUIRE_EQUAL(pool.get_thread_count(), 4);
+
+  std::atomic<int> counter{ 0 };
+  for (int ii = 0; ii < 10000; ++ii) {
+    pool.submit([&counter](int increment) { counter += increment; }, 1);
+  }
+  BOOST_REQUIRE(wait_until([&]() { return counter == 10000; }));
+  BOOST_REQUIRE_EQUAL(pool.get_queued_tasks(), 0);
+  BOOST_REQUIRE(wait_until([&]() { return pool.get_tasks_executed() == 10000; }));
+
+  // Move-only arguments
+  std::atomic<int> seen{ 0 };
+  pool.submit([&seen](std::unique_ptr<int>& value) { seen = *value; }, std::make_unique<int>(7));
+  BOOST_REQUIRE(wait_until([&]() { return seen == 7; }));
+}
+
+BOOST_AUTO_TEST_CASE(NestedSubmission)
+{
+  ReusableThreadPool pool(2, "nested");
+
+  std::atomic<int> counter{ 0 };
+  for (int ii = 0; ii < 100; ++ii) {
+    pool.submit([&pool, &counter]() {
+      for (int jj = 0; jj < 10; ++jj) {
+        pool.submit([&counter]() { ++counter; });
+      }
+    });
+  }
+  BOOST_REQUIRE(wait_until([&]() { return counter == 1000; }));
+}
+
+BOOST_AUTO_TEST_CASE(IdleThreadsSteal)
+{
+  ReusableThreadPool pool(2, "steal");
+
+  // Occupy one thread; round-robin puts half of the following tasks behind it
+  std::atomic<bool> release{ false };
+  std::atomic<bool> blocked{ false };
+  pool.submit([&]() {
+    blocked = true;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  BOOST_REQUIRE(wait_until([&]() { return blocked.load(); }));
+
+  std::atomic<int> counter{ 0 };
+  for (int ii = 0; ii < 100; ++ii) {
+    pool.submit([&counter]() { ++counter; });
+  }
+  BOOST_REQUIRE(wait_until([&]() { return counter == 100; }));
+  BOOST_REQUIRE_GT(pool.get_tasks_stolen(), 0);
+
+  release = true;
+}
+
+BOOST_AUTO_TEST_CASE(DestructionRunsQueuedTasks)
+{
+  std::atomic<int> counter{ 0 };
+  {
+    ReusableThreadPool pool(3, "drain");
+    for (int ii = 0; ii < 1000; ++ii) {
+      pool.submit([&counter]() {
+        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        ++counter;
+      });
+    }
+  }
+  BOOST_REQUIRE_EQUAL(counter, 1000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -14,9 +14,62 @@
 
 #include "boost/test/unit_test.hpp"
 
+#include <atomic>
+#include <array>
 #include <chrono>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace {
+std::atomic<size_t> s_allocations{ 0 };
+}
+
+// Count heap allocations. The whole set of replaceable operators is replaced,
+// so that every allocation and deallocation goes through malloc and free. The
+// two doing so are not inlined, lest GCC see malloc'd memory reach operator
+// delete, or free() reach the result of a new-expression (-Wmismatched-new-delete).
+__attribute__((noinline)) void*
+operator new(size_t size)
+{
+  ++s_allocations;
+  if (void* ptr = std::malloc(size)) // NOLINT
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void*
+operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+__attribute__((noinline)) void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr); // NOLINT
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+  operator delete(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+  operator delete(ptr);
+}
 
 using namespace dunedaq::utilities;
 
@@ -56,4 +109,213 @@ BOOST_AUTO_TEST_CASE(SetWork)
     std::this_thread::sleep_for(std::chrono::milliseconds(1));
   }
   BOOST_REQUIRE_EQUAL(result, 5);
-}
\ No newline at end of file
+}
+
+BOOST_AUTO_TEST_CASE(WaitStrategies)
+{
+  ReusableThread worker(3);
+  BOOST_REQUIRE(worker.get_wait_strategy() == ReusableThread::WaitStrategy::kBlock);
+
+  for (auto strategy : { ReusableThread::WaitStrategy::kBlock,
+                         ReusableThread::WaitStrategy::kSpin,
+                         ReusableThread::WaitStrategy::kSpinYield,
+                         ReusableThread::WaitStrategy::kSpinPark }) {
+    worker.set_wait_strategy(strategy, 100);
+    BOOST_REQUIRE(worker.get_wait_strategy() == strategy);
+
+    // Let the worker settle into its idle state before handing over work
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    std::atomic<int> counter{ 0 };
+    for (int ii = 0; ii < 1000; ++ii) {
+      while (!worker.set_work([&counter]() { ++counter; })) {
+      }
+    }
+    while (!worker.get_readiness()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    BOOST_REQUIRE_EQUAL(counter, 1000);
+  }
+
+  // Destruction must not hang whatever the strategy
+  worker.set_wait_strategy(ReusableThread::WaitStrategy::kSpin);
+}
+
+BOOST_AUTO_TEST_CASE(MoveOnlyArguments)
+{
+  ReusableThread worker(4);
+
+  std::atomic<int> seen{ 0 };
+  auto value = std::make_unique<int>(42);
+  BOOST_REQUIRE(worker.set_work([&seen](std::unique_ptr<int>& p) { seen = *p; }, std::move(value)));
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(seen, 42);
+
+  // Stored arguments are lvalues, so work functions written for std::bind may take them by reference
+  BOOST_REQUIRE(worker.set_work([&seen](int& counter) { seen = ++counter; }, 6));
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(seen, 7);
+
+  // The task, and everything it captured, is released once it has run
+  auto shared = std::make_shared<int>(1);
+  BOOST_REQUIRE(worker.set_work([](std::shared_ptr<int>) {}, shared));
+  while (!worker.get_readiness()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  BOOST_REQUIRE_EQUAL(shared.use_count(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(DispatchDoesNotAllocate)
+{
+  ReusableThread worker(5);
+
+  // Larger than the small buffer of std::function
+  std::array<uint64_t, 8> payload{}; // NOLINT(build/unsigned)
+  std::atomic<uint64_t> sum{ 0 };    // NOLINT(build/unsigned)
+  auto task = [&sum](const std::array<uint64_t, 8>& data, uint64_t extra) { // NOLINT(build/unsigned)
+    sum += data[0] + extra;
+  };
+
+  // Warm up, so that any lazily allocated state exists before counting
+  for (int ii = 0; ii < 10; ++ii) {
+    while (!worker.set_work(task, payload, 1)) {
+    }
+  }
+  while (!worker.get_readiness()) {
+  }
+
+  auto allocations_before = s_allocations.load();
+  for (uint64_t ii = 0; ii < 10000; ++ii) { // NOLINT(build/unsigned)
+    payload[0] = ii;
+    while (!worker.set_work(task, payload, ii)) {
+    }
+  }
+  while (!worker.get_readiness()) {
+  }
+  auto allocations = s_allocations.load() - allocations_before;
+
+  BOOST_REQUIRE_EQUAL(allocations, 0);
+  BOOST_REQUIRE_GT(sum.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TrackedWork)
+{
+  ReusableThread worker(6);
+  TaskCompletion completion;
+  BOOST_REQUIRE(completion.ready());
+
+  std::atomic<bool> release{ false };
+  BOOST_REQUIRE(worker.set_work_tracked(completion, [&release]() {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }));
+  BOOST_REQUIRE(!completion.ready());
+  BOOST_REQUIRE(!completion.wait_for(std::chrono::milliseconds(20)));
+
+  release = true;
+  completion.wait();
+  BOOST_REQUIRE(completion.ready());
+  worker.wait_until_ready();
+  BOOST_REQUIRE(worker.get_readiness());
+
+  // The same completion can track the next task
+  result = 0;
+  BOOST_REQUIRE(worker.set_work_tracked(completion, test_fun, 9));
+  BOOST_REQUIRE(completion.wait_for(std::chrono::seconds(10)));
+  BOOST_REQUIRE_EQUAL(result, 9);
+}
+
+BOOST_AUTO_TEST_CASE(WaitUntilReady)
+{
+  ReusableThread worker(7);
+  worker.wait_until_ready(); // Nothing assigned, returns at once
+
+  for (int ii = 0; ii < 100; ++ii) {
+    BOOST_REQUIRE(worker.set_work([ii]() { result = ii; }));
+    worker.wait_until_ready();
+    BOOST_REQUIRE_EQUAL(result, ii);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(DestructorFinishesTask)
+{
+  result = 0;
+  {
+    ReusableThread worker(8);
+    worker.set_work(test_fun, 11);
+  }
+  BOOST_REQUIRE_EQUAL(result, 11);
+}
+
+BOOST_AUTO_TEST_CASE(QueuedWork)
+{
+  ReusableThread worker(9, 5);
+  BOOST_REQUIRE_EQUAL(worker.get_queue_capacity(), 8);
+
+  // Hold the worker in the first task, so that the following ones queue up
+  std::atomic<bool> release{ false };
+  TaskCompletion started;
+  BOOST_REQUIRE(worker.set_work_tracked(started, []() {}));
+  started.wait();
+  BOOST_REQUIRE(worker.try_submit([&release]() {
+                  while (!release) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                  }
+                }) == ReusableThread::SubmitResult::kAccepted);
+
+  std::vector<int> order;
+  int accepted = 0;
+  while (worker.try_submit([&order](int value) { order.push_back(value); }, accepted) ==
+         ReusableThread::SubmitResult::kAccepted) {
+    ++accepted;
+  }
+  // The blocking task may or may not still occupy a cell
+  BOOST_REQUIRE_GE(accepted, 7);
+  BOOST_REQUIRE_LE(accepted, 8);
+
+  // A rejected submission leaves move-only arguments untouched
+  auto value = std::make_unique<int>(3);
+  BOOST_REQUIRE(worker.try_submit([](std::unique_ptr<int>&) {}, std::move(value)) ==
+                ReusableThread::SubmitResult::kFull);
+  BOOST_REQUIRE(value != nullptr);
+
+  release = true;
+  worker.wait_until_ready();
+  BOOST_REQUIRE_EQUAL(worker.get_queued_tasks(), 0);
+  BOOST_REQUIRE_EQUAL(order.size(), static_cast<size_t>(accepted));
+  for (int ii = 0; ii < accepted; ++ii) {
+    BOOST_REQUIRE_EQUAL(order[ii], ii);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(BatchSubmission)
+{
+  std::atomic<int> counter{ 0 };
+  {
+    ReusableThread worker(10, 64);
+    for (int round = 0; round < 100; ++round) {
+      std::vector<ReusableThread::Task> batch;
+      for (int ii = 0; ii < 16; ++ii) {
+        batch.emplace_back([&counter]() { ++counter; });
+      }
+      auto first = batch.begin();
+      while (first != batch.end()) {
+        first += worker.try_submit_batch(first, batch.end());
+      }
+    }
+    // The destructor runs whatever is still queued
+  }
+  BOOST_REQUIRE_EQUAL(counter, 1600);
+
+  // Without a queue, at most one task is accepted
+  ReusableThread worker(11);
+  std::vector<ReusableThread::Task> batch;
+  batch.emplace_back([]() {});
+  batch.emplace_back([]() {});
+  BOOST_REQUIRE_LE(worker.try_submit_batch(batch.begin(), batch.end()), 1);
+}
@@ -0,0 +1,225 @@
+/**
+ *
+ * @file ServiceRecord_test.cxx SRV lookup Unit Tests, run against a local stub DNS responder
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
+
+#include "logging/Logging.hpp"
+
+#define BOOST_TEST_MODULE ServiceRecord_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+/**
+ * Minimal UDP DNS responder which answers SRV queries from a fixed table
+ * and replies NXDOMAIN to everything else
+ */
+class StubDnsServer
+{
+public:
+  explicit StubDnsServer(std::map<std::string, std::vector<ServiceRecord>> records)
+    : m_records(std::move(records))
+  {
+    m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    bind(m_socket, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)); // NOLINT
+    socklen_t length = sizeof(address);
+    getsockname(m_socket, reinterpret_cast<struct sockaddr*>(&address), &length); // NOLINT
+    m_port = ntohs(address.sin_port);
+    m_thread = std::thread([this]() { serve(); });
+  }
+
+  ~StubDnsServer()
+  {
+    m_running = false;
+    m_thread.join();
+    close(m_socket);
+  }
+
+  uint16_t port() const { return m_port; } // NOLINT(build/unsigned)
+  int queries() const { return m_queries.load(); }
+
+private:
+  void serve()
+  {
+    while (m_running) {
+      struct pollfd pfd = { m_socket, POLLIN, 0 };
+      if (poll(&pfd, 1, 10) <= 0)
+        continue;
+
+      unsigned char query[512];
+      struct sockaddr_in peer;
+      socklen_t peer_length = sizeof(peer);
+      auto len = recvfrom(
+        m_socket, query, sizeof(query), 0, reinterpret_cast<struct sockaddr*>(&peer), &peer_length); // NOLINT
+      if (len < 12)
+        continue;
+      ++m_queries;
+
+      // Decode the question name
+      std::string name;
+      size_t pos = 12;
+      while (pos < static_cast<size_t>(len) && query[pos] != 0) {
+        if (!name.empty())
+          name += ".";
+        name.append(reinterpret_cast<char*>(query + pos + 1), query[pos]); // NOLINT
+        pos += query[pos] + 1;
+      }
+      size_t question_end = pos + 5; // terminating zero, type, class
+
+      std::vector<unsigned char> reply(query, query + question_end);
+      reply[2] = 0x84; // Response, authoritative
+      reply[3] = 0x00;
+      reply[6] = reply[7] = reply[8] = reply[9] = reply[10] = reply[11] = 0;
+
+      auto found = m_records.find(name);
+      if (found == m_records.end()) {
+        reply[3] = 0x03; // NXDOMAIN
+      } else {
+        reply[7] = static_cast<unsigned char>(found->second.size());
+        for (auto const& record : found->second) {
+          std::vector<unsigned char> rdata;
+          put16(rdata, record.priority);
+          put16(rdata, record.weight);
+          put16(rdata, record.port);
+          put_name(rdata, record.host);
+
+          put16(reply, 0xC00C); // Pointer to the question name
+          put16(reply, 33);     // SRV
+          put16(reply, 1);      // IN
+          put16(reply, static_cast<uint16_t>(record.ttl >> 16));
+          put16(reply, static_cast<uint16_t>(record.ttl & 0xFFFF));
+          put16(reply, static_cast<uint16_t>(rdata.size()));
+          reply.insert(reply.end(), rdata.begin(), rdata.end());
+        }
+      }
+      sendto(
+        m_socket, reply.data(), reply.size(), 0, reinterpret_cast<struct sockaddr*>(&peer), peer_length); // NOLINT
+    }
+  }
+
+  static void put16(std::vector<unsigned char>& buffer, uint16_t value) // NOLINT(build/unsigned)
+  {
+    buffer.push_back(static_cast<unsigned char>(value >> 8));
+    buffer.push_back(static_cast<unsigned char>(value & 0xFF));
+  }
+
+  static void put_name(std::vector<unsigned char>& buffer, const std::string& name)
+  {
+    size_t start = 0;
+    while (start < name.size()) {
+      auto end = name.find('.', start);
+      if (end == std::string::npos)
+        end = name.size();
+      if (end > start) {
+        buffer.push_back(static_cast<unsigned char>(end - start));
+        buffer.insert(buffer.end(), name.begin() + start, name.begin() + end);
+      }
+      start = end + 1;
+    }
+    buffer.push_back(0);
+  }
+
+  std::map<std::string, std::vector<ServiceRecord>> m_records;
+  int m_socket;
+  uint16_t m_port; // NOLINT(build/unsigned)
+  std::atomic<bool> m_running{ true };
+  std::atomic<int> m_queries{ 0 };
+  std::thread m_thread;
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(ServiceRecord_test)
+
+BOOST_AUTO_TEST_CASE(OrderServiceRecords)
+{
+  std::vector<ServiceRecord> records{ { "c", 3, 20, 0, 60 }, { "a", 1, 10, 0, 60 }, { "b", 2, 10, 5, 60 } };
+  order_service_records(records);
+  BOOST_REQUIRE_EQUAL(records[2].host, "c");
+  BOOST_REQUIRE(records[0].priority == 10 && records[1].priority == 10);
+
+  // With a zero-weight and a heavily weighted record, the heavy one should usually come first
+  int heavy_first = 0;
+  for (int ii = 0; ii < 1000; ++ii) {
+    std::vector<ServiceRecord> weighted{ { "light", 1, 10, 0, 60 }, { "heavy", 2, 10, 1000, 60 } };
+    order_service_records(weighted);
+    if (weighted[0].host == "heavy")
+      ++heavy_first;
+  }
+  BOOST_REQUIRE_GT(heavy_first, 900);
+}
+
+BOOST_AUTO_TEST_CASE(StubLookup)
+{
+  StubDnsServer server({ { "_daq._tcp.example.test",
+                           { { "node2.example.test", 5001, 20, 0, 30 },
+                             { "node1.example.test", 5000, 10, 0, 60 },
+                             { ".", 5002, 30, 0, 60 } } } });
+  set_nameservers({ "127.0.0.1:" + std::to_string(server.port()) });
+  ResolverCache::instance().clear();
+  ResolverCache::instance().reset_stats();
+
+  auto result = lookup_service("_daq._tcp.example.test");
+  BOOST_REQUIRE_EQUAL(result.error, 0);
+  BOOST_REQUIRE_EQUAL(result.records.size(), 2);
+  BOOST_REQUIRE_EQUAL(result.records[0].host, "node1.example.test");
+  BOOST_REQUIRE_EQUAL(result.records[0].port, 5000);
+  BOOST_REQUIRE_EQUAL(result.records[1].host, "node2.example.test");
+  BOOST_REQUIRE_EQUAL(result.ttl_seconds, 30);
+
+  auto uris = get_service_uris("_daq._tcp.example.test");
+  BOOST_REQUIRE_EQUAL(uris.size(), 2);
+  BOOST_REQUIRE_EQUAL(uris[0].to_string(), "tcp://node1.example.test:5000");
+  BOOST_REQUIRE_EQUAL(uris[1].to_string(), "tcp://node2.example.test:5001");
+
+  // The second lookup is answered from the cache
+  auto queries = server.queries();
+  get_service_records("_daq._tcp.example.test");
+  BOOST_REQUIRE_EQUAL(server.queries(), queries);
+  BOOST_REQUIRE_EQUAL(ResolverCache::instance().get_stats().hits, 1);
+
+  // Unknown services fail, and the failure is cached
+  auto missing = get_service_records("_missing._tcp.example.test");
+  BOOST_REQUIRE_EQUAL(missing.size(), 0);
+  queries = server.queries();
+  get_service_records("_missing._tcp.example.test");
+  BOOST_REQUIRE_EQUAL(server.queries(), queries);
+
+  set_nameservers({});
+}
+
+BOOST_AUTO_TEST_CASE(InvalidNameserver)
+{
+  BOOST_REQUIRE_THROW(set_nameservers({ "not-an-address" }), InvalidUri);
+  BOOST_REQUIRE_THROW(set_nameservers({ "127.0.0.1:dns" }), InvalidUri);
+  BOOST_REQUIRE_THROW(set_nameservers({ "127.0.0.1:0" }), InvalidUri);
+  BOOST_REQUIRE_THROW(set_nameservers({ "127.0.0.1:65536" }), InvalidUri);
+  BOOST_REQUIRE_THROW(set_nameservers({ "127.0.0.1:" }), InvalidUri);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,137 @@
+/**
+ *
+ * @file StaticHostTable_test.cxx StaticHostTable class Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Resolver.hpp"
+#include "utilities/ResolverCache.hpp"
+#include "utilities/StaticHostTable.hpp"
+
+#define BOOST_TEST_MODULE StaticHostTable_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace dunedaq::utilities;
+
+namespace {
+
+struct TableFiles
+{
+  TableFiles()
+  {
+    auto dir = std::filesystem::temp_directory_path();
+    auto pid = std::to_string(getpid());
+    hosts_path = (dir / ("StaticHostTable_test_hosts_" + pid)).string();
+    table_path = (dir / ("StaticHostTable_test_table_" + pid)).string();
+
+    std::ofstream hosts(hosts_path);
+    hosts << "# DAQ hosts\n"
+          << "10.73.136.1   daq-node-01 daq-node-01.example.test   # primary\n"
+          << "10.73.136.2   daq-node-02\n"
+          << "10.73.137.2   daq-node-02\n"
+          << "fe80::1       daq-node-03\n"
+          << "10.73.138.4   Daq-Node-04.Example.Test\n"
+          << "\n";
+    for (int ii = 0; ii < 500; ++ii) {
+      hosts << "10.0." << ii / 250 << "." << ii % 250 << " bulk-" << ii << "\n";
+    }
+  }
+  ~TableFiles()
+  {
+    std::filesystem::remove(hosts_path);
+    std::filesystem::remove(table_path);
+  }
+  std::string hosts_path;
+  std::string table_path;
+};
+
+} // namespace ""
+
+BOOST_AUTO_TEST_SUITE(StaticHostTable_test)
+
+BOOST_AUTO_TEST_CASE(CompileAndLookup)
+{
+  TableFiles files;
+  StaticHostTable::compile(files.hosts_path, files.table_path);
+  StaticHostTable table(files.table_path);
+
+  BOOST_REQUIRE_EQUAL(table.size(), 504);
+
+  std::vector<std::string> addresses;
+  BOOST_REQUIRE(table.lookup("daq-node-01", addresses));
+  BOOST_REQUIRE_EQUAL(addresses.size(), 1);
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.136.1");
+
+  BOOST_REQUIRE(table.lookup("daq-node-01.example.test", addresses));
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.136.1");
+
+  BOOST_REQUIRE(table.lookup("daq-node-02", addresses));
+  BOOST_REQUIRE_EQUAL(addresses.size(), 2);
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.136.2");
+  BOOST_REQUIRE_EQUAL(addresses[1], "10.73.137.2");
+
+  // Names match whatever their case, in the file and in the query
+  BOOST_REQUIRE(table.lookup("DAQ-Node-01.example.TEST", addresses));
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.136.1");
+  BOOST_REQUIRE(table.lookup("daq-node-04.example.test", addresses));
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.138.4");
+  BOOST_REQUIRE(table.lookup("DAQ-NODE-04.EXAMPLE.TEST", addresses));
+  BOOST_REQUIRE_EQUAL(addresses[0], "10.73.138.4");
+
+  BOOST_REQUIRE(!table.lookup("daq-node-03", addresses)); // IPv6 only
+  BOOST_REQUIRE(!table.lookup("daq-node", addresses));
+  BOOST_REQUIRE(!table.lookup("", addresses));
+
+  for (int ii = 0; ii < 500; ++ii) {
+    BOOST_REQUIRE(table.lookup("bulk-" + std::to_string(ii), addresses));
+    BOOST_REQUIRE_EQUAL(addresses[0], "10.0." + std::to_string(ii / 250) + "." + std::to_string(ii % 250));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InvalidTables)
+{
+  TableFiles files;
+  BOOST_REQUIRE_THROW(StaticHostTable table(files.table_path), StaticHostTableError);
+  BOOST_REQUIRE_THROW(StaticHostTable table(files.hosts_path), StaticHostTableError);
+  BOOST_REQUIRE_THROW(StaticHostTable::compile("/nonexistent/hosts", files.table_path), StaticHostTableError);
+}
+
+BOOST_AUTO_TEST_CASE(ResolverIntegration)
+{
+  TableFiles files;
+  StaticHostTable::compile(files.hosts_path, files.table_path);
+  set_static_host_table(files.table_path);
+  ResolverCache::instance().reset_stats();
+
+  auto res = get_ips_from_hostname("daq-node-02");
+  BOOST_REQUIRE_EQUAL(res.size(), 2);
+  BOOST_REQUIRE_EQUAL(res[0], "10.73.136.2");
+
+  res = resolve_uri_hostname("tcp://daq-node-01:5000");
+  BOOST_REQUIRE_EQUAL(res.size(), 1);
+  BOOST_REQUIRE_EQUAL(res[0], "tcp://10.73.136.1:5000");
+
+  // Names not in the table fall back to getaddrinfo
+  res = get_ips_from_hostname("127.0.0.1");
+  BOOST_REQUIRE_EQUAL(res[0], "127.0.0.1");
+
+  auto stats = ResolverCache::instance().get_stats();
+  BOOST_REQUIRE_EQUAL(stats.static_hits, 2);
+  BOOST_REQUIRE_EQUAL(stats.misses, 1);
+
+  set_static_host_table("");
+  BOOST_REQUIRE(get_static_host_table() == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
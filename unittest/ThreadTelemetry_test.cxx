@@ -0,0 +1,118 @@
+/**
+ *
+ * @file ThreadTelemetry_test.cxx ThreadTelemetry Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/ReusableThread.hpp"
+#include "utilities/ThreadTelemetry.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE ThreadTelemetry_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(ThreadTelemetry_test)
+
+BOOST_AUTO_TEST_CASE(DisabledByDefault)
+{
+  auto& telemetry = ThreadTelemetry::instance();
+  BOOST_REQUIRE(!telemetry.is_enabled());
+  BOOST_REQUIRE(telemetry.register_thread("nothing", "test") == nullptr);
+
+  ReusableThread worker(0);
+  worker.set_name("untracked", 0);
+  BOOST_REQUIRE(worker.set_work([]() {}));
+  worker.wait_until_ready();
+  BOOST_REQUIRE(telemetry.snapshot().empty());
+}
+
+BOOST_AUTO_TEST_CASE(Histogram)
+{
+  DurationHistogram histogram;
+  histogram.record(0);
+  histogram.record(1);
+  histogram.record(1000);
+  histogram.record(1023);
+  auto json = histogram.to_json();
+  BOOST_REQUIRE_EQUAL(json["count"].get<int>(), 4);
+  BOOST_REQUIRE_EQUAL(json["max_ns"].get<int>(), 1023);
+  BOOST_REQUIRE_EQUAL(json["histogram"].size(), 3);
+  BOOST_REQUIRE_EQUAL(json["histogram"][2]["lt_ns"].get<int>(), 1024);
+  BOOST_REQUIRE_EQUAL(json["histogram"][2]["count"].get<int>(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ReusableThreadStats)
+{
+  auto& telemetry = ThreadTelemetry::instance();
+  telemetry.set_enabled(true);
+  {
+    ReusableThread worker(0, 16);
+    worker.set_name("tracked", 3);
+    for (int ii = 0; ii < 10; ++ii) {
+      BOOST_REQUIRE(worker.set_work([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }));
+      worker.wait_until_ready();
+    }
+    for (int ii = 0; ii < 5; ++ii) {
+      BOOST_REQUIRE(worker.try_submit([]() {}) == ReusableThread::SubmitResult::kAccepted);
+    }
+    worker.wait_until_ready();
+
+    auto snapshot = telemetry.snapshot();
+    BOOST_REQUIRE(snapshot.contains("tracked-3"));
+    auto stats = snapshot["tracked-3"];
+    BOOST_TEST_MESSAGE(stats.dump(2));
+    BOOST_REQUIRE_EQUAL(stats["type"].get<std::string>(), "ReusableThread");
+    BOOST_REQUIRE_GT(stats["tid"].get<int>(), 0);
+    BOOST_REQUIRE_EQUAL(stats["tasks_executed"].get<int>(), 15);
+    BOOST_REQUIRE_EQUAL(stats["run_time"]["count"].get<int>(), 15);
+    BOOST_REQUIRE_EQUAL(stats["handoff_latency"]["count"].get<int>(), 15);
+    BOOST_REQUIRE_GE(stats["busy_s"].get<double>(), 0.01);
+    BOOST_REQUIRE_GT(stats["idle_s"].get<double>(), 0);
+    BOOST_REQUIRE(stats.contains("involuntary_context_switches"));
+    BOOST_REQUIRE(stats.contains("voluntary_context_switches"));
+    BOOST_REQUIRE(stats.contains("cpu_time_s"));
+
+    // A second thread with the same name gets a suffix
+    ReusableThread other(1);
+    other.set_name("tracked", 3);
+    BOOST_REQUIRE(telemetry.snapshot().contains("tracked-3#2"));
+  }
+  // Statistics go away with their threads
+  BOOST_REQUIRE(telemetry.snapshot().empty());
+  telemetry.set_enabled(false);
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadStats)
+{
+  auto& telemetry = ThreadTelemetry::instance();
+  telemetry.set_enabled(true);
+
+  WorkerThread worker([](std::atomic<bool>& running) {
+    while (running) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  worker.start_working_thread("wt-telemetry");
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  auto stats = telemetry.snapshot()["wt-telemetry"];
+  BOOST_REQUIRE_EQUAL(stats["type"].get<std::string>(), "WorkerThread");
+  BOOST_REQUIRE_GT(stats["tid"].get<int>(), 0);
+  BOOST_REQUIRE_GT(stats["running_s"].get<double>(), 0);
+  BOOST_REQUIRE_GT(stats["voluntary_context_switches"].get<int>(), 0);
+  worker.stop_working_thread();
+
+  telemetry.set_enabled(false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
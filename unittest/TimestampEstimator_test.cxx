@@ -9,7 +9,10 @@
 // #include "iomanager/IOManager.hpp"
 // #include "iomanager/Sender.hpp"
 // #include "iomanager/Receiver.hpp"
+#include "utilities/DriftEstimator.hpp"
+#include "utilities/Seqlock.hpp"
 #include "utilities/TimestampEstimator.hpp"
+#include "utilities/TscClock.hpp"
 
 /**
  * @brief Name of this test module
@@ -18,10 +21,15 @@
 
 #include "boost/test/unit_test.hpp"
 
+#include <atomic>
 #include <chrono>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
 
 struct DummyTimeSync {
   uint64_t daq_time{ std::numeric_limits<uint64_t>::max() };
@@ -99,5 +107,380 @@ BOOST_AUTO_TEST_CASE(Basics)
   }
 }
 
+namespace {
+void
+send_timesync(utilities::TimestampEstimator& te, uint32_t run_num, uint64_t daq_time) // NOLINT(build/unsigned)
+{
+  using namespace std::chrono;
+  DummyTimeSync ts;
+  ts.daq_time = daq_time;
+  // Sent a little while ago; the estimator ignores a TimeSync from the current microsecond
+  ts.system_time =
+    static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count()) - 1000; // NOLINT
+  ts.sequence_number = 1;
+  ts.run_number = run_num;
+  ts.source_pid = 12345;
+  te.timesync_callback(ts);
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE(WaitForValidTimestamp)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(5, clock_frequency_hz);
+  BOOST_REQUIRE_EQUAL(te.get_timestamp_estimate(), std::numeric_limits<uint64_t>::max());
+
+  // Woken by the first TimeSync rather than by a poll
+  utilities::StopState state;
+  std::thread sender([&]() {
+    std::this_thread::sleep_for(20ms);
+    send_timesync(te, 5, 1'000'000);
+  });
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(te.wait_for_valid_timestamp(utilities::StopToken(state)),
+                      utilities::TimestampEstimatorBase::kFinished);
+  auto waited = std::chrono::steady_clock::now() - start;
+  sender.join();
+  BOOST_REQUIRE(waited >= 20ms);
+  BOOST_REQUIRE(waited < 200ms);
+
+  std::atomic<bool> continue_flag{ true };
+  BOOST_REQUIRE_EQUAL(te.wait_for_valid_timestamp(continue_flag), utilities::TimestampEstimatorBase::kFinished);
+}
+
+BOOST_AUTO_TEST_CASE(WaitForTimestamp)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(5, clock_frequency_hz);
+  send_timesync(te, 5, 1'000'000);
+
+  // 20 ms ahead; the wait sleeps until the predicted time rather than polling
+  const uint64_t ahead = clock_frequency_hz / 50; // NOLINT(build/unsigned)
+  std::atomic<bool> continue_flag{ true };
+  utilities::StopState state;
+  for (int ii = 0; ii < 2; ++ii) {
+    auto target = te.get_timestamp_estimate() + ahead;
+    auto start = std::chrono::steady_clock::now();
+    auto status = ii == 0 ? te.wait_for_timestamp(target, continue_flag)
+                          : te.wait_for_timestamp(target, utilities::StopToken(state));
+    auto reached = te.get_timestamp_estimate();
+    auto waited = std::chrono::steady_clock::now() - start;
+    BOOST_REQUIRE_EQUAL(status, utilities::TimestampEstimatorBase::kFinished);
+    BOOST_REQUIRE_GE(reached, target);
+    BOOST_REQUIRE(waited >= 19ms);
+    BOOST_REQUIRE(waited < 100ms);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(InterruptWait)
+{
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(5, clock_frequency_hz);
+  send_timesync(te, 5, 1'000'000);
+  auto far_future = te.get_timestamp_estimate() + 3600 * clock_frequency_hz;
+
+  utilities::StopState state;
+  std::thread stopper([&]() {
+    std::this_thread::sleep_for(10ms);
+    state.request_stop();
+  });
+  auto start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(te.wait_for_timestamp(far_future, utilities::StopToken(state)),
+                      utilities::TimestampEstimatorBase::kInterrupted);
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < 200ms);
+  stopper.join();
+
+  std::atomic<bool> continue_flag{ true };
+  std::thread clearer([&]() {
+    std::this_thread::sleep_for(10ms);
+    continue_flag = false;
+  });
+  start = std::chrono::steady_clock::now();
+  BOOST_REQUIRE_EQUAL(te.wait_for_timestamp(far_future, continue_flag),
+                      utilities::TimestampEstimatorBase::kInterrupted);
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - start < 200ms);
+  clearer.join();
+}
+
+BOOST_AUTO_TEST_CASE(DriftFit)
+{
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  const double drift = 100e-6;
+  const double true_ticks_per_us = clock_frequency_hz * (1 + drift) / 1e6;
+  const uint64_t system_start = 1'700'000'000'000'000; // NOLINT(build/unsigned)
+  const uint64_t daq_start = 5'000'000'000'000;        // NOLINT(build/unsigned)
+  auto true_daq_time = [&](uint64_t system_time_us) { // NOLINT(build/unsigned)
+    return daq_start + static_cast<uint64_t>(static_cast<double>(system_time_us - system_start) * true_ticks_per_us);
+  };
+
+  utilities::DriftEstimator latest(clock_frequency_hz, 1);
+  utilities::DriftEstimator fitted(clock_frequency_hz, 16);
+  for (uint64_t ii = 0; ii < 32; ++ii) { // NOLINT(build/unsigned)
+    auto system_time = system_start + ii * 1'000'000;
+    BOOST_REQUIRE(latest.add(true_daq_time(system_time), system_time));
+    BOOST_REQUIRE(fitted.add(true_daq_time(system_time), system_time));
+  }
+  BOOST_REQUIRE_EQUAL(fitted.size(), 16);
+  BOOST_REQUIRE_CLOSE(fitted.get_frequency_hz(), clock_frequency_hz * (1 + drift), 1e-4);
+  BOOST_REQUIRE_EQUAL(latest.get_frequency_hz(), clock_frequency_hz);
+  BOOST_REQUIRE_CLOSE(fitted.get_interval_us(), 1e6, 1e-9);
+  BOOST_REQUIRE_LT(fitted.get_residual_rms_ticks(), 1.);
+  BOOST_REQUIRE_EQUAL(latest.get_interval_us(), 0.);
+
+  // Half a second after the last pair the nominal frequency is 50 us worth of ticks behind
+  auto query = system_start + 31'500'000;
+  auto fitted_error = static_cast<int64_t>(fitted.predict(query) - true_daq_time(query));
+  auto latest_error = static_cast<int64_t>(latest.predict(query) - true_daq_time(query));
+  BOOST_REQUIRE_LT(std::abs(fitted_error), 10);
+  BOOST_REQUIRE_LT(latest_error, -3000);
+
+  // Older pairs are ignored; a jump in DAQ time restarts the window
+  BOOST_REQUIRE(!fitted.add(true_daq_time(system_start), system_start + 32'000'000));
+  BOOST_REQUIRE(fitted.add(true_daq_time(query) + clock_frequency_hz, query));
+  BOOST_REQUIRE_EQUAL(fitted.size(), 1);
+  BOOST_REQUIRE_EQUAL(fitted.get_frequency_hz(), clock_frequency_hz);
+}
+
+BOOST_AUTO_TEST_CASE(DriftWindow)
+{
+  using namespace std::chrono;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(clock_frequency_hz);
+  te.set_drift_window(8);
+
+  // TimeSyncs every 100 ms from a clock running 200 ppm fast, the last one 200 ms ago
+  const double fast = 1 + 200e-6;
+  const uint64_t last_daq_time = 1'000'000'000'000; // NOLINT(build/unsigned)
+  auto now_us = static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+  for (uint64_t ii = 0; ii < 8; ++ii) { // NOLINT(build/unsigned)
+    auto before_last_us = (7 - ii) * 100'000;
+    te.add_timestamp_datapoint(
+      last_daq_time - static_cast<uint64_t>(static_cast<double>(before_last_us) * clock_frequency_hz / 1e6 * fast),
+      now_us - 200'000 - before_last_us);
+  }
+  BOOST_REQUIRE_CLOSE(te.get_estimated_frequency_hz(), clock_frequency_hz * fast, 1e-4);
+
+  // A TimeSync 100 ms later which has hardly advanced restarts the fit, but does not put the estimate back:
+  // the estimate slows down, here to the slowest slew rate as the lead is large, until it meets the fit
+  auto before = te.get_timestamp_estimate();
+  te.add_timestamp_datapoint(last_daq_time + 1, now_us - 100'000);
+  auto slewing = te.get_timestamp_estimate();
+  BOOST_REQUIRE_GE(slewing, before);
+  auto slew_start = steady_clock::now();
+  std::this_thread::sleep_for(20ms);
+  auto advanced = static_cast<double>(te.get_timestamp_estimate() - slewing);
+  auto elapsed_s = duration<double>(steady_clock::now() - slew_start).count();
+  BOOST_REQUIRE_GT(advanced, 0.);
+  BOOST_REQUIRE_LT(advanced, 0.75 * clock_frequency_hz * elapsed_s);
+
+  // Once the fit is ahead again, it takes over at its own frequency
+  before = te.get_timestamp_estimate();
+  te.add_timestamp_datapoint(last_daq_time + clock_frequency_hz, now_us);
+  BOOST_REQUIRE_GE(te.get_timestamp_estimate(), before);
+  BOOST_REQUIRE_EQUAL(te.get_estimated_frequency_hz(), clock_frequency_hz);
+}
+
+BOOST_AUTO_TEST_CASE(SeqlockConsistency)
+{
+  // Readers never see a value which is half of one store and half of another
+  struct Triple
+  {
+    uint64_t a, b, c; // NOLINT(build/unsigned)
+  };
+  utilities::Seqlock<Triple> triple(Triple{ 0, 0, 0 });
+  std::atomic<bool> done{ false };
+  std::atomic<int> torn{ 0 };
+
+  std::vector<std::thread> readers;
+  for (int ii = 0; ii < 3; ++ii) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        auto value = triple.load();
+        if (value.a != value.b || value.b != value.c) {
+          torn.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (uint64_t ii = 1; ii <= 200'000; ++ii) { // NOLINT(build/unsigned)
+    triple.store(Triple{ ii, ii, ii });
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  BOOST_REQUIRE_EQUAL(torn.load(), 0);
+  BOOST_REQUIRE_EQUAL(triple.load().c, 200'000);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentTimeSyncs)
+{
+  using namespace std::chrono;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  BOOST_REQUIRE(utilities::TimestampEstimator::is_lock_free());
+
+  utilities::TimestampEstimator te(clock_frequency_hz);
+  auto now_us = []() {
+    return static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count());
+  };
+  const uint64_t epoch_us = now_us(); // NOLINT(build/unsigned)
+  auto daq_time_at = [&](uint64_t system_time_us) { // NOLINT(build/unsigned)
+    return 1'000'000'000 + (system_time_us - epoch_us + 1'000) * clock_frequency_hz / 1'000'000;
+  };
+
+  // Several sources feed TimeSyncs while readers check the estimate never goes
+  // back by more than the rounding of the system and steady times to microseconds
+  const uint64_t rounding = 2 * clock_frequency_hz / 1'000'000; // NOLINT(build/unsigned)
+  std::atomic<bool> done{ false };
+  std::atomic<int> backwards{ 0 };
+  std::vector<std::thread> readers;
+  for (int ii = 0; ii < 3; ++ii) {
+    readers.emplace_back([&]() {
+      uint64_t previous = 0; // NOLINT(build/unsigned)
+      while (!done.load()) {
+        auto estimate = te.get_timestamp_estimate();
+        if (estimate == std::numeric_limits<uint64_t>::max()) {
+          continue;
+        }
+        if (estimate + rounding < previous) {
+          backwards.fetch_add(1);
+        }
+        previous = estimate;
+      }
+    });
+  }
+  std::vector<std::thread> sources;
+  for (int ii = 0; ii < 4; ++ii) {
+    sources.emplace_back([&]() {
+      for (int jj = 0; jj < 2000; ++jj) {
+        auto system_time = now_us() - 1'000;
+        te.add_timestamp_datapoint(daq_time_at(system_time), system_time);
+        if (jj % 100 == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& source : sources) {
+    source.join();
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  BOOST_REQUIRE_EQUAL(backwards.load(), 0);
+  BOOST_TEST_MESSAGE("Dropped " << te.get_dropped_timesync_count() << " TimeSyncs");
+
+  // Nothing is left half-ingested: a further TimeSync is taken straight away
+  auto system_time = now_us() - 1'000;
+  auto last = daq_time_at(system_time) + clock_frequency_hz;
+  te.add_timestamp_datapoint(last, system_time);
+  BOOST_REQUIRE_GE(te.get_timestamp_estimate(), last);
+}
+
+BOOST_AUTO_TEST_CASE(TscScaleConversion)
+{
+  // 62.5 MHz DAQ ticks from a 2.5 GHz counter
+  auto scale = utilities::TscScale::for_frequency(62.5e6, 2.5e9);
+  BOOST_REQUIRE_EQUAL(scale.convert(0), 0);
+  BOOST_REQUIRE_EQUAL(scale.convert(2'500'000'000), 62'500'000);
+  BOOST_REQUIRE_EQUAL(scale.convert(40), 1);
+
+  // A day of counter ticks neither overflows nor loses precision
+  const uint64_t day = 2'500'000'000ULL * 86400; // NOLINT(build/unsigned)
+  BOOST_REQUIRE_EQUAL(scale.convert(day), 62'500'000ULL * 86400);
+
+  // A zero frequency disables the conversion
+  BOOST_REQUIRE_EQUAL(utilities::TscScale::for_frequency(62.5e6, 0.).multiplier, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TscExtrapolation)
+{
+  using namespace std::chrono;
+  using namespace std::chrono_literals;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(5, clock_frequency_hz);
+  send_timesync(te, 5, 1'000'000);
+
+  if (!utilities::TscClock::is_invariant()) {
+    BOOST_TEST_MESSAGE("No invariant TSC; the estimate stays on steady_clock");
+    BOOST_REQUIRE(!te.set_use_tsc(true));
+    return;
+  }
+  BOOST_TEST_MESSAGE("TSC frequency " << utilities::TscClock::get_frequency_hz() << " Hz");
+
+  // Changing clocks carries on from where the estimate had got to
+  auto before = te.get_timestamp_estimate();
+  BOOST_REQUIRE(te.set_use_tsc(true));
+  auto after = te.get_timestamp_estimate();
+  BOOST_REQUIRE_GE(after, before);
+  BOOST_REQUIRE_LT(after - before, clock_frequency_hz / 100);
+
+  // Then advances with steady_clock at the DAQ clock frequency
+  auto steady_start = steady_clock::now();
+  auto estimate_start = te.get_timestamp_estimate();
+  for (int ii = 0; ii < 10; ++ii) {
+    std::this_thread::sleep_for(10ms);
+    auto elapsed_ns = duration_cast<nanoseconds>(steady_clock::now() - steady_start).count();
+    auto advanced = static_cast<int64_t>(te.get_timestamp_estimate() - estimate_start);
+    BOOST_CHECK_LT(std::abs(advanced - elapsed_ns * 625 / 10'000), 1'000);
+  }
+
+  // And a TimeSync restarts it on the TSC
+  send_timesync(te, 5, te.get_timestamp_estimate() + clock_frequency_hz);
+  BOOST_REQUIRE_GE(te.get_timestamp_estimate(), estimate_start + clock_frequency_hz);
+
+  BOOST_REQUIRE(!te.set_use_tsc(false));
+  BOOST_REQUIRE_GE(te.get_timestamp_estimate(), estimate_start + clock_frequency_hz);
+}
+
+BOOST_AUTO_TEST_CASE(BatchCallback)
+{
+  using namespace std::chrono;
+  const uint64_t clock_frequency_hz = 62'500'000; // NOLINT(build/unsigned)
+  const uint32_t run_num = 5;                      // NOLINT(build/unsigned)
+  utilities::TimestampEstimator te(run_num, clock_frequency_hz);
+
+  // A backlog, not in order, with TimeSyncs from another run and from this process
+  auto system_time =
+    static_cast<uint64_t>(duration_cast<microseconds>(system_clock::now().time_since_epoch()).count()) - 1000; // NOLINT
+  std::vector<DummyTimeSync> backlog;
+  for (uint64_t ii = 0; ii < 100; ++ii) { // NOLINT(build/unsigned)
+    DummyTimeSync ts;
+    ts.daq_time = 1'000'000 + ((ii * 37) % 100) * 1000;
+    ts.system_time = system_time;
+    ts.sequence_number = ii;
+    ts.run_number = run_num;
+    ts.source_pid = 12345;
+    backlog.push_back(ts);
+  }
+  backlog[10].run_number = run_num + 1;
+  backlog[10].daq_time = 2'000'000'000;
+  backlog[20].source_pid = static_cast<uint32_t>(getpid());
+  backlog[20].daq_time = 2'000'000'000;
+  backlog[30].daq_time = std::numeric_limits<uint64_t>::max(); // Never filled in
+
+  te.timesync_batch_callback(backlog.data(), backlog.size());
+  BOOST_REQUIRE_EQUAL(te.get_received_timesync_count(), 100);
+  BOOST_REQUIRE_EQUAL(te.get_discarded_timesync_count(), 3);
+
+  // The newest valid TimeSync, 1'099'000, sets the estimate
+  auto estimate = te.get_timestamp_estimate();
+  BOOST_REQUIRE_GE(estimate, 1'099'000);
+  BOOST_REQUIRE_LT(estimate, 1'099'000 + clock_frequency_hz);
+
+  // The per-message path counts the same way
+  te.timesync_callback(backlog[10]);
+  BOOST_REQUIRE_EQUAL(te.get_received_timesync_count(), 101);
+  BOOST_REQUIRE_EQUAL(te.get_discarded_timesync_count(), 4);
+
+  // An empty batch, or one with nothing valid, leaves the estimate alone
+  te.timesync_batch_callback(backlog.data(), 0);
+  te.timesync_batch_callback(&backlog[20], 1);
+  BOOST_REQUIRE_LT(te.get_timestamp_estimate(), 2'000'000'000);
+}
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,168 @@
+/**
+ *
+ * @file Watchdog_test.cxx Heartbeat and Watchdog Unit Tests
+ *
+ * This is part of the DUNE DAQ Application Framework, copyright 2020.
+ * Licensing/copyright details are in the COPYING file that you should have
+ * received with this code.
+ */
+
+#include "utilities/Watchdog.hpp"
+#include "utilities/WorkerThread.hpp"
+
+#define BOOST_TEST_MODULE Watchdog_test // NOLINT
+
+#include "boost/test/unit_test.hpp"
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+using namespace dunedaq::utilities;
+
+BOOST_AUTO_TEST_SUITE(Watchdog_test)
+
+BOOST_AUTO_TEST_CASE(StallAndResume)
+{
+  Watchdog watchdog(std::chrono::milliseconds(5));
+  auto heartbeat = std::make_shared<Heartbeat>("looper");
+  heartbeat->set_stall_threshold(std::chrono::milliseconds(50));
+  heartbeat->set_active(true);
+  watchdog.watch(heartbeat);
+  watchdog.watch(heartbeat);
+
+  std::atomic<bool> paused{ false };
+  std::atomic<bool> done{ false };
+  std::thread looper([&]() {
+    heartbeat->attach_current_thread();
+    while (!done.load()) {
+      if (!paused.load()) {
+        heartbeat->beat();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_REQUIRE_EQUAL(watchdog.get_stall_count(), 0);
+  auto snapshot = watchdog.snapshot();
+  BOOST_REQUIRE_EQUAL(snapshot.size(), 1);
+  BOOST_REQUIRE(!snapshot["looper"]["stalled"].get<bool>());
+  BOOST_REQUIRE_GT(snapshot["looper"]["rate_hz"].get<double>(), 0.);
+  BOOST_REQUIRE_GT(snapshot["looper"]["iterations"].get<uint64_t>(), 0); // NOLINT(build/unsigned)
+
+  paused = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  BOOST_REQUIRE_EQUAL(watchdog.get_stall_count(), 1); // Reported once
+  BOOST_REQUIRE(watchdog.snapshot()["looper"]["stalled"].get<bool>());
+
+  paused = false;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  BOOST_REQUIRE(!watchdog.snapshot()["looper"]["stalled"].get<bool>());
+
+  // An inactive heartbeat is not a stall
+  heartbeat->set_active(false);
+  paused = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  BOOST_REQUIRE_EQUAL(watchdog.get_stall_count(), 1);
+
+  done = true;
+  looper.join();
+
+  heartbeat.reset();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  BOOST_REQUIRE(watchdog.snapshot().empty());
+}
+
+BOOST_AUTO_TEST_CASE(StackTrace)
+{
+  std::atomic<pid_t> tid{ 0 };
+  std::atomic<bool> done{ false };
+  std::thread blocked([&]() {
+    tid = ThreadTelemetry::current_tid();
+    while (!done.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  while (tid.load() == 0) {
+    std::this_thread::yield();
+  }
+
+  auto trace = Watchdog::capture_stack_trace(tid.load());
+  BOOST_TEST_MESSAGE("Stack trace:\n" << trace);
+  BOOST_REQUIRE(!trace.empty());
+
+  done = true;
+  blocked.join();
+}
+
+BOOST_AUTO_TEST_CASE(LateSignal)
+{
+  // The thread blocks real-time signals, so the first capture times out and its
+  // signal is only delivered once it unblocks them, while a second capture is armed
+  std::atomic<pid_t> tid{ 0 };
+  std::atomic<bool> unblock{ false };
+  std::atomic<bool> done{ false };
+  std::thread blocked([&]() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    for (int signal_number = SIGRTMIN; signal_number <= SIGRTMAX; ++signal_number) {
+      sigaddset(&signals, signal_number);
+    }
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    tid = ThreadTelemetry::current_tid();
+    while (!unblock.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    pthread_sigmask(SIG_UNBLOCK, &signals, nullptr);
+    while (!done.load()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  while (tid.load() == 0) {
+    std::this_thread::yield();
+  }
+
+  BOOST_REQUIRE(Watchdog::capture_stack_trace(tid.load()).empty());
+  unblock = true;
+
+  // The stale signal is ignored and the new one answered
+  auto trace = Watchdog::capture_stack_trace(tid.load());
+  BOOST_REQUIRE(!trace.empty());
+
+  done = true;
+  blocked.join();
+}
+
+BOOST_AUTO_TEST_CASE(WorkerThreadStall)
+{
+  Watchdog::instance().set_sample_period(std::chrono::milliseconds(5));
+  auto stalls_before = Watchdog::instance().get_stall_count();
+
+  std::atomic<bool> stuck{ false };
+  std::unique_ptr<WorkerThread> worker;
+  worker = std::make_unique<WorkerThread>([&](const StopToken& stop) {
+    auto& heartbeat = worker->get_heartbeat();
+    while (stop.wait_for(std::chrono::milliseconds(1))) {
+      if (!stuck.load()) {
+        heartbeat.beat();
+      }
+    }
+  });
+  worker->set_stall_threshold(std::chrono::milliseconds(50));
+  worker->start_working_thread("stuckworker");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_REQUIRE_EQUAL(Watchdog::instance().get_stall_count(), stalls_before);
+  BOOST_REQUIRE_GT(worker->get_heartbeat().get_count(), 0);
+
+  stuck = true;
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  BOOST_REQUIRE_EQUAL(Watchdog::instance().get_stall_count(), stalls_before + 1);
+  worker->stop_working_thread();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
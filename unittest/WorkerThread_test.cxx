@@ -14,8 +14,13 @@
 #include "boost/asio/signal_set.hpp"
 #include "boost/test/unit_test.hpp"
 
+#include <sched.h>
+#include <sys/resource.h>
+
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace {
@@ -100,6 +105,145 @@ BOOST_AUTO_TEST_CASE(thread_name)
   BOOST_REQUIRE_EQUAL(actual_thread_name, "WorkerThread_te");
 }
 
+BOOST_AUTO_TEST_CASE(stop_token_sleep)
+{
+  std::atomic<int> iterations{ 0 };
+  dunedaq::utilities::WorkerThread umth([&](const dunedaq::utilities::StopToken& stop) {
+    while (stop.wait_for(std::chrono::seconds(10))) {
+      ++iterations;
+    }
+  });
+  umth.start_working_thread();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  auto starttime = std::chrono::steady_clock::now();
+  umth.stop_working_thread();
+  auto stop_time = std::chrono::steady_clock::now() - starttime;
+  BOOST_REQUIRE_EQUAL(iterations.load(), 0);
+  BOOST_REQUIRE(stop_time < std::chrono::seconds(1));
+
+  // The token is re-armed on restart
+  umth.start_working_thread();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  BOOST_REQUIRE(umth.thread_running());
+  umth.stop_working_thread();
+
+  dunedaq::utilities::WorkerThread ticker([&](const dunedaq::utilities::StopToken& stop) {
+    while (stop.wait_for(std::chrono::milliseconds(1))) {
+      ++iterations;
+    }
+  });
+  ticker.start_working_thread();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ticker.stop_working_thread();
+  BOOST_REQUIRE_GT(iterations.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(stop_token_condition_wait)
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool ready = false;
+  bool pred_result = true;
+  dunedaq::utilities::WorkerThread umth([&](const dunedaq::utilities::StopToken& stop) {
+    std::unique_lock<std::mutex> lk(mutex);
+    pred_result = stop.wait(lk, cv, [&]() { return ready; });
+  });
+  umth.start_working_thread();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  auto starttime = std::chrono::steady_clock::now();
+  umth.stop_working_thread();
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime < std::chrono::seconds(1));
+  BOOST_REQUIRE(!pred_result);
+
+  // The predicate still works as usual
+  dunedaq::utilities::WorkerThread waiter([&](const dunedaq::utilities::StopToken& stop) {
+    std::unique_lock<std::mutex> lk(mutex);
+    pred_result = stop.wait_for(lk, cv, std::chrono::seconds(10), [&]() { return ready; });
+  });
+  pred_result = false;
+  waiter.start_working_thread();
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    ready = true;
+  }
+  cv.notify_all();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  waiter.stop_working_thread();
+  BOOST_REQUIRE(pred_result);
+}
+
+BOOST_AUTO_TEST_CASE(stop_token_with_running_flag)
+{
+  std::unique_ptr<dunedaq::utilities::WorkerThread> umth;
+  umth = std::make_unique<dunedaq::utilities::WorkerThread>([&](std::atomic<bool>& running_flag) {
+    auto stop = umth->get_stop_token();
+    while (running_flag.load()) {
+      stop.wait_for(std::chrono::seconds(10));
+    }
+  });
+  umth->start_working_thread();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  auto starttime = std::chrono::steady_clock::now();
+  umth->stop_working_thread();
+  BOOST_REQUIRE(std::chrono::steady_clock::now() - starttime < std::chrono::seconds(1));
+}
+
+BOOST_AUTO_TEST_CASE(thread_attributes)
+{
+  size_t stack_size = 0;
+  size_t guard_size = 0;
+  int cpu = -1;
+  int nice = 0;
+  dunedaq::utilities::SchedulingPolicy policy = dunedaq::utilities::SchedulingPolicy::kInherit;
+  int priority = -1;
+  dunedaq::utilities::WorkerThread umth([&](std::atomic<bool>&) {
+    pthread_attr_t attr;
+    pthread_getattr_np(pthread_self(), &attr);
+    pthread_attr_getstacksize(&attr, &stack_size);
+    pthread_attr_getguardsize(&attr, &guard_size);
+    pthread_attr_destroy(&attr);
+    cpu = sched_getcpu();
+    nice = getpriority(PRIO_PROCESS, static_cast<id_t>(dunedaq::utilities::ThreadTelemetry::current_tid()));
+    dunedaq::utilities::get_thread_scheduling(pthread_self(), policy, priority);
+  });
+
+  dunedaq::utilities::ThreadAttributes attributes;
+  attributes.stack_size = 4 * 1024 * 1024;
+  attributes.guard_size = 64 * 1024;
+  attributes.cpus = { 0 };
+  attributes.nice = 5;
+  umth.start_working_thread("attributes", attributes);
+  umth.stop_working_thread();
+
+  // glibc may hand out a larger cached stack
+  BOOST_REQUIRE_GE(stack_size, attributes.stack_size);
+  BOOST_REQUIRE_GE(guard_size, *attributes.guard_size);
+  BOOST_REQUIRE_EQUAL(cpu, 0);
+  BOOST_REQUIRE_EQUAL(nice, 5);
+  BOOST_REQUIRE(policy == dunedaq::utilities::SchedulingPolicy::kOther);
+
+  // A real-time policy needs privileges; without them the thread still starts
+  attributes = dunedaq::utilities::ThreadAttributes();
+  attributes.policy = dunedaq::utilities::SchedulingPolicy::kFifo;
+  attributes.priority = 10;
+  priority = -1;
+  BOOST_REQUIRE_NO_THROW(umth.start_working_thread("realtime", attributes));
+  umth.stop_working_thread();
+  BOOST_TEST_MESSAGE("Thread ran with " << dunedaq::utilities::to_string(policy) << " priority " << priority);
+  BOOST_REQUIRE(policy == dunedaq::utilities::SchedulingPolicy::kOther ||
+                (policy == dunedaq::utilities::SchedulingPolicy::kFifo && priority == 10));
+
+  // Settings which cannot be applied are warned about and ignored
+  attributes.priority = 1000;
+  attributes.stack_size = 1;
+  BOOST_REQUIRE_NO_THROW(umth.start_working_thread("badattributes", attributes));
+  umth.stop_working_thread();
+  BOOST_REQUIRE(policy == dunedaq::utilities::SchedulingPolicy::kOther);
+}
+
 // You'll want this to test case to execute last, for reasons that are obvious
 // if you look at its checks
 